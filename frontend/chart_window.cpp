@@ -120,12 +120,11 @@ void ChartWindow::subscribe_to_strategy()
                 }
                 auto & plot = get_or_create_chart(m_price_chart_name);
                 plot.push_candle_vector(candles); },
-            [&](std::chrono::milliseconds ts, const Candle & candle) {
-                if (!ts_in_range(ts)) {
-                    return;
-                }
-                auto & plot = get_or_create_chart(m_price_chart_name);
-                plot.push_candle(candle); });
+            [&](std::span<const EventTimeseriesChannel<Candle>::Item> batch) {
+                push_in_range(m_price_chart_name, batch, [](MultiSeriesChart & plot, std::chrono::milliseconds, const Candle & candle) {
+                    plot.push_candle(candle);
+                }); },
+            delivery::Batched{});
 
     m_sub.subscribe(
             str_instance.price_levels_channel(),
@@ -155,7 +154,7 @@ void ChartWindow::subscribe_to_strategy()
 
     m_sub.subscribe(
             str_instance.tpsl_channel(),
-            [this](const std::list<std::pair<std::chrono::milliseconds, TpslPrices>> & input_vec) {
+            [this](const EventTimeseriesChannel<TpslPrices>::Snapshot & input_vec) {
                 std::vector<std::pair<std::chrono::milliseconds, double>> tp, sl;
                 for (const auto & [ts, tpsl] : input_vec) {
                     if (!ts_in_range(ts)) {
@@ -168,15 +167,15 @@ void ChartWindow::subscribe_to_strategy()
                 plot.push_scatter_series_vector("take_profit", tp);
                 plot.push_scatter_series_vector("stop_loss", sl);
             },
-            [&](std::chrono::milliseconds ts, const TpslPrices & tpsl) {
-                if (!ts_in_range(ts)) {
-                    return;
-                }
-                get_or_create_chart(m_price_chart_name).push_tpsl(ts, tpsl);
-            });
+            [&](std::span<const EventTimeseriesChannel<TpslPrices>::Item> batch) {
+                push_in_range(m_price_chart_name, batch, [](MultiSeriesChart & plot, std::chrono::milliseconds ts, const TpslPrices & tpsl) {
+                    plot.push_tpsl(ts, tpsl);
+                });
+            },
+            delivery::Batched{});
     m_sub.subscribe(
             str_instance.trailing_stop_channel(),
-            [this](const std::list<std::pair<std::chrono::milliseconds, StopLoss>> & input_vec) {
+            [this](const EventTimeseriesChannel<StopLoss>::Snapshot & input_vec) {
                 std::vector<std::pair<std::chrono::milliseconds, double>> tsl_vec;
                 tsl_vec.reserve(input_vec.size());
                 for (const auto & [ts, tsl] : input_vec) {
@@ -188,18 +187,15 @@ void ChartWindow::subscribe_to_strategy()
                 auto & plot = get_or_create_chart(m_price_chart_name);
                 plot.push_scatter_series_vector("trailing_stop_loss", tsl_vec);
             },
-            [&](std::chrono::milliseconds ts, const StopLoss & stop_loss) {
-                if (!ts_in_range(ts)) {
-                    return;
-                }
-                get_or_create_chart(m_price_chart_name).push_stop_loss(ts, stop_loss.stop_price());
-            });
+            [&](std::span<const EventTimeseriesChannel<StopLoss>::Item> batch) {
+                push_in_range(m_price_chart_name, batch, [](MultiSeriesChart & plot, std::chrono::milliseconds ts, const StopLoss & stop_loss) {
+                    plot.push_stop_loss(ts, stop_loss.stop_price());
+                });
+            },
+            delivery::Batched{});
     m_sub.subscribe(
             str_instance.strategy_internal_data_channel(),
-            [this](const std::list<
-                    std::pair<
-                            std::chrono::milliseconds,
-                            StrategyInternalData>> & vec) {
+            [this](const EventTimeseriesChannel<StrategyInternalData>::Snapshot & vec) {
                 // chart_name -> series_name -> timestamp, value
                 std::map<std::string,
                          std::map<std::string,
@@ -220,18 +216,19 @@ void ChartWindow::subscribe_to_strategy()
                     }
                 }
             },
-            [&](
-                    std::chrono::milliseconds ts,
-                    const StrategyInternalData & data_pair) {
-                if (!ts_in_range(ts)) {
-                    return;
+            [&](std::span<const EventTimeseriesChannel<StrategyInternalData>::Item> batch) {
+                for (const auto & [ts, data_pair] : batch) {
+                    if (!ts_in_range(ts)) {
+                        continue;
+                    }
+                    const auto & [chart_name, name, data] = data_pair;
+                    get_or_create_chart(std::string{chart_name}).push_series_value(std::string{name}, ts, data);
                 }
-                const auto & [chart_name, name, data] = data_pair;
-                get_or_create_chart(std::string{chart_name}).push_series_value(std::string{name}, ts, data);
-            });
+            },
+            delivery::Batched{});
     m_sub.subscribe(
             str_instance.trade_channel(),
-            [this](const std::list<std::pair<std::chrono::milliseconds, Trade>> & input_vec) {
+            [this](const EventTimeseriesChannel<Trade>::Snapshot & input_vec) {
                 std::vector<std::pair<std::chrono::milliseconds, double>> buy, sell;
                 for (const auto & [ts, trade] : input_vec) {
                     if (!ts_in_range(ts)) {
@@ -252,11 +249,11 @@ void ChartWindow::subscribe_to_strategy()
                 auto & plot = get_or_create_chart(m_price_chart_name);
                 plot.push_scatter_series_vector("buy_trade", buy);
                 plot.push_scatter_series_vector("sell_trade", sell); },
-            [&](std::chrono::milliseconds ts, const Trade & trade) {
-                if (!ts_in_range(ts)) {
-                    return;
-                }
-                get_or_create_chart(m_price_chart_name).push_trade(trade); });
+            [&](std::span<const EventTimeseriesChannel<Trade>::Item> batch) {
+                push_in_range(m_price_chart_name, batch, [](MultiSeriesChart & plot, std::chrono::milliseconds, const Trade & trade) {
+                    plot.push_trade(trade);
+                }); },
+            delivery::Batched{});
 
     if (!m_render_depo) {
         return;
@@ -275,12 +272,12 @@ void ChartWindow::subscribe_to_strategy()
                 auto & plot = get_or_create_chart(m_depo_chart_name);
                 plot.push_series_vector("depo", res);
             },
-            [&](std::chrono::milliseconds ts, double depo) {
-                if (!ts_in_range(ts)) {
-                    return;
-                }
-                get_or_create_chart(m_depo_chart_name).push_series_value("depo", ts, depo);
-            });
+            [&](std::span<const EventTimeseriesChannel<double>::Item> batch) {
+                push_in_range(m_depo_chart_name, batch, [](MultiSeriesChart & plot, std::chrono::milliseconds ts, double depo) {
+                    plot.push_series_value("depo", ts, depo);
+                });
+            },
+            delivery::Batched{});
 
     const auto update_trend_callback = [this](const StrategyResult & str_res) {
         auto & plot = get_or_create_chart(m_depo_chart_name);
@@ -298,7 +295,12 @@ void ChartWindow::subscribe_to_strategy()
 
 void ChartWindowEventConsumer::push(LambdaEvent value)
 {
-    m_cw.signal_lambda(std::move(value.func));
+    // Qt signal arguments have to be copyable
+    m_cw.signal_lambda([ev = std::make_shared<LambdaEvent>(std::move(value))] {
+        if (ev->m_subscriber.is_alive()) {
+            ev->func();
+        }
+    });
 }
 
 void ChartWindow::on_lambda(const std::function<void()> & lambda)
@@ -7,6 +7,8 @@
 
 #include <QWidget>
 
+#include <span>
+
 namespace Ui {
 class ChartWindow;
 }
@@ -23,7 +25,6 @@ public:
 private:
     // IEventConsumer<LambdaEvent>
     void push(LambdaEvent value) override;
-    void discard_subscriber_events(xg::Guid) override {}
 
 private:
     ChartWindow & m_cw;
@@ -57,6 +58,22 @@ private:
     void subscribe_to_strategy();
     bool ts_in_range(std::chrono::milliseconds ts) const;
 
+    // Pushes values of the batch that are in range, the chart is created only if there are any
+    template <class Item, class PushFunc>
+    void push_in_range(const std::string & chart_name, std::span<const Item> batch, PushFunc && push)
+    {
+        MultiSeriesChart * chart = nullptr;
+        for (const auto & [ts, value] : batch) {
+            if (!ts_in_range(ts)) {
+                continue;
+            }
+            if (chart == nullptr) {
+                chart = &get_or_create_chart(chart_name);
+            }
+            push(*chart, ts, value);
+        }
+    }
+
 private:
     static constexpr double height_factor = 0.7;
 
@@ -1,5 +1,6 @@
 #include "StrategyInstance.h"
 
+#include "CandlePath.h"
 #include "ConditionalOrders.h"
 #include "EventBarrier.h"
 #include "Events.h"
@@ -34,8 +35,10 @@ StrategyInstance::StrategyInstance(
         const std::string & entry_strategy_name,
         const JsonStrategyConfig & entry_strategy_config,
         IMarketDataGateway & md_gateway,
-        ITradingGateway & tr_gateway)
-    : m_strategy_guid(xg::newGuid())
+        ITradingGateway & tr_gateway,
+        EventLoopMode event_loop_mode)
+    : m_event_loop(event_loop_mode)
+    , m_strategy_guid(xg::newGuid())
     , m_candle_builder{get_timeframe(entry_strategy_config).value_or(std::chrono::minutes{5})}
     , m_md_gateway(md_gateway)
     , m_tr_gateway(tr_gateway)
@@ -97,6 +100,12 @@ StrategyInstance::StrategyInstance(
                 handle_event_generic(e);
             },
             Priority::Low);
+    m_sub.subscribe(
+            m_md_gateway.historical_candles_channel(),
+            [this](const HistoricalCandlesGeneratorEvent & e) {
+                handle_event_generic(e);
+            },
+            Priority::Low);
     m_sub.subscribe(
             m_md_gateway.live_prices_channel(),
             [this](const MDPriceEvent & e) {
@@ -105,7 +114,7 @@ StrategyInstance::StrategyInstance(
             Priority::Low);
     m_sub.subscribe(
             m_historical_md_channel,
-            [this](const HistoricalMDPriceEvent & e) {
+            [this](const HistoricalMDBatchEvent & e) {
                 handle_event_generic(e);
             },
             Priority::Low);
@@ -155,6 +164,12 @@ void StrategyInstance::run_async()
     m_start_ev_channel.push({});
 }
 
+void StrategyInstance::run_sync()
+{
+    run_async();
+    m_event_loop.run_until([this] { return m_stopped; });
+}
+
 void StrategyInstance::stop_async(bool panic)
 {
     LOG_STATUS("stop_async");
@@ -229,17 +244,19 @@ void StrategyInstance::process_position_result(const PositionResult & new_result
         res.min_depo = std::min(res.min_depo, res.final_profit);
     });
 
-    m_depo_channel.push(ts, m_strategy_result.get().final_profit);
+    push_depo(ts, m_strategy_result.get().final_profit);
 
-    const std::list<std::pair<std::chrono::milliseconds, double>> depo_series_list = m_depo_channel.data_copy();
-    const std::vector<std::pair<std::chrono::milliseconds, double>> depo_series{
-            depo_series_list.begin(),
-            depo_series_list.end()};
     m_strategy_result.update([&](StrategyResult & res) {
-        res.set_trend_info(depo_series);
+        res.set_trend_info(m_depo_trend);
     });
 }
 
+void StrategyInstance::push_depo(std::chrono::milliseconds ts, double depo)
+{
+    m_depo_channel.push(ts, depo);
+    m_depo_trend.push(ts, depo);
+}
+
 void StrategyInstance::set_channel_capacity(std::optional<std::chrono::milliseconds> capacity)
 {
     trade_channel().set_capacity(capacity);
@@ -249,6 +266,11 @@ void StrategyInstance::set_channel_capacity(std::optional<std::chrono::milliseco
     price_channel().set_capacity(capacity);
 }
 
+void StrategyInstance::set_log_level(std::optional<LogLevel> level)
+{
+    m_event_loop.set_log_level(level);
+}
+
 EventTimeseriesChannel<ProfitPriceLevels> & StrategyInstance::price_levels_channel()
 {
     return m_price_levels_channel;
@@ -333,7 +355,7 @@ void StrategyInstance::after_every_event()
 {
     if (ready_to_finish()) {
         m_status.push(m_status_on_stop);
-        m_depo_channel.push(m_last_ts_and_price.first, m_strategy_result.get().final_profit);
+        push_depo(m_last_ts_and_price.first, m_strategy_result.get().final_profit);
         // TODO unsub from TRGW?
     }
     finish_if_needed_and_ready();
@@ -359,49 +381,165 @@ void StrategyInstance::handle_event(const HistoricalMDGeneratorEvent & response)
     }
 
     m_historical_md_generator = response;
-    const auto ev_opt = m_historical_md_generator->get_next();
-    if (!ev_opt.has_value()) {
+    m_next_historical_trade = 0;
+    if (!m_historical_md_generator->get_next_batch(m_historical_trades)) {
         LOG_ERROR("no event in HistoricalMDGeneratorEvent: {}", response.request_guid());
         return;
     }
 
     m_backtest_in_progress = true;
-    m_historical_md_channel.push(ev_opt.value());
+    m_historical_md_channel.push({});
+}
+
+void StrategyInstance::handle_event(const HistoricalCandlesGeneratorEvent & response)
+{
+    if (m_historical_candles_generator) {
+        return;
+    }
+
+    const size_t erased_cnt = m_pending_requests.erase(response.request_guid());
+    if (erased_cnt == 0) {
+        LOG_DEBUG("unsolicited HistoricalCandlesGeneratorEvent: {}, this->guid: {}", response.request_guid(), m_strategy_guid);
+        return;
+    }
+
+    m_historical_candles_generator = response;
+    m_next_historical_candle = 0;
+    m_next_path_point = 0;
+    if (!m_historical_candles_generator->get_next_batch(m_historical_candles)) {
+        LOG_ERROR("no candles in HistoricalCandlesGeneratorEvent: {}", response.request_guid());
+        return;
+    }
+
+    m_backtest_in_progress = true;
+    m_historical_md_channel.push({});
 }
 
-void StrategyInstance::handle_event(const HistoricalMDPriceEvent & response)
+void StrategyInstance::handle_event(const HistoricalMDBatchEvent &)
 {
-    handle_event(static_cast<const MDPriceEvent &>(response));
-    auto ev_opt = m_historical_md_generator->get_next();
-    if (!ev_opt.has_value()) {
-        m_stop_ev_channel.push({});
-        m_historical_md_generator.reset();
+    if (m_historical_candles_generator) {
+        replay_historical_candles();
         return;
     }
-    const auto & ev = ev_opt.value();
-    m_historical_md_channel.push(ev);
+
+    if (!m_historical_md_generator) {
+        return;
+    }
+
+    while (true) {
+        replay_historical_trades();
+
+        if (m_next_historical_trade == m_historical_trades.size()) {
+            m_next_historical_trade = 0;
+            if (!m_historical_md_generator->get_next_batch(m_historical_trades)) {
+                m_stop_ev_channel.push({});
+                m_historical_md_generator.reset();
+                return;
+            }
+        }
+
+        // events caused by the replayed trades must be handled before the next trade
+        if (m_event_loop.has_pending_events()) {
+            m_historical_md_channel.push({});
+            return;
+        }
+    }
+}
+
+void StrategyInstance::replay_historical_trades()
+{
+    const auto trades = std::span<const PublicTrade>{m_historical_trades}.subspan(m_next_historical_trade);
+
+    // trade that closes a candle is the last one in a batch, so the strategy gets the candle at the same price as with a single trade
+    size_t count = m_strategy->needs_every_tick()
+            ? 1
+            : std::min(trades.size(), m_candle_builder.first_closing_index(trades) + 1);
+
+    for (size_t i = 0; i < count; ++i) {
+        push_price(trades[i]);
+        if (m_event_loop.has_pending_events()) {
+            count = i + 1;
+            break;
+        }
+    }
+
+    m_next_historical_trade += count;
+    push_trades(trades.first(count));
+}
+
+void StrategyInstance::replay_historical_candles()
+{
+    while (true) {
+        replay_candle_path_point();
+
+        if (m_next_historical_candle == m_historical_candles.size()) {
+            m_next_historical_candle = 0;
+            if (!m_historical_candles_generator->get_next_batch(m_historical_candles)) {
+                m_stop_ev_channel.push({});
+                m_historical_candles_generator.reset();
+                return;
+            }
+        }
+
+        if (m_event_loop.has_pending_events()) {
+            m_historical_md_channel.push({});
+            return;
+        }
+    }
+}
+
+void StrategyInstance::replay_candle_path_point()
+{
+    const Candle & candle = m_historical_candles[m_next_historical_candle];
+    const PublicTrade point = CandlePath::point(candle, m_next_path_point, m_historical_md_request->path_model);
+
+    push_price(point);
+    // the whole candle goes to the builder at its open, like the trade that opens a candle closes the previous one
+    if (m_next_path_point == 0) {
+        m_new_candles.clear();
+        m_candle_builder.push_candle(candle, m_new_candles);
+        push_new_candles();
+    }
+    m_strategy->on_trades({&point, 1});
+
+    if (++m_next_path_point == CandlePath::points_count) {
+        m_next_path_point = 0;
+        ++m_next_historical_candle;
+    }
 }
 
 void StrategyInstance::handle_event(const MDPriceEvent & response)
 {
-    const auto & public_trade = response.public_trade;
+    push_price(response.public_trade);
+    push_trades({&response.public_trade, 1});
+}
+
+void StrategyInstance::push_price(const PublicTrade & public_trade)
+{
     m_last_ts_and_price = {public_trade.ts(), public_trade.price()};
     m_price_channel.push(public_trade.ts(), public_trade.price());
     if (!first_price_received) {
         first_price_received = true;
 
-        m_depo_channel.push(public_trade.ts(), 0.);
+        push_depo(public_trade.ts(), 0.);
         m_strategy_result.update([&](auto & res) {
             res.strategy_start_ts = public_trade.ts();
         });
     }
+}
 
-    const auto candles = m_candle_builder.push_trade(
-            public_trade.price(),
-            public_trade.volume(),
-            public_trade.ts());
+void StrategyInstance::push_trades(std::span<const PublicTrade> trades)
+{
+    m_new_candles.clear();
+    m_candle_builder.push_trades(trades, m_new_candles);
+    push_new_candles();
+
+    m_strategy->on_trades(trades);
+}
 
-    for (const auto & candle : candles) {
+void StrategyInstance::push_new_candles()
+{
+    for (const auto & candle : m_new_candles) {
         m_candle_channel.push(candle.ts(), candle);
         maybe_send_market_state_update(candle);
     }
@@ -474,6 +612,7 @@ void StrategyInstance::handle_event(const StrategyStartRequest &)
         HistoricalMDRequest historical_request(
                 m_symbol,
                 m_historical_md_request.value());
+        historical_request.candle_timeframe = m_candle_builder.timeframe();
         m_pending_requests.emplace(historical_request.guid);
         m_md_gateway.push_async_request(std::move(historical_request));
     }
@@ -494,6 +633,7 @@ void StrategyInstance::handle_event(const StrategyStopRequest &)
 
     m_backtest_in_progress = false;
     m_historical_md_generator.reset();
+    m_historical_candles_generator.reset();
     m_stop_request_handled = true;
 }
 
@@ -515,7 +655,7 @@ bool StrategyInstance::ready_to_finish() const
 {
     const bool pos_closed = m_position_manager.opened() == nullptr;
     const bool got_active_requests = m_pending_requests.empty() && m_live_md_requests.empty();
-    const bool historical_md_finished = !m_historical_md_generator.has_value();
+    const bool historical_md_finished = !m_historical_md_generator.has_value() && !m_historical_candles_generator.has_value();
     const bool res = pos_closed && got_active_requests && !m_backtest_in_progress && historical_md_finished;
     if (res) {
         LOG_STATUS("StrategyInstance is ready to finish");
@@ -10,6 +10,7 @@
 #include "JsonStrategyConfig.h"
 #include "MarketState.h"
 #include "OrderManager.h"
+#include "OrdinaryLeastSquares.h"
 #include "PositionManager.h"
 #include "StandardDeviation.h"
 #include "StrategyChannels.h"
@@ -22,6 +23,8 @@
 #include <memory>
 #include <optional>
 #include <set>
+#include <span>
+#include <vector>
 
 class StrategyInstance
 {
@@ -32,11 +35,14 @@ public:
             const std::string & entry_strategy_name,
             const JsonStrategyConfig & entry_strategy_config,
             IMarketDataGateway & md_gateway,
-            ITradingGateway & tr_gateway);
+            ITradingGateway & tr_gateway,
+            EventLoopMode event_loop_mode = EventLoopMode::Background);
 
     ~StrategyInstance();
 
     void set_channel_capacity(std::optional<std::chrono::milliseconds> capacity);
+    // Events of the instance log with the level instead of their thread's one, nullopt resets it
+    void set_log_level(std::optional<LogLevel> level);
     EventTimeseriesChannel<Trade> & trade_channel();
     EventTimeseriesChannel<ProfitPriceLevels> & price_levels_channel();
     EventTimeseriesChannel<StrategyInternalData> & strategy_internal_data_channel();
@@ -51,6 +57,8 @@ public:
     EventTimeseriesChannel<MarketStateRenderObject> & market_state_channel();
 
     void run_async();
+    // For EventLoopMode::CallerDriven. Runs everything on the calling thread until the instance is finished
+    void run_sync();
     void stop_async(bool panic = false);
     [[nodiscard("wait in future")]] std::future<void> finish_future();
     void wait_event_barrier();
@@ -63,7 +71,8 @@ private:
     void handle_event_generic(const T & ev);
 
     void handle_event(const HistoricalMDGeneratorEvent & response);
-    void handle_event(const HistoricalMDPriceEvent & response);
+    void handle_event(const HistoricalCandlesGeneratorEvent & response);
+    void handle_event(const HistoricalMDBatchEvent & ev);
     void handle_event(const MDPriceEvent & response);
     void handle_event(const OrderResponseEvent & response);
     void handle_event(const TradeEvent & response);
@@ -71,10 +80,23 @@ private:
     void handle_event(const StrategyStopRequest & response);
     void after_every_event();
 
+    void push_price(const PublicTrade & public_trade);
+    // candles and strategy's batch hook, prices must be pushed already
+    void push_trades(std::span<const PublicTrade> trades);
+    // Replays trades up to a candle close or until there are other events to handle
+    void replay_historical_trades();
+    // Replays candles point by point until there are no candles left or there are other events to handle
+    void replay_historical_candles();
+    void replay_candle_path_point();
+    // to the candle channel and market state
+    void push_new_candles();
+
     void maybe_send_market_state_update(const Candle& candle);
 
     void process_position_result(const PositionResult & new_result,
                                  std::chrono::milliseconds ts);
+    // depo channel and its trend are always updated together
+    void push_depo(std::chrono::milliseconds ts, double depo);
 
     void close_position(double price, std::chrono::milliseconds ts);
 
@@ -99,6 +121,7 @@ private:
     EventTimeseriesChannel<double> m_price_channel;
     EventTimeseriesChannel<Candle> m_candle_channel;
     EventTimeseriesChannel<double> m_depo_channel;
+    OLS::IncrementalPriceSolver m_depo_trend;
     EventTimeseriesChannel<PositionResult> m_positions_channel;
 
     EventTimeseriesChannel<TpslPrices> m_tpsl_channel;
@@ -130,9 +153,16 @@ private:
     std::promise<void> m_finish_promise;
 
     std::optional<HistoricalMDGeneratorEvent> m_historical_md_generator;
+    std::vector<PublicTrade> m_historical_trades;
+    size_t m_next_historical_trade = 0;
+    std::optional<HistoricalCandlesGeneratorEvent> m_historical_candles_generator;
+    std::vector<Candle> m_historical_candles;
+    size_t m_next_historical_candle = 0;
+    size_t m_next_path_point = 0; // in the current candle's price path
+    std::vector<Candle> m_new_candles;
     bool m_backtest_in_progress = false;
 
-    EventChannel<HistoricalMDPriceEvent> m_historical_md_channel;
+    EventChannel<HistoricalMDBatchEvent> m_historical_md_channel;
     EventChannel<StrategyStartRequest> m_start_ev_channel;
     EventChannel<StrategyStopRequest> m_stop_ev_channel;
     EventChannel<BarrierEvent> m_barrier_channel;
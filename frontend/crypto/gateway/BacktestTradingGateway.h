@@ -13,7 +13,6 @@ class BacktestEventConsumer final : public ILambdaAcceptor
 {
     void push(LambdaEvent value) override;
     void push_delayed(std::chrono::milliseconds delay, LambdaEvent value) override;
-    void discard_subscriber_events(xg::Guid) override{};
 };
 
 class BacktestTrailingStopLoss
@@ -1,11 +1,10 @@
 #include "ByBitMarketDataGateway.h"
 
-#include "BybitTradesDownloader.h"
 #include "Logger.h"
 #include "MarketDataMessages.h"
 #include "Ohlc.h"
-#include "ScopeExit.h"
 #include "Symbol.h"
+#include "Tracer.h"
 
 #include <chrono>
 #include <crossguid/guid.hpp>
@@ -24,6 +23,8 @@ ByBitMarketDataGateway::ByBitMarketDataGateway(bool start)
         return;
     }
     m_config = config_opt.value().market_data;
+    m_trades_downloader = BybitTradesDownloader({.url_base = m_config.public_data_url});
+    m_klines_downloader = BybitKlinesDownloader({.rest_url = m_config.rest_url});
 
     register_subs();
 
@@ -43,10 +44,13 @@ bool ByBitMarketDataGateway::reconnect_ws_client()
     m_ws_client = std::make_shared<WebSocketClient>(
             std::string(m_config.ws_url),
             std::nullopt,
-            [this](const json & j) {
-                on_price_received(j);
+            [](const json & j) {
+                LOG_WARNING("Unrecognized MD message: {}", j.dump());
             },
-            m_connection_watcher);
+            m_connection_watcher,
+            [this](std::string_view payload) {
+                return on_public_trades_received(payload);
+            });
 
     if (!m_ws_client->wait_until_ready()) {
         return false;
@@ -67,63 +71,6 @@ bool ByBitMarketDataGateway::reconnect_ws_client()
     return true;
 }
 
-struct OhlcResult
-{
-    std::string category;
-    std::string symbol;
-    std::vector<OHLC> ohlc_list;
-};
-
-OHLC from_strings(const std::string & timestamp,
-                  const std::string & open,
-                  const std::string & high,
-                  const std::string & low,
-                  const std::string & close,
-                  const std::string & volume,
-                  const std::string & turnover)
-{
-    return OHLC{.timestamp = std::chrono::milliseconds{std::stoull(timestamp)},
-                .open = std::stod(open),
-                .high = std::stod(high),
-                .low = std::stod(low),
-                .close = std::stod(close),
-                .volume = std::stod(volume),
-                .turnover = std::stod(turnover)};
-}
-
-void from_json(const json & j, OhlcResult & result)
-{
-    j.at("category").get_to(result.category);
-    j.at("symbol").get_to(result.symbol);
-
-    result.ohlc_list.clear();
-    for (const auto & ohlc_list : j.at("list")) {
-        auto ohlc = from_strings(ohlc_list[0].get<std::string>(),
-                                 ohlc_list[1].get<std::string>(),
-                                 ohlc_list[2].get<std::string>(),
-                                 ohlc_list[3].get<std::string>(),
-                                 ohlc_list[4].get<std::string>(),
-                                 ohlc_list[5].get<std::string>(),
-                                 ohlc_list[6].get<std::string>());
-        result.ohlc_list.push_back(ohlc);
-    }
-}
-
-struct OhlcResponse
-{
-    int ret_code = {};
-    std::string ret_msg;
-    OhlcResult result;
-};
-
-void from_json(const json & j, OhlcResponse & response)
-{
-    j.at("retCode").get_to(response.ret_code);
-    j.at("retMsg").get_to(response.ret_msg);
-    const auto & j2 = j["result"];
-    j2.get_to(response.result);
-}
-
 struct ServerTimeResponse
 {
     struct Result
@@ -195,83 +142,6 @@ void from_json(const json & j, SymbolResponse & response)
     j2.get_to(response.result);
 }
 
-bool ByBitMarketDataGateway::request_historical_klines(const std::string & symbol, const Timerange & timerange, KlinePackCallback && pack_callback)
-{
-    LOG_DEBUG(
-            "Whole requested interval seconds: {}",
-            std::chrono::duration_cast<std::chrono::seconds>(timerange.duration()).count());
-
-    auto last_start = timerange.start();
-    while (last_start < timerange.end()) {
-        const unsigned limit = 1000;
-        const auto end = [&]() -> std::chrono::milliseconds {
-            const auto possible_end = last_start + min_historical_interval * 1000;
-            if (timerange.end() < possible_end) {
-                return timerange.end();
-            }
-            else {
-                return possible_end;
-            }
-        }();
-
-        ScopeExit se([&]() {
-            last_start = end + min_historical_interval;
-        });
-
-        const std::chrono::milliseconds remaining_delta = timerange.end() - last_start;
-        LOG_DEBUG("Remaining time delta: {}ms", remaining_delta.count());
-
-        const std::string category = "linear";
-
-        const std::string request = [&]() {
-            std::stringstream ss;
-            ss << m_config.rest_url
-               << "/v5/market/kline"
-               << "?symbol=" << symbol
-               << "&category=" << category
-               << "&interval=" << min_historical_interval.count()
-               << "&limit=" << limit
-               << "&start=" << last_start.count()
-               << "&end=" << end.count();
-            return std::string(ss.str());
-        }();
-
-        auto future = rest_client.request_async(request);
-        future.wait();
-        OhlcResponse response;
-        const auto j = json::parse(future.get());
-        from_json(j, response);
-
-        std::map<std::chrono::milliseconds, OHLC> inter_result;
-        for (const auto & ohlc : response.result.ohlc_list) {
-            inter_result.try_emplace(ohlc.timestamp, ohlc);
-        }
-
-        LOG_DEBUG("Got {} prices", inter_result.size());
-        if (inter_result.empty()) {
-            LOG_WARNING("Empty kline result");
-            return false;
-        }
-        if (const auto delta = inter_result.begin()->first - last_start; delta > min_historical_interval) {
-            LOG_ERROR(
-                    "ERROR inconsistent time delta: {}s. Stopping",
-                    std::chrono::duration_cast<std::chrono::seconds>(delta).count());
-
-            LOG_ERROR(
-                    "First timestamp: {}s",
-                    std::chrono::duration_cast<std::chrono::seconds>(inter_result.begin()->first).count());
-            return false;
-        }
-        pack_callback(std::move(inter_result));
-    }
-
-    LOG_DEBUG(
-            "All prices received for interval: {}-{}",
-            timerange.start().count(),
-            timerange.end().count());
-    return true;
-}
-
 std::vector<Symbol> ByBitMarketDataGateway::get_symbols(const std::string & currency)
 {
     const std::string category = "linear";
@@ -339,9 +209,26 @@ void ByBitMarketDataGateway::push_async_request(LiveMDRequest && request)
 
 void ByBitMarketDataGateway::handle_event(const HistoricalMDRequest & request)
 {
-    const auto reader_ptr = BybitTradesDownloader::request(request);
-    HistoricalMDGeneratorEvent ev(request.guid, reader_ptr);
-    m_historical_prices_channel.push(ev);
+    switch (request.data.source) {
+    case HistoricalMDSource::Trades: {
+        const auto reader_ptr = m_trades_downloader.request(request);
+        HistoricalMDGeneratorEvent ev(request.guid, reader_ptr);
+        m_historical_prices_channel.push(ev);
+        break;
+    }
+    case HistoricalMDSource::Candles: {
+        const auto reader_ptr = m_trades_downloader.request_candles(request, request.candle_timeframe);
+        HistoricalCandlesGeneratorEvent ev(request.guid, reader_ptr);
+        m_historical_candles_channel.push(ev);
+        break;
+    }
+    case HistoricalMDSource::Klines: {
+        const auto reader_ptr = m_klines_downloader.request(request, request.candle_timeframe);
+        HistoricalCandlesGeneratorEvent ev(request.guid, reader_ptr);
+        m_historical_candles_channel.push(ev);
+        break;
+    }
+    }
 }
 
 void ByBitMarketDataGateway::handle_event(const LiveMDRequest & request)
@@ -367,20 +254,23 @@ void ByBitMarketDataGateway::handle_event(const PingCheckEvent & event)
     m_connection_watcher.handle_request(event);
 }
 
-void ByBitMarketDataGateway::on_price_received(const nlohmann::json & json)
+bool ByBitMarketDataGateway::on_public_trades_received(std::string_view payload)
 {
+    TraceScope trace("gateway", "ws_public_trades");
+    // only the websocket thread gets here, the buffer is reused between frames
+    if (!decode_public_trades(payload, m_decoded_trades)) {
+        return false;
+    }
+
     auto locked_ref = m_live_requests.lock();
     if (locked_ref.get().empty()) {
         LOG_ERROR("no request on MD received");
     }
 
-    const auto trades_list = json.get<ByBitPublicTradeList>();
-    for (const auto & trade : trades_list.trades) {
-        OHLC ohlc = {.timestamp = trade.timestamp, .open = trade.price, .high = trade.price, .low = trade.price, .close = trade.price};
-        // TODO pushing only close price is not quite correct
-        MDPriceEvent ev{{trade.timestamp, ohlc.close, SignedVolume{0.}}}; // TODO
-        m_live_prices_channel.push(ev);
+    for (const auto & trade : m_decoded_trades) {
+        m_live_prices_channel.push(MDPriceEvent{trade});
     }
+    return true;
 }
 
 void ByBitMarketDataGateway::register_subs()
@@ -432,4 +322,9 @@ EventChannel<HistoricalMDGeneratorEvent> & ByBitMarketDataGateway::historical_pr
     return m_historical_prices_channel;
 }
 
+EventChannel<HistoricalCandlesGeneratorEvent> & ByBitMarketDataGateway::historical_candles_channel()
+{
+    return m_historical_candles_channel;
+}
+
 EventChannel<MDPriceEvent> & ByBitMarketDataGateway::live_prices_channel() { return m_live_prices_channel; }
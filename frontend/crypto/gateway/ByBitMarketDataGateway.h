@@ -1,5 +1,7 @@
 #pragma once
 
+#include "BybitKlinesDownloader.h"
+#include "BybitTradesDownloader.h"
 #include "ConnectionWatcher.h"
 #include "EventChannel.h"
 #include "EventLoopSubscriber.h"
@@ -19,6 +21,7 @@
 
 #include <chrono>
 #include <functional>
+#include <string_view>
 #include <vector>
 
 class WorkerThreadLoop;
@@ -40,6 +43,7 @@ public:
     void push_async_request(LiveMDRequest && request) override;
 
     EventChannel<HistoricalMDGeneratorEvent> & historical_prices_channel() override;
+    EventChannel<HistoricalCandlesGeneratorEvent> & historical_candles_channel() override;
     EventChannel<MDPriceEvent> & live_prices_channel() override;
 
     void unsubscribe_from_live(xg::Guid guid) override;
@@ -54,13 +58,11 @@ private:
     void handle_event(const LiveMDRequest & request);
     void handle_event(const PingCheckEvent & event);
 
-    void on_price_received(const nlohmann::json & json);
+    // Returns false if the payload is not a publicTrade frame
+    bool on_public_trades_received(std::string_view payload);
 
     std::chrono::milliseconds get_server_time();
 
-    using KlinePackCallback = std::function<void(std::map<std::chrono::milliseconds, OHLC> &&)>;
-    bool request_historical_klines(const std::string & symbol, const Timerange & timerange, KlinePackCallback && cb);
-
     bool reconnect_ws_client();
 
     // IConnectionSupervisor
@@ -71,13 +73,15 @@ private:
     EventLoop m_event_loop;
 
     GatewayConfig::MarketData m_config;
+    BybitTradesDownloader m_trades_downloader;
+    BybitKlinesDownloader m_klines_downloader;
 
     Guarded<std::vector<LiveMDRequest>> m_live_requests; // TODO remove?
+    std::vector<PublicTrade> m_decoded_trades;
 
     std::chrono::milliseconds m_last_server_time = std::chrono::milliseconds{0};
 
     EventObjectChannel<WorkStatus> m_status;
-    TimeseriesChannel<OHLC> m_klines_channel;
 
     std::unique_ptr<WorkerThreadOnce> m_backtest_thread;
     std::unique_ptr<WorkerThreadLoop> m_live_thread;
@@ -91,6 +95,7 @@ private:
     EventChannel<PingCheckEvent> m_ping_event_channel;
 
     EventChannel<HistoricalMDGeneratorEvent> m_historical_prices_channel;
+    EventChannel<HistoricalCandlesGeneratorEvent> m_historical_candles_channel;
     EventChannel<MDPriceEvent> m_live_prices_channel;
 
     EventSubcriber m_sub;
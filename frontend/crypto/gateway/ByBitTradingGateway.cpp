@@ -4,6 +4,7 @@
 #include "LogLevel.h"
 #include "Logger.h"
 #include "Ohlc.h"
+#include "Tracer.h"
 
 #include <chrono>
 #include <stdexcept>
@@ -55,14 +56,16 @@ void ByBitTradingGateway::on_order_response(const json & j)
     }
 }
 
-void ByBitTradingGateway::on_execution(const json & j)
+bool ByBitTradingGateway::on_execution(std::string_view payload)
 {
-    LOG_INFO("Execution received {}", j);
-
-    ByBitMessages::ExecutionResult result;
-    from_json(j, result);
+    TraceScope trace("gateway", "ws_execution");
+    // only the websocket thread gets here, the buffer is reused between frames
+    if (!ByBitMessages::decode_executions(payload, m_decoded_executions)) {
+        return false;
+    }
+    LOG_INFO("Execution received {}", payload);
 
-    for (const auto & response : result.executions) {
+    for (const auto & response : m_decoded_executions) {
         if (response.execType == "Funding") {
             // TODO handle funding fees
             LOG_INFO("Execution is funding, skipping. Funding fee: {}", response.execFee);
@@ -71,11 +74,12 @@ void ByBitTradingGateway::on_execution(const json & j)
 
         auto trade_opt = response.to_trade();
         if (!trade_opt.has_value()) {
-            LOG_ERROR("ERROR can't get proper trade on execution: {}", j);
-            return;
+            LOG_ERROR("ERROR can't get proper trade on execution: {}", payload);
+            return true;
         }
         m_trade_channel.push(TradeEvent(std::move(trade_opt.value())));
     }
+    return true;
 }
 
 void ByBitTradingGateway::push_order_request(const OrderRequestEvent & order)
@@ -134,6 +138,7 @@ void ByBitTradingGateway::register_subs()
 
 void ByBitTradingGateway::process_event(const OrderRequestEvent & req)
 {
+    TraceScope trace("gateway", "rest_order_create");
     using namespace std::chrono_literals;
     const auto & order = req.order;
 
@@ -189,6 +194,7 @@ void ByBitTradingGateway::process_event(const OrderRequestEvent & req)
 
 void ByBitTradingGateway::process_event(const TpslRequestEvent & tpsl)
 {
+    TraceScope trace("gateway", "rest_tpsl");
     using namespace std::chrono_literals;
     LOG_DEBUG("Got TpslRequestEvent");
 
@@ -242,6 +248,7 @@ void ByBitTradingGateway::process_event(const TpslRequestEvent & tpsl)
 
 void ByBitTradingGateway::process_event(const TrailingStopLossRequestEvent & tsl)
 {
+    TraceScope trace("gateway", "rest_trailing_stop");
     using namespace std::chrono_literals;
 
     LOG_DEBUG("Got TrailingStopLossRequestEvent");
@@ -300,12 +307,12 @@ void ByBitTradingGateway::process_event(const PingCheckEvent & ping_event)
 
 void ByBitTradingGateway::on_ws_message(const json & j)
 {
+    TraceScope trace("gateway", "ws_message");
     LOG_DEBUG("on_ws_message: {}", j.dump());
     if (j.find("topic") != j.end()) {
         const auto & topic = j.at("topic");
         const std::map<std::string, std::function<void(const json &)>> topic_handlers = {
                 {"order", [&](const json & j) { on_order_response(j); }},
-                {"execution", [&](const json & j) { on_execution(j); }},
         };
         if (const auto it = topic_handlers.find(topic); it == topic_handlers.end()) {
             LOG_WARNING("Unregistered topic: {}", j.dump());
@@ -325,7 +332,8 @@ bool ByBitTradingGateway::reconnect_ws_client()
             m_config.ws_url,
             std::make_optional(WsKeys{.m_api_key = m_config.api_key, .m_secret_key = m_config.secret_key}),
             [this](const json & j) { on_ws_message(j); },
-            m_connection_watcher);
+            m_connection_watcher,
+            [this](std::string_view payload) { return on_execution(payload); });
 
     if (!m_ws_client->wait_until_ready()) {
         return false;
@@ -45,7 +45,8 @@ private:
 
     void on_ws_message(const json & j);
     void on_order_response(const json & j);
-    void on_execution(const json & j);
+    // Returns false if the payload is not an execution frame
+    bool on_execution(std::string_view payload);
 
     // IConnectionSupervisor
     void on_connection_lost() override;
@@ -70,5 +71,7 @@ private:
     EventChannel<TpslUpdatedEvent> m_tpsl_updated_channel;
     EventChannel<TrailingStopLossUpdatedEvent> m_trailing_stop_update_channel;
 
+    std::vector<ByBitMessages::ExecutionView> m_decoded_executions;
+
     EventSubcriber m_sub;
 };
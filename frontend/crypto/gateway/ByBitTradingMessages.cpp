@@ -1,5 +1,6 @@
 #include "ByBitTradingMessages.h"
 
+#include "JsonCursor.h"
 #include "Ohlc.h"
 #include "Logger.h"
 
@@ -91,6 +92,20 @@ void from_json(const json & j, TpslResult & tpsl_res)
 }
 
 std::optional<Trade> Execution::to_trade() const
+{
+    const ExecutionView view{
+            .symbol = symbol,
+            .side = side,
+            .execType = execType,
+            .execPrice = execPrice,
+            .qty = qty,
+            .execFee = execFee,
+            .execTime = std::chrono::milliseconds(std::stoll(execTime)),
+    };
+    return view.to_trade();
+}
+
+std::optional<Trade> ExecutionView::to_trade() const
 {
     const auto volume_opt = UnsignedVolume::from(qty);
     if (!volume_opt.has_value()) {
@@ -99,8 +114,8 @@ std::optional<Trade> Execution::to_trade() const
     }
 
     return Trade(
-            std::chrono::milliseconds(std::stoll(execTime)),
-            symbol,
+            execTime,
+            std::string(symbol),
             {}, // TODO
             execPrice,
             volume_opt.value(),
@@ -108,6 +123,90 @@ std::optional<Trade> Execution::to_trade() const
             execFee);
 }
 
+namespace {
+
+bool decode_execution(JsonCursor & cursor, std::vector<ExecutionView> & out)
+{
+    ExecutionView exec;
+    unsigned found_count = 0;
+    const auto read_string = [&](std::string_view & field) {
+        const auto str = cursor.string();
+        if (str.has_value()) {
+            field = str.value();
+            ++found_count;
+        }
+        return str.has_value();
+    };
+    const auto read_number = [&](auto & field) {
+        const auto number = cursor.quoted_number<std::remove_reference_t<decltype(field)>>();
+        if (number.has_value()) {
+            field = number.value();
+            ++found_count;
+        }
+        return number.has_value();
+    };
+
+    int64_t exec_time = 0;
+    const bool parsed = cursor.object([&](std::string_view key) {
+        if (key == "symbol") {
+            return read_string(exec.symbol);
+        }
+        if (key == "side") {
+            return read_string(exec.side);
+        }
+        if (key == "execType") {
+            return read_string(exec.execType);
+        }
+        if (key == "execPrice") {
+            return read_number(exec.execPrice);
+        }
+        if (key == "execQty") {
+            return read_number(exec.qty);
+        }
+        if (key == "execFee") {
+            return read_number(exec.execFee);
+        }
+        if (key == "execTime") {
+            return read_number(exec_time);
+        }
+        return cursor.skip_value();
+    });
+
+    constexpr unsigned fields_count = 7;
+    if (!parsed || found_count != fields_count) {
+        return false;
+    }
+    exec.execTime = std::chrono::milliseconds{exec_time};
+    out.push_back(exec);
+    return true;
+}
+
+} // namespace
+
+bool decode_executions(std::string_view payload, std::vector<ExecutionView> & out)
+{
+    out.clear();
+    bool is_execution = false;
+    JsonCursor cursor{payload};
+    const bool parsed = cursor.object([&](std::string_view key) {
+        if (key == "topic") {
+            const auto topic = cursor.string();
+            is_execution = topic == "execution";
+            return topic.has_value();
+        }
+        if (key == "data") {
+            return cursor.array([&] { return decode_execution(cursor, out); });
+        }
+        return cursor.skip_value();
+    });
+
+    if (!parsed || !is_execution) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
 std::optional<TpslUpdatedEvent> OrderResponseResult::on_tpsl_update(const std::array<ByBitMessages::OrderResponse, 2> & updates)
 {
     const auto & response = updates[0];
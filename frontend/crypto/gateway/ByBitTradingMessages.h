@@ -5,7 +5,9 @@
 #include <cstdint>
 #include <list>
 #include <string>
+#include <string_view>
 #include <variant>
+#include <vector>
 
 namespace ByBitMessages {
 
@@ -74,6 +76,20 @@ struct ExecutionResult
     std::list<Execution> executions;
 };
 
+// Fields of an execution that make a trade, views point into the websocket payload
+struct ExecutionView
+{
+    std::string_view symbol;
+    std::string_view side;
+    std::string_view execType;
+    double execPrice = 0.;
+    double qty = 0.;
+    double execFee = 0.;
+    std::chrono::milliseconds execTime = {};
+
+    std::optional<Trade> to_trade() const;
+};
+
 struct TpslResult
 {
     int ret_code = -1;
@@ -91,4 +107,8 @@ void from_json(const json & j, Execution & exec);
 void from_json(const json & j, ExecutionResult & exec_res);
 void from_json(const json & j, TpslResult & tpsl_res);
 
+// Decodes an execution frame without a json document. 'out' is cleared and reused.
+// Returns false if the payload is not an execution frame or it's malformed
+bool decode_executions(std::string_view payload, std::vector<ExecutionView> & out);
+
 } // namespace ByBitMessages
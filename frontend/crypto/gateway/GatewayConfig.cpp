@@ -7,6 +7,9 @@
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
 
 void from_json(const json & j, GatewayConfig::Trading & config)
 {
@@ -20,6 +23,9 @@ void from_json(const json & j, GatewayConfig::MarketData & config)
 {
     j.at("ws_url").get_to(config.ws_url);
     j.at("rest_url").get_to(config.rest_url);
+    if (j.contains("public_data_url")) {
+        j.at("public_data_url").get_to(config.public_data_url);
+    }
 }
 
 void from_json(const json & j, GatewayConfig & config)
@@ -42,6 +48,7 @@ nlohmann::json GatewayConfig::to_json() const
         {"market_data", {
             {"ws_url", market_data.ws_url},
             {"rest_url", market_data.rest_url},
+            {"public_data_url", market_data.public_data_url},
         }},
     };
     return j;
@@ -20,6 +20,7 @@ struct GatewayConfig
     {
         std::string ws_url;
         std::string rest_url;
+        std::string public_data_url = "https://public.bybit.com";
     };
 
     std::string exchange;
@@ -14,6 +14,7 @@ public:
     virtual void push_async_request(LiveMDRequest && request) = 0;
 
     virtual EventChannel<HistoricalMDGeneratorEvent> & historical_prices_channel() = 0;
+    virtual EventChannel<HistoricalCandlesGeneratorEvent> & historical_candles_channel() = 0;
     virtual EventChannel<MDPriceEvent> & live_prices_channel() = 0;
 
     virtual void unsubscribe_from_live(xg::Guid guid) = 0;
@@ -1,9 +1,60 @@
 #include "MarketDataMessages.h"
 
+#include "JsonCursor.h"
+
 #include <nlohmann/json.hpp>
 
+#include <optional>
 #include <ostream>
 
+namespace {
+
+constexpr std::string_view public_trade_topic_prefix = "publicTrade.";
+
+// {"T":1672304486865,"s":"BTCUSDT","S":"Buy","v":"0.001","p":"16578.50","L":"PlusTick","i":"...","BT":false}
+bool decode_public_trade(JsonCursor & cursor, std::vector<PublicTrade> & out)
+{
+    std::optional<int64_t> timestamp;
+    std::optional<double> price;
+    std::optional<double> volume;
+    std::optional<Side> side;
+    const bool parsed = cursor.object([&](std::string_view key) {
+        if (key == "T") {
+            timestamp = cursor.number<int64_t>();
+            return timestamp.has_value();
+        }
+        if (key == "p") {
+            price = cursor.quoted_number<double>();
+            return price.has_value();
+        }
+        if (key == "v") {
+            volume = cursor.quoted_number<double>();
+            return volume.has_value();
+        }
+        if (key == "S") {
+            const auto side_str = cursor.string();
+            if (side_str.has_value()) {
+                side = side_str.value() == "Buy" ? Side::buy() : Side::sell();
+            }
+            return side_str.has_value();
+        }
+        return cursor.skip_value();
+    });
+
+    if (!parsed || !timestamp.has_value() || !price.has_value() || !volume.has_value() || !side.has_value()) {
+        return false;
+    }
+
+    const auto unsigned_volume = UnsignedVolume::from(volume.value());
+    if (!unsigned_volume.has_value()) {
+        return false;
+    }
+    out.emplace_back(std::chrono::milliseconds{timestamp.value()}, price.value(), SignedVolume{unsigned_volume.value(), side.value()});
+    return true;
+}
+
+} // namespace
+
 void from_json(const nlohmann::json & j, ByBitPublicTrade & trade)
 {
     j.at("s").get_to(trade.symbol);
@@ -51,3 +102,27 @@ std::ostream & operator<<(std::ostream & os, const ByBitPublicTradeList & trades
     }
     return os;
 }
+
+bool decode_public_trades(std::string_view payload, std::vector<PublicTrade> & out)
+{
+    out.clear();
+    bool is_public_trade = false;
+    JsonCursor cursor{payload};
+    const bool parsed = cursor.object([&](std::string_view key) {
+        if (key == "topic") {
+            const auto topic = cursor.string();
+            is_public_trade = topic.has_value() && topic->starts_with(public_trade_topic_prefix);
+            return topic.has_value();
+        }
+        if (key == "data") {
+            return cursor.array([&] { return decode_public_trade(cursor, out); });
+        }
+        return cursor.skip_value();
+    });
+
+    if (!parsed || !is_public_trade) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
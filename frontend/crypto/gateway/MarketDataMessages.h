@@ -1,9 +1,12 @@
 #include "Side.h"
+#include "Trade.h"
 
 #include "nlohmann/json_fwd.hpp"
 
 #include <chrono>
 #include <string>
+#include <string_view>
+#include <vector>
 
 struct ByBitPublicTrade
 {
@@ -25,3 +28,8 @@ struct ByBitPublicTradeList
 };
 void from_json(const nlohmann::json & j, ByBitPublicTradeList & trades);
 std::ostream & operator<<(std::ostream & os, const ByBitPublicTradeList & trades);
+
+// Decodes a publicTrade frame straight from the websocket payload, without a json document.
+// 'out' is cleared and reused, so nothing is allocated once it is big enough for a frame.
+// Returns false if the payload is not a publicTrade frame or it's malformed
+bool decode_public_trades(std::string_view payload, std::vector<PublicTrade> & out);
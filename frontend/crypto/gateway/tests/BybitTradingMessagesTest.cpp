@@ -82,6 +82,44 @@ TEST(BybitTradingMessagesTest, SimpleOrderExecution)
     ASSERT_EQ(trade.side(), Side::sell());
 }
 
+TEST(BybitTradingMessagesTest, DecodeExecutionsSameAsJsonDocument)
+{
+    const std::string msg_str = R"({"topic":"execution","id":"100475188_BTCUSDT_8935822012","creationTime":1708249213759,"data":[)"
+                                R"({"category":"linear","symbol":"BTCUSDT","closedSize":"0","execFee":"0.0855525","execId":"8262dbfa-5434-51ed-8458-3b97d3d49b3a","execPrice":"51850","execQty":"0.003","execType":"Trade","execValue":"155.55","feeRate":"0.00055","tradeIv":"","markIv":"","blockTradeId":"","markPrice":"51860.26","indexPrice":"","underlyingPrice":"","leavesQty":"0","orderId":"b49d6860-3062-4295-aa1f-c6471f3c9b20","orderLinkId":"1708249213491","orderPrice":"49257.6","orderQty":"0.003","orderType":"Market","stopOrderType":"UNKNOWN","side":"Sell","execTime":"1708249213755","isLeverage":"0","isMaker":false,"seq":8935822012,"marketUnit":"","createType":"CreateByUser"},)"
+                                R"({"category":"linear","symbol":"BTCUSDT","execFee":"-0.01","execPrice":"51800.5","execQty":"0","execType":"Funding","leavesQty":"0","orderId":"","orderLinkId":"","side":"Buy","execTime":"1708249213800","isMaker":false,"seq":8935822013}]})";
+
+    std::vector<ByBitMessages::ExecutionView> executions;
+    ASSERT_TRUE(ByBitMessages::decode_executions(msg_str, executions));
+
+    ByBitMessages::ExecutionResult result;
+    from_json(nlohmann::json::parse(msg_str), result);
+
+    ASSERT_EQ(executions.size(), result.executions.size());
+    auto expected_it = result.executions.begin();
+    for (const auto & exec : executions) {
+        const auto & expected = *expected_it++;
+        EXPECT_EQ(exec.symbol, expected.symbol);
+        EXPECT_EQ(exec.side, expected.side);
+        EXPECT_EQ(exec.execType, expected.execType);
+        EXPECT_EQ(exec.execPrice, expected.execPrice);
+        EXPECT_EQ(exec.qty, expected.qty);
+        EXPECT_EQ(exec.execFee, expected.execFee);
+
+        const auto trade = exec.to_trade();
+        const auto expected_trade = expected.to_trade();
+        ASSERT_TRUE(trade.has_value());
+        ASSERT_TRUE(expected_trade.has_value());
+        EXPECT_EQ(trade->ts(), expected_trade->ts());
+        EXPECT_EQ(trade->symbol_name(), expected_trade->symbol_name());
+        EXPECT_EQ(trade->side(), expected_trade->side());
+        EXPECT_EQ(trade->signed_volume().value(), expected_trade->signed_volume().value());
+    }
+
+    EXPECT_FALSE(ByBitMessages::decode_executions(R"({"topic":"order","id":"1","creationTime":1,"data":[]})", executions));
+    EXPECT_FALSE(ByBitMessages::decode_executions(R"({"topic":"execution","data":[{"symbol":"BTCUSDT","side":"Buy"}]})", executions));
+    EXPECT_TRUE(executions.empty());
+}
+
 TEST(BybitTradingMessagesTest, MarketOrderAck)
 {
     const std::string msg_str = R"(
@@ -0,0 +1,66 @@
+#include "MarketDataMessages.h"
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Not a test, run by hand. Compares decoding of publicTrade frames to the json document
+namespace {
+
+std::string make_frame(size_t trades_count)
+{
+    std::string res = R"({"topic":"publicTrade.BTCUSDT","type":"snapshot","ts":1672304486868,"data":[)";
+    for (size_t i = 0; i < trades_count; ++i) {
+        if (i > 0) {
+            res += ",";
+        }
+        res += R"({"T":)" + std::to_string(1672304486865 + i) +
+                R"(,"s":"BTCUSDT","S":")" + (i % 2 == 0 ? "Buy" : "Sell") +
+                R"(","v":"0.001","p":")" + std::to_string(16578 + i) + R"(.50","L":"PlusTick","i":"20f43950-d8dd-5b31-9112-a178eb6023af","BT":false})";
+    }
+    res += "]}";
+    return res;
+}
+
+template <class F>
+std::chrono::microseconds measure(size_t iterations, F && f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        f();
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+}
+
+} // namespace
+
+int main()
+{
+    const std::string frame = make_frame(100);
+    constexpr size_t iterations = 10'000;
+
+    std::vector<PublicTrade> trades;
+    size_t decoded_count = 0;
+    const auto decoder_time = measure(iterations, [&] {
+        decode_public_trades(frame, trades);
+        decoded_count += trades.size();
+    });
+
+    size_t parsed_count = 0;
+    const auto json_time = measure(iterations, [&] {
+        const auto trades_list = nlohmann::json::parse(frame).get<ByBitPublicTradeList>();
+        parsed_count += trades_list.trades.size();
+    });
+
+    if (decoded_count != parsed_count) {
+        std::cerr << "Decoded " << decoded_count << " trades, json document has " << parsed_count << std::endl;
+        return 1;
+    }
+    std::cout << "Trades: " << decoded_count
+              << ", decoder: " << decoder_time.count() << "us"
+              << ", json document: " << json_time.count() << "us" << std::endl;
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include "MarketDataMessages.h"
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// counts allocations of the whole binary, for the check of the decoder's reuse of the buffer
+namespace {
+std::atomic<size_t> allocations_count = 0;
+
+// every form of new and delete goes through this pair. Out of line, so the compiler can't match an inlined free with a new
+[[gnu::noinline]] void * counted_alloc(std::size_t size, std::size_t alignment) noexcept
+{
+    ++allocations_count;
+    size = std::max<std::size_t>(size, 1);
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return std::malloc(size);
+    }
+    // size of aligned_alloc has to be a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+[[gnu::noinline]] void counted_free(void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void * counted_alloc_or_throw(std::size_t size, std::size_t alignment)
+{
+    if (void * ptr = counted_alloc(size, alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+} // namespace
+
+void * operator new(std::size_t size)
+{
+    return counted_alloc_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void * operator new[](std::size_t size)
+{
+    return counted_alloc_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void * operator new(std::size_t size, std::align_val_t alignment)
+{
+    return counted_alloc_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void * operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return counted_alloc_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return counted_alloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return counted_alloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void * operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return counted_alloc(size, static_cast<std::size_t>(alignment));
+}
+
+void * operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return counted_alloc(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void * ptr) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete(void * ptr, std::align_val_t) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void * ptr, std::align_val_t) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t, std::align_val_t) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t, std::align_val_t) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete(void * ptr, const std::nothrow_t &) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void * ptr, const std::nothrow_t &) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete(void * ptr, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void * ptr, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    counted_free(ptr);
+}
+
+namespace test {
+
+namespace {
+std::string make_frame(size_t trades_count)
+{
+    std::string res = R"({"topic":"publicTrade.BTCUSDT","type":"snapshot","ts":1672304486868,"data":[)";
+    for (size_t i = 0; i < trades_count; ++i) {
+        if (i > 0) {
+            res += ",";
+        }
+        res += R"({"T":)" + std::to_string(1672304486865 + i) +
+                R"(,"s":"BTCUSDT","S":")" + (i % 2 == 0 ? "Buy" : "Sell") +
+                R"(","v":"0.001","p":")" + std::to_string(16578 + i) + R"(.50","L":"PlusTick","i":"20f43950-d8dd-5b31-9112-a178eb6023af","BT":false})";
+    }
+    res += "]}";
+    return res;
+}
+} // namespace
+
+TEST(MarketDataMessagesTest, DecodePublicTrades)
+{
+    const std::string frame = R"(
+        {
+            "topic": "publicTrade.BTCUSDT",
+            "type": "snapshot",
+            "ts": 1672304486868,
+            "data": [
+                {
+                    "T": 1672304486865,
+                    "s": "BTCUSDT",
+                    "S": "Buy",
+                    "v": "0.001",
+                    "p": "16578.50",
+                    "L": "PlusTick",
+                    "i": "20f43950-d8dd-5b31-9112-a178eb6023af",
+                    "BT": false
+                },
+                {
+                    "i": "20f43950-d8dd-5b31-9112-a178eb6023b0",
+                    "BT": false,
+                    "p": "16578.00",
+                    "v": "0.25",
+                    "S": "Sell",
+                    "s": "BTCUSDT",
+                    "T": 1672304486866
+                }
+            ]
+        })";
+
+    std::vector<PublicTrade> trades;
+    ASSERT_TRUE(decode_public_trades(frame, trades));
+    ASSERT_EQ(trades.size(), 2);
+
+    EXPECT_EQ(trades[0].ts().count(), 1672304486865);
+    EXPECT_DOUBLE_EQ(trades[0].price(), 16578.5);
+    EXPECT_DOUBLE_EQ(trades[0].volume().value(), 0.001);
+
+    EXPECT_EQ(trades[1].ts().count(), 1672304486866);
+    EXPECT_DOUBLE_EQ(trades[1].price(), 16578.);
+    EXPECT_DOUBLE_EQ(trades[1].volume().value(), -0.25);
+}
+
+TEST(MarketDataMessagesTest, DecodeSameAsJsonDocument)
+{
+    const std::string frame = make_frame(100);
+
+    std::vector<PublicTrade> trades;
+    ASSERT_TRUE(decode_public_trades(frame, trades));
+
+    const auto trades_list = nlohmann::json::parse(frame).get<ByBitPublicTradeList>();
+    ASSERT_EQ(trades.size(), trades_list.trades.size());
+    for (size_t i = 0; i < trades.size(); ++i) {
+        const auto & expected = trades_list.trades[i];
+        EXPECT_EQ(trades[i].ts(), expected.timestamp);
+        EXPECT_EQ(trades[i].price(), expected.price);
+        EXPECT_EQ(trades[i].volume().value(), expected.volume * expected.side.sign());
+    }
+}
+
+TEST(MarketDataMessagesTest, OtherFramesAreNotDecoded)
+{
+    std::vector<PublicTrade> trades;
+    EXPECT_FALSE(decode_public_trades(R"({"success":true,"ret_msg":"pong","conn_id":"0970e817","op":"ping"})", trades));
+    EXPECT_FALSE(decode_public_trades(R"({"topic":"orderbook.1.BTCUSDT","ts":1672304486868,"data":{"s":"BTCUSDT","b":[],"a":[]}})", trades));
+    EXPECT_TRUE(trades.empty());
+
+    // malformed
+    EXPECT_FALSE(decode_public_trades(R"({"topic":"publicTrade.BTCUSDT","data":[{"T":1672304486865,"S":"Buy","v":"0.001"}]})", trades));
+    EXPECT_FALSE(decode_public_trades(R"({"topic":"publicTrade.BTCUSDT","data":[{"T":1672304486865,"S":"Buy","v":"0.001","p":"abc"}]})", trades));
+    EXPECT_FALSE(decode_public_trades(R"({"topic":"publicTrade.BTCUSDT","data":[{"T":1672304486865,"S":"Buy","v":"0.001","p":"1.5"})", trades));
+    EXPECT_TRUE(trades.empty());
+
+    EXPECT_TRUE(decode_public_trades(R"({"topic":"publicTrade.BTCUSDT","data":[]})", trades));
+    EXPECT_TRUE(trades.empty());
+}
+
+TEST(MarketDataMessagesTest, NoAllocationsWhenBufferIsBigEnough)
+{
+    const std::string frame = make_frame(100);
+
+    std::vector<PublicTrade> trades;
+    ASSERT_TRUE(decode_public_trades(frame, trades));
+
+    const size_t allocations_before = allocations_count;
+    for (size_t i = 0; i < 10; ++i) {
+        ASSERT_TRUE(decode_public_trades(frame, trades));
+    }
+    EXPECT_EQ(allocations_count - allocations_before, 0);
+    EXPECT_EQ(trades.size(), 100);
+}
+
+} // namespace test
@@ -3,6 +3,7 @@
 #include "Logger.h"
 
 #include <chrono>
+#include <iomanip>
 #include <openssl/evp.h>
 #include <openssl/hmac.h>
 
@@ -8,10 +8,12 @@ WebSocketClient::WebSocketClient(
         std::string url,
         std::optional<WsKeys> ws_keys,
         BusinessLogicCallback callback,
-        ConnectionWatcher & connection_watcher)
+        ConnectionWatcher & connection_watcher,
+        RawMessageCallback raw_callback)
     : m_url(std::move(url))
     , m_keys(std::move(ws_keys))
     , m_callback(std::move(callback))
+    , m_raw_callback(std::move(raw_callback))
     , m_connection_watcher(connection_watcher)
 {
     m_client_thread = std::make_unique<std::thread>([this]() {
@@ -39,8 +41,7 @@ WebSocketClient::WebSocketClient(
 
         // Register our message handler
         m_client.set_message_handler([this](auto, auto msg_ptr) {
-            const auto payload_string = msg_ptr->get_payload();
-            on_ws_message_received(payload_string);
+            on_ws_message_received(msg_ptr->get_payload());
         });
         m_client.set_open_handler([this](auto con_ptr) {
             LOG_STATUS("Ws connection created. URL: {}", m_url);
@@ -188,6 +189,11 @@ void WebSocketClient::on_sub_response(const nlohmann::json & j)
 
 void WebSocketClient::on_ws_message_received(const std::string & message)
 {
+    // hot topics are decoded straight from the payload, without a json document
+    if (m_raw_callback && m_raw_callback(message)) {
+        return;
+    }
+
     nlohmann::json j = json::parse(message);
     if (j.find("op") != j.end()) {
         const auto op = j.at("op");
@@ -5,6 +5,8 @@
 
 #include "nlohmann/json_fwd.hpp"
 
+#include <string_view>
+
 #include <websocketpp/client.hpp>
 #include <websocketpp/config/asio.hpp>
 #include <websocketpp/roles/client_endpoint.hpp>
@@ -23,13 +25,16 @@ class WebSocketClient : public IPingSender
     using context_ptr = websocketpp::lib::shared_ptr<boost::asio::ssl::context>;
     using json = nlohmann::json;
     using BusinessLogicCallback = std::function<void(const json &)>;
+    // Sees the payload before it's parsed, returns true if the message is handled
+    using RawMessageCallback = std::function<bool(std::string_view)>;
 
 public:
     WebSocketClient(
             std::string url,
             std::optional<WsKeys> ws_keys,
             BusinessLogicCallback callback,
-            ConnectionWatcher & connection_watcher);
+            ConnectionWatcher & connection_watcher,
+            RawMessageCallback raw_callback = {});
     ~WebSocketClient();
     bool wait_until_ready(std::chrono::milliseconds timeout = std::chrono::milliseconds(5000)) const;
     void subscribe(const std::string & topic);
@@ -54,6 +59,7 @@ private:
     std::optional<WsKeys> m_keys;
 
     BusinessLogicCallback m_callback;
+    RawMessageCallback m_raw_callback;
     ConnectionWatcher & m_connection_watcher;
 
     WsClient m_client;
@@ -4,7 +4,6 @@
 #include "Collector.h"
 #include "JsonStrategyConfig.h"
 #include "Logger.h"
-#include "ScopeExit.h"
 #include "StrategyInstance.h"
 
 #include <vector>
@@ -44,15 +43,13 @@ std::optional<JsonStrategyConfig> Optimizer::optimize()
                     // {.filter_name = "TradesPerMonth", .value = 10.},
             }};
 
-    LOG_DEBUG("Logs will be suppressed during optimization"); // TODO push as event
-    Logger::set_min_log_level(LogLevel::Warning);
-    ScopeExit se{[]() {
-        Logger::set_min_log_level(LogLevel::Debug);
-    }};
+    LOG_DEBUG("Logs of backtests will be suppressed during optimization"); // TODO push as event
 
     std::atomic<size_t> output_iter = 0;
     std::atomic<size_t> input_iter = 0;
     const auto thread_callback = [&] {
+        // only the optimizer's threads, a live strategy keeps its logs
+        ScopedLogLevel log_level{LogLevel::Warning};
         for (auto i = input_iter.fetch_add(1);
              i < configs.size();
              i = input_iter.fetch_add(1)) {
@@ -68,12 +65,11 @@ std::optional<JsonStrategyConfig> Optimizer::optimize()
                     m_strategy_name,
                     entry_config,
                     m_gateway,
-                    tr_gateway);
+                    tr_gateway,
+                    EventLoopMode::CallerDriven);
             tr_gateway.set_price_source(strategy_instance.price_channel());
             strategy_instance.set_channel_capacity(std::chrono::milliseconds{});
-            strategy_instance.run_async();
-            strategy_instance.wait_event_barrier(); // use future to wait
-            strategy_instance.finish_future().wait();
+            strategy_instance.run_sync();
             const auto result = strategy_instance.strategy_result_channel().get();
 
             auto lref = collector.lock();
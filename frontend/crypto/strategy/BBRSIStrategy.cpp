@@ -77,6 +77,8 @@ BBRSIStrategy::BBRSIStrategy(
     , m_rsi_bot_threshold(config.m_margin)
     , m_sub{event_loop}
 {
+    set_exit_strategy(m_exit_strategy);
+
     m_sub.subscribe(
             channels.candle_channel,
             [](const auto &) {},
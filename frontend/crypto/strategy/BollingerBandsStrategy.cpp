@@ -57,6 +57,8 @@ BollingerBandsStrategy::BollingerBandsStrategy(
     , m_bollinger_bands(config.m_interval, config.m_std_deviation_coefficient)
     , m_sub{event_loop}
 {
+    set_exit_strategy(m_exit_strategy);
+
     m_sub.subscribe(
             channels.price_channel,
             [](const auto &) {},
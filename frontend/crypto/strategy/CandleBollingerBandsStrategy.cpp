@@ -70,6 +70,8 @@ CandleBollingerBandsStrategy::CandleBollingerBandsStrategy(
     , m_bollinger_bands(config.m_interval, config.m_std_deviation_coefficient)
     , m_sub{event_loop}
 {
+    set_exit_strategy(m_exit_strategy);
+
     m_sub.subscribe(
             channels.candle_channel,
             [](const auto &) {},
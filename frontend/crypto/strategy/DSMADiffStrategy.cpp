@@ -62,6 +62,8 @@ DSMADiffStrategy::DSMADiffStrategy(
     , m_diff_threshold(conf.m_diff_threshold_percent / 100.)
     , m_sub{event_loop}
 {
+    set_exit_strategy(m_exit_strategy);
+
     m_sub.subscribe(
             channels.price_channel,
             [](const auto &) {},
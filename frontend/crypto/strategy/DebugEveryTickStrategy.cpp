@@ -47,6 +47,8 @@ DebugEveryTickStrategy::DebugEveryTickStrategy(
                       channels)
     , m_sub{event_loop}
 {
+    set_exit_strategy(m_exit_strategy);
+
     m_sub.subscribe(
             channels.price_channel,
             [](const auto &) {},
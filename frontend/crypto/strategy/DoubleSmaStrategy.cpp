@@ -58,6 +58,8 @@ DoubleSmaStrategy::DoubleSmaStrategy(
     , m_fast_avg(conf.m_fast_interval)
     , m_sub{event_loop}
 {
+    set_exit_strategy(m_exit_strategy);
+
     m_sub.subscribe(
             channels.price_channel,
             [](const auto &) {},
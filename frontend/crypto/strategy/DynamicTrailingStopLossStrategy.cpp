@@ -51,6 +51,11 @@ DynamicTrailingStopLossStrategy::DynamicTrailingStopLossStrategy(
             });
 }
 
+bool DynamicTrailingStopLossStrategy::needs_every_tick() const
+{
+    return m_tsl_sub && m_active_stop_loss && !m_triggered_once;
+}
+
 void DynamicTrailingStopLossStrategy::on_price_changed(
         std::pair<std::chrono::milliseconds, double> ts_and_price)
 {
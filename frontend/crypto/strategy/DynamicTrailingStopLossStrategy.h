@@ -27,6 +27,9 @@ public:
             EventLoop & event_loop,
             StrategyChannelsRefs channels);
 
+    // only while waiting for the no-loss level of an active stop loss
+    bool needs_every_tick() const override;
+
 private:
     void on_price_changed(
             std::pair<std::chrono::milliseconds, double> ts_and_price) override;
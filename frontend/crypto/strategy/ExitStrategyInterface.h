@@ -3,7 +3,9 @@
 #include "EventChannel.h"
 #include "EventTimeseriesChannel.h"
 #include "ConditionalOrders.h"
+#include "Trade.h"
 
+#include <span>
 #include <utility>
 
 class IExitStrategy
@@ -15,4 +17,8 @@ public:
     virtual EventTimeseriesChannel<StopLoss> & trailing_stop_channel() = 0;
 
     virtual EventChannel<std::pair<std::string, bool>> & error_channel() = 0;
+
+    // Same as IStrategy::on_trades and IStrategy::needs_every_tick
+    virtual void on_trades(std::span<const PublicTrade> /* trades */) {}
+    virtual bool needs_every_tick() const { return false; }
 };
@@ -22,6 +22,8 @@ public:
                   channels)
         , m_sub{event_loop}
     {
+        set_exit_strategy(m_exit_strategy);
+
         m_sub.subscribe(
                 channels.price_channel,
                 [](const auto &) {},
@@ -55,6 +55,8 @@ RatchetStrategy::RatchetStrategy(
     , m_ratchet(config.m_retracement)
     , m_sub{event_loop}
 {
+    set_exit_strategy(m_exit_strategy);
+
     m_sub.subscribe(
             channels.candle_channel,
             [](const auto &) {},
@@ -68,6 +68,8 @@ RateOfChangeStrategy::RateOfChangeStrategy(
                       channels)
     , m_sub{event_loop}
 {
+    set_exit_strategy(m_exit_strategy);
+
     m_sub.subscribe(
             channels.candle_channel,
             [](const auto &) {},
@@ -55,6 +55,8 @@ RelativeStrengthIndexStrategy::RelativeStrengthIndexStrategy(
     , m_rsi(config.m_interval)
     , m_sub{event_loop}
 {
+    set_exit_strategy(m_exit_strategy);
+
     m_sub.subscribe(
             channels.candle_channel,
             [](const auto &) {},
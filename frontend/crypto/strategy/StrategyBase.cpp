@@ -16,6 +16,18 @@ StrategyBase::StrategyBase(
             });
 }
 
+void StrategyBase::on_trades(std::span<const PublicTrade> trades)
+{
+    if (m_exit_strategy != nullptr) {
+        m_exit_strategy->on_trades(trades);
+    }
+}
+
+bool StrategyBase::needs_every_tick() const
+{
+    return m_exit_strategy != nullptr && m_exit_strategy->needs_every_tick();
+}
+
 bool StrategyBase::try_send_order(Side side, double price, std::chrono::milliseconds ts)
 {
     if (!m_order_manager.pending_orders().empty()) {
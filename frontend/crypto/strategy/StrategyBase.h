@@ -1,6 +1,7 @@
 #pragma once
 
 #include "EventChannel.h"
+#include "ExitStrategyInterface.h"
 #include "OrderManager.h"
 #include "StrategyChannels.h"
 #include "StrategyInterface.h"
@@ -25,9 +26,15 @@ public:
 
     EventChannel<std::pair<std::string, bool>> & error_channel() override { return m_error_channel; }
 
+    void on_trades(std::span<const PublicTrade> trades) override;
+    bool needs_every_tick() const override;
+
 protected:
     bool try_send_order(Side side, double price, std::chrono::milliseconds ts);
 
+    // Exit strategy gets the trades before the strategy itself
+    void set_exit_strategy(IExitStrategy & exit_strategy) { m_exit_strategy = &exit_strategy; }
+
 protected:
     const double m_pos_currency_amount = 100.;
 
@@ -40,5 +47,6 @@ protected:
     EventChannel<std::pair<std::string, bool>> m_error_channel;
 
 private:
+    IExitStrategy * m_exit_strategy = nullptr;
     EventSubcriber m_sub;
 };
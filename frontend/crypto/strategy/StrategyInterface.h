@@ -4,8 +4,10 @@
 #include "EventObjectChannel.h"
 #include "EventTimeseriesChannel.h"
 #include "MarketState.h"
+#include "Trade.h"
 
 #include <optional>
+#include <span>
 
 struct StrategyInternalData
 {
@@ -28,4 +30,11 @@ public:
     virtual bool is_valid() const = 0;
     virtual std::optional<std::chrono::milliseconds> timeframe() const = 0;
     virtual bool export_price_levels() const { return true; }
+
+    // Called synchronously with every batch of market data trades, after the price and candle channels got them.
+    // Strategies that work on candles only don't need it
+    virtual void on_trades(std::span<const PublicTrade> /* trades */) {}
+
+    // If true, trades are delivered by batches of a single trade. Must change only in event callbacks
+    virtual bool needs_every_tick() const { return false; }
 };
@@ -36,19 +36,19 @@ nlohmann::json StrategyResult::to_json() const
     };
 }
 
-void StrategyResult::set_trend_info(const std::vector<std::pair<std::chrono::milliseconds, double>> & prices)
+void StrategyResult::set_trend_info(const OLS::IncrementalPriceSolver & depo_solver)
 {
-    if (prices.empty()) {
+    if (depo_solver.empty()) {
         return;
     }
 
-    const auto [reg, dev] = OLS::solve_prices(prices);
+    const auto [reg, dev] = depo_solver.solve();
 
     depo_standard_deviation = dev;
     depo_trend_coef = reg.k;
     depo_trend_const = reg.c;
-    last_position_closed_ts = prices.back().first;
-    first_position_closed_ts = prices.front().first;
+    last_position_closed_ts = depo_solver.last_ts();
+    first_position_closed_ts = depo_solver.first_ts();
 }
 
 double StrategyResult::apr() const
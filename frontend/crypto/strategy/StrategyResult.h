@@ -7,6 +7,10 @@
 #include <cstddef>
 #include <optional>
 
+namespace OLS {
+class IncrementalPriceSolver;
+}
+
 class StrategyResult
 {
     friend std::ostream & operator<<(std::ostream & out, const StrategyResult & result);
@@ -24,7 +28,7 @@ public:
 
     double profit_per_trade() const { return final_profit / static_cast<double>(trades_count); }
 
-    void set_trend_info(const std::vector<std::pair<std::chrono::milliseconds, double>> & prices);
+    void set_trend_info(const OLS::IncrementalPriceSolver & depo_solver);
 
     double apr() const;
 
@@ -51,13 +51,6 @@ TpslExitStrategy::TpslExitStrategy(
     , m_event_loop{event_loop}
     , m_main_sub{event_loop}
 {
-    m_main_sub.subscribe(
-            channels.price_channel,
-            [](const auto &) {},
-            [this](const auto & ts, const double & price) {
-                m_last_ts_and_price = {ts, price};
-            });
-
     m_main_sub.subscribe(
             channels.opened_pos_channel,
             [this](const bool & v) {
@@ -77,8 +70,7 @@ void TpslExitStrategy::on_trade(const Trade & trade)
     // TODO set active tpsl, not it's not set anywhere
     if (m_is_pos_opened && m_active_tpsl != nullptr) {
         // position opened and tpsl is set already
-        const std::string_view msg = "TpslExitStrategy: active tpsl already exists";
-        LOG_WARNING(std::string(msg));
+        LOG_WARNING("TpslExitStrategy: active tpsl already exists");
         return;
     }
 
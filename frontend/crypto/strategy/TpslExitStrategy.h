@@ -54,7 +54,6 @@ private:
     TpslExitStrategyConfig m_config;
     EventLoop & m_event_loop;
 
-    std::pair<std::chrono::milliseconds, double> m_last_ts_and_price;
     bool m_is_pos_opened = false;
 
     std::optional<OpenedPosition> m_opened_position;
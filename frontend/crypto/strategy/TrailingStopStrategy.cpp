@@ -29,12 +29,6 @@ TrailigStopLossStrategy::TrailigStopLossStrategy(
     , m_config(config)
     , m_main_sub(event_loop)
 {
-    m_main_sub.subscribe(
-            channels.price_channel,
-            [](const auto &) {},
-            [this](const auto & ts, const double & price) {
-                on_price_changed({ts, price});
-            });
     m_main_sub.subscribe(
             channels.opened_pos_channel,
             [this](const bool & v) {
@@ -49,13 +43,19 @@ TrailigStopLossStrategy::TrailigStopLossStrategy(
             });
 }
 
+void TrailigStopLossStrategy::on_trades(std::span<const PublicTrade> trades)
+{
+    for (const auto & trade : trades) {
+        on_price_changed({trade.ts(), trade.price()});
+    }
+}
+
 void TrailigStopLossStrategy::on_trade(const Trade & trade)
 {
     if (m_is_pos_opened && m_tsl_sub) {
         // position opened
         // stop loss is set already
-        const std::string_view msg = "TrailigStopLossStrategy: active stop loss already exists or pending";
-        LOG_WARNING(std::string(msg));
+        LOG_WARNING("TrailigStopLossStrategy: active stop loss already exists or pending");
         return;
     }
 
@@ -27,6 +27,8 @@ public:
             EventLoop & event_loop,
             StrategyChannelsRefs channels);
 
+    void on_trades(std::span<const PublicTrade> trades) override;
+
 protected:
     virtual void on_price_changed(
             std::pair<std::chrono::milliseconds, double> /* ts_and_price */) {}
@@ -115,6 +115,8 @@ TrendCatcherStrategy::TrendCatcherStrategy(
     , m_exit(orders, config.make_exit_strategy_config(), event_loop, channels)
     , m_sub(event_loop)
 {
+    set_exit_strategy(m_exit);
+
     m_sub.subscribe(
             channels.candle_channel,
             [](const auto &) {},
@@ -78,6 +78,8 @@ VolumeImbalanceTrendStrategy::VolumeImbalanceTrendStrategy(
     , m_std(m_config.m_lookback_period)
     , m_sub(event_loop)
 {
+    set_exit_strategy(m_exit_strategy);
+
     m_sub.subscribe(
             channels.candle_channel,
             [](const auto &) {},
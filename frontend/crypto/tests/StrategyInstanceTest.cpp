@@ -1,13 +1,24 @@
 #include "StrategyInstance.h"
 
+#include "BacktestTradingGateway.h"
+#include "BybitTradesDownloader.h"
+#include "CandleFile.h"
+#include "CandlePath.h"
 #include "Events.h"
 #include "MockStrategy.h"
 #include "TpslExitStrategy.h"
 #include "Trade.h"
+#include "TradesDayCache.h"
+#include "TradesFile.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
 namespace test {
 using namespace testing;
 
@@ -30,6 +41,11 @@ public:
         return m_historical_channel;
     }
 
+    EventChannel<HistoricalCandlesGeneratorEvent> & historical_candles_channel() override
+    {
+        return m_historical_candles_channel;
+    }
+
     EventChannel<MDPriceEvent> & live_prices_channel() override
     {
         return m_live_prices_channel;
@@ -64,6 +80,7 @@ private:
     size_t m_unsubscribed_count = 0;
 
     EventChannel<HistoricalMDGeneratorEvent> m_historical_channel;
+    EventChannel<HistoricalCandlesGeneratorEvent> m_historical_candles_channel;
     EventChannel<MDPriceEvent> m_live_prices_channel;
 };
 
@@ -162,7 +179,6 @@ class MockEventConsumer : public ILambdaAcceptor
         throw std::runtime_error("Not implemented");
     }
 
-    void discard_subscriber_events(xg::Guid) override {}
 };
 
 class StrategyInstanceTest : public Test
@@ -210,6 +226,36 @@ protected:
     EventSubcriber status_sub;
 };
 
+TEST_F(StrategyInstanceTest, LogLevelIsPerInstance)
+{
+    MockMDGateway quiet_md_gateway;
+    StrategyInstance quiet_instance(
+            m_symbol,
+            std::nullopt,
+            "Mock",
+            JsonStrategyConfig{nlohmann::json{}},
+            quiet_md_gateway,
+            tr_gateway);
+    quiet_instance.set_log_level(LogLevel::Warning);
+
+    Logger::flush();
+    std::stringstream output;
+    auto * cout_buf = std::cout.rdbuf(output.rdbuf());
+
+    // unsolicited responses are logged at debug level
+    const auto quiet_guid = xg::newGuid();
+    const auto loud_guid = xg::newGuid();
+    quiet_md_gateway.historical_prices_channel().push(HistoricalMDGeneratorEvent{quiet_guid, nullptr});
+    md_gateway.historical_prices_channel().push(HistoricalMDGeneratorEvent{loud_guid, nullptr});
+    quiet_instance.wait_event_barrier();
+    strategy_instance->wait_event_barrier();
+
+    Logger::flush();
+    std::cout.rdbuf(cout_buf);
+    EXPECT_EQ(output.str().find(quiet_guid.str()), std::string::npos) << output.str();
+    EXPECT_NE(output.str().find(loud_guid.str()), std::string::npos) << output.str();
+}
+
 // strategy starts in stopped state
 // strategy sends MD request at start and goes to Live state
 // gateway sends price, strategy gets it
@@ -709,6 +755,229 @@ TEST_F(StrategyInstanceTest, OpenPos_TpslReject_ClosePosAndPanic)
     ASSERT_EQ(result.trades_count, 2);
 }
 
+// Replays a trades file or its candles file for every historical request
+class FileMDGateway : public IMarketDataGateway
+{
+public:
+    FileMDGateway(std::string trades_file, std::string candles_file)
+        : m_trades_file(std::move(trades_file))
+        , m_candles_file(std::move(candles_file))
+    {
+        m_status.push(WorkStatus::Live);
+    }
+
+    void push_async_request(HistoricalMDRequest && request) override
+    {
+        if (request.data.source == HistoricalMDSource::Candles) {
+            m_historical_candles_channel.push(HistoricalCandlesGeneratorEvent{
+                    request.guid,
+                    std::make_shared<SequentialCandleReader>(std::list<std::string>{m_candles_file}, std::nullopt, request.candle_timeframe)});
+            return;
+        }
+        m_historical_channel.push(HistoricalMDGeneratorEvent{
+                request.guid,
+                std::make_shared<SequentialMarketDataReader>(std::list<std::string>{m_trades_file})});
+    }
+
+    void push_async_request(LiveMDRequest &&) override {}
+    void unsubscribe_from_live(xg::Guid) override {}
+
+    EventChannel<HistoricalMDGeneratorEvent> & historical_prices_channel() override { return m_historical_channel; }
+    EventChannel<HistoricalCandlesGeneratorEvent> & historical_candles_channel() override { return m_historical_candles_channel; }
+    EventChannel<MDPriceEvent> & live_prices_channel() override { return m_live_prices_channel; }
+    EventObjectChannel<WorkStatus> & status_channel() override { return m_status; }
+
+private:
+    std::string m_trades_file;
+    std::string m_candles_file;
+
+    EventObjectChannel<WorkStatus> m_status;
+    EventChannel<HistoricalMDGeneratorEvent> m_historical_channel;
+    EventChannel<HistoricalCandlesGeneratorEvent> m_historical_candles_channel;
+    EventChannel<MDPriceEvent> m_live_prices_channel;
+};
+
+class StrategyInstanceBacktestTest : public Test
+{
+public:
+    struct BacktestOutput
+    {
+        StrategyResult result;
+        std::vector<std::pair<std::chrono::milliseconds, double>> depo;
+        std::vector<std::pair<std::chrono::milliseconds, Trade>> trades;
+        std::vector<std::pair<std::chrono::milliseconds, Candle>> candles;
+        std::vector<std::pair<std::chrono::milliseconds, double>> prices;
+    };
+
+    StrategyInstanceBacktestTest()
+        : m_trades_file(std::filesystem::temp_directory_path() / "strategy_instance_backtest_test.trades")
+        , m_candles_file(std::filesystem::temp_directory_path() / "strategy_instance_backtest_test.candles")
+    {
+        m_symbol.lot_size_filter.max_qty = 1'000'000;
+        m_symbol.lot_size_filter.min_qty = 0.001;
+        m_symbol.lot_size_filter.qty_step = 0.001;
+
+        TradeColumns columns;
+        for (size_t i = 0; i < 20000; ++i) {
+            const double price = 100. + 10. * std::sin(static_cast<double>(i) / 500.) + static_cast<double>(i % 7) * 0.1;
+            columns.push_back(PublicTrade{m_start + std::chrono::milliseconds{i * 100}, price, SignedVolume{i % 2 == 0 ? 1. : -1.}});
+        }
+        EXPECT_TRUE(TradesFile::write(m_trades_file, columns));
+        const auto day = TradesFile::map(m_trades_file);
+        EXPECT_TRUE(day.has_value() && CandleFile::write(m_candles_file, day.value()));
+    }
+
+    ~StrategyInstanceBacktestTest() override
+    {
+        TradesDayCache::i().clear();
+        std::filesystem::remove(m_trades_file);
+        std::filesystem::remove(m_candles_file);
+    }
+
+    BacktestOutput run_backtest(
+            EventLoopMode mode,
+            const std::string & strategy_name = "DebugEveryTick",
+            nlohmann::json config = {{"risk", 0.01}, {"no_loss_coef", 0.5}},
+            HistoricalMDSource source = HistoricalMDSource::Trades,
+            CandlePathModel path_model = CandlePathModel::ByDirection)
+    {
+        FileMDGateway md_gateway{m_trades_file.string(), m_candles_file.string()};
+        BacktestTradingGateway tr_gateway;
+        StrategyInstance instance(
+                m_symbol,
+                HistoricalMDRequestData{.start = m_start, .end = m_start + std::chrono::hours{1}, .source = source, .path_model = path_model},
+                strategy_name,
+                JsonStrategyConfig{config},
+                md_gateway,
+                tr_gateway,
+                mode);
+        tr_gateway.set_price_source(instance.price_channel());
+
+        if (mode == EventLoopMode::CallerDriven) {
+            instance.run_sync();
+        }
+        else {
+            auto finished = instance.finish_future();
+            instance.run_async();
+            finished.wait();
+            instance.wait_event_barrier();
+        }
+
+        const auto depo = instance.depo_channel().snapshot();
+        const auto trades = instance.trade_channel().snapshot();
+        const auto candles_snapshot = instance.candle_channel().snapshot();
+        const auto prices = instance.price_channel().snapshot();
+        return {
+                .result = instance.strategy_result_channel().get(),
+                .depo = {depo.begin(), depo.end()},
+                .trades = {trades.begin(), trades.end()},
+                .candles = {candles_snapshot.begin(), candles_snapshot.end()},
+                .prices = {prices.begin(), prices.end()},
+        };
+    }
+
+    static void expect_same_output(const BacktestOutput & output, const BacktestOutput & expected)
+    {
+        EXPECT_EQ(output.result.trades_count, expected.result.trades_count);
+        EXPECT_EQ(output.result.final_profit, expected.result.final_profit);
+        EXPECT_EQ(output.result.fees_paid, expected.result.fees_paid);
+        EXPECT_EQ(output.result.max_depo, expected.result.max_depo);
+        EXPECT_EQ(output.result.min_depo, expected.result.min_depo);
+        EXPECT_EQ(output.depo, expected.depo);
+
+        ASSERT_EQ(output.trades.size(), expected.trades.size());
+        for (auto it = output.trades.begin(), exp_it = expected.trades.begin(); it != output.trades.end(); ++it, ++exp_it) {
+            EXPECT_EQ(it->first, exp_it->first);
+            EXPECT_EQ(it->second.price(), exp_it->second.price());
+            EXPECT_EQ(it->second.unsigned_volume().value(), exp_it->second.unsigned_volume().value());
+        }
+    }
+
+protected:
+    const std::chrono::milliseconds m_start{1704067200000};
+    std::filesystem::path m_trades_file;
+    std::filesystem::path m_candles_file;
+    Symbol m_symbol{"BTCUSDT"};
+};
+
+TEST_F(StrategyInstanceBacktestTest, CallerDrivenLoopGivesSameResultAsBackgroundLoop)
+{
+    const auto background = run_backtest(EventLoopMode::Background);
+    const auto caller_driven = run_backtest(EventLoopMode::CallerDriven);
+
+    ASSERT_GT(background.result.trades_count, 10);
+    expect_same_output(caller_driven, background);
+}
+
+TEST_F(StrategyInstanceBacktestTest, PooledLoopGivesSameResultAsBackgroundLoop)
+{
+    const auto background = run_backtest(EventLoopMode::Background);
+    const auto pooled = run_backtest(EventLoopMode::Pooled);
+
+    ASSERT_GT(background.result.trades_count, 10);
+    expect_same_output(pooled, background);
+}
+
+// candle-only strategy gets the trades by batches
+TEST_F(StrategyInstanceBacktestTest, CandleStrategyGivesSameResultInBothLoopModes)
+{
+    const nlohmann::json config = {{"timeframe_s", 5}, {"margin", 20}, {"interval", 14}, {"risk", 0.01}, {"no_loss_coef", 0.5}};
+    const auto background = run_backtest(EventLoopMode::Background, "RelativeStrengthIndex", config);
+    const auto caller_driven = run_backtest(EventLoopMode::CallerDriven, "RelativeStrengthIndex", config);
+
+    ASSERT_GT(background.result.trades_count, 10);
+    expect_same_output(caller_driven, background);
+}
+
+// strategy must see the same candles, only the price path inside of them is approximated
+TEST_F(StrategyInstanceBacktestTest, CandleReplayGivesSameCandlesAsTradeReplay)
+{
+    const nlohmann::json config = {{"timeframe_s", 5}, {"margin", 20}, {"interval", 14}, {"risk", 0.01}, {"no_loss_coef", 0.5}};
+    const auto from_trades = run_backtest(EventLoopMode::CallerDriven, "RelativeStrengthIndex", config);
+    const auto from_candles = run_backtest(EventLoopMode::CallerDriven, "RelativeStrengthIndex", config, HistoricalMDSource::Candles);
+
+    ASSERT_GT(from_candles.result.trades_count, 10);
+    EXPECT_LT(from_candles.prices.size(), from_trades.prices.size() / 2);
+
+    ASSERT_EQ(from_candles.candles.size(), from_trades.candles.size());
+    for (size_t i = 0; i < from_trades.candles.size(); ++i) {
+        const auto & candle = from_candles.candles[i].second;
+        const auto & expected = from_trades.candles[i].second;
+        EXPECT_EQ(candle.ts(), expected.ts());
+        EXPECT_EQ(candle.open(), expected.open());
+        EXPECT_EQ(candle.high(), expected.high());
+        EXPECT_EQ(candle.low(), expected.low());
+        EXPECT_EQ(candle.close(), expected.close());
+        EXPECT_NEAR(candle.buy_taker_volume(), expected.buy_taker_volume(), 1e-9);
+        EXPECT_NEAR(candle.sell_taker_volume(), expected.sell_taker_volume(), 1e-9);
+        EXPECT_EQ(candle.trade_count(), expected.trade_count());
+    }
+}
+
+TEST_F(StrategyInstanceBacktestTest, CandlePathFollowsModel)
+{
+    const nlohmann::json config = {{"timeframe_s", 5}, {"margin", 20}, {"interval", 14}, {"risk", 0.01}, {"no_loss_coef", 0.5}};
+    for (const auto model : {CandlePathModel::OpenHighLowClose, CandlePathModel::OpenLowHighClose}) {
+        const auto output = run_backtest(EventLoopMode::CallerDriven, "RelativeStrengthIndex", config, HistoricalMDSource::Candles, model);
+
+        // open, extremes and close of every 1s candle
+        ASSERT_GT(output.prices.size(), 0);
+        ASSERT_EQ(output.prices.size() % CandlePath::points_count, 0);
+        for (size_t i = 0; i < output.prices.size(); i += CandlePath::points_count) {
+            const double first_extreme = output.prices[i + 1].second;
+            const double second_extreme = output.prices[i + 2].second;
+            if (model == CandlePathModel::OpenHighLowClose) {
+                EXPECT_GE(first_extreme, second_extreme);
+            }
+            else {
+                EXPECT_LE(first_extreme, second_extreme);
+            }
+            EXPECT_EQ(output.prices[i].first.count() % 1000, 0);
+            EXPECT_EQ(output.prices[i + 3].first.count() % 1000, 999);
+        }
+    }
+}
+
 // TODO
 // TEST_F(StrategyInstanceTest, PanicOnMarketDataStop) {}
 // TEST_F(StrategyInstanceTest, PanicOnTradingStop) {}
@@ -2,6 +2,7 @@
 
 #include "Events.h"
 #include "Logger.h"
+#include "Tracer.h"
 
 #include "fmt/format.h"
 
@@ -77,6 +78,7 @@ std::variant<SignedVolume, std::string> OrderManager::adjusted_volume(SignedVolu
 
 EventObjectChannel<std::shared_ptr<MarketOrder>> & OrderManager::send_market_order(double price, SignedVolume vol, std::chrono::milliseconds ts)
 {
+    TraceScope trace("orders", "order_send");
     const auto adj_vol_var = adjusted_volume(vol);
     if (std::holds_alternative<std::string>(adj_vol_var)) {
         m_error_channel.push(std::get<std::string>(adj_vol_var));
@@ -250,6 +252,7 @@ void OrderManager::on_stop_loss_reposnse(const StopLossUpdatedEvent & r)
 
 void OrderManager::on_order_response(const OrderResponseEvent & response)
 {
+    TraceScope trace("orders", "order_ack");
     const auto it = m_orders.find(response.request_guid);
     if (it == m_orders.end()) {
         LOG_WARNING("unsolicited OrderResponseEvent {}", response.request_guid);
@@ -338,6 +341,7 @@ bool OrderManager::try_trade_stop_loss(const TradeEvent & ev)
 
 void OrderManager::on_trade(const TradeEvent & ev)
 {
+    TraceScope trace("orders", "order_trade");
     if (try_trade_market_order(ev)) {
         return;
     }
@@ -370,6 +374,7 @@ EventObjectChannel<std::shared_ptr<TrailingStopLoss>> & OrderManager::send_trail
         const TrailingStopLoss & trailing_stop,
         std::chrono::milliseconds)
 {
+    TraceScope trace("orders", "trailing_stop_send");
     m_trailing_stop = std::make_unique<EventObjectChannel<std::shared_ptr<TrailingStopLoss>>>();
     auto & order_channel = *m_trailing_stop;
 
@@ -393,6 +398,7 @@ EventObjectChannel<std::shared_ptr<TpslFullPos>> & OrderManager::send_tpsl(
         Side side,
         std::chrono::milliseconds ts)
 {
+    TraceScope trace("orders", "tpsl_send");
     m_tpsl = std::make_unique<EventObjectChannel<std::shared_ptr<TpslFullPos>>>();
     auto & tpsl_ch = *m_tpsl;
 
@@ -420,6 +426,7 @@ EventObjectChannel<std::shared_ptr<TpslFullPos>> & OrderManager::send_tpsl(
 
 void OrderManager::on_trailing_stop_response(const TrailingStopLossUpdatedEvent & response)
 {
+    TraceScope trace("orders", "trailing_stop_ack");
     if (response.reject_reason.has_value()) {
         std::string err = "Rejected tpsl: " + response.reject_reason.value();
         m_error_channel.push(err);
@@ -450,6 +457,7 @@ void OrderManager::on_trailing_stop_response(const TrailingStopLossUpdatedEvent
 
 void OrderManager::on_tpsl_reposnse(const TpslUpdatedEvent & r)
 {
+    TraceScope trace("orders", "tpsl_ack");
     if (!m_tpsl) {
         std::string err = "Unsolicited tpsl response";
         m_error_channel.push(err);
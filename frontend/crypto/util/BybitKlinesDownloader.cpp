@@ -0,0 +1,317 @@
+#include "BybitKlinesDownloader.h"
+
+#include "DateTimeConverter.h"
+#include "JsonCursor.h"
+#include "Logger.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+size_t on_data_received(char * ptr, size_t size, size_t nmemb, void * userdata)
+{
+    auto * body = static_cast<std::string *>(userdata);
+    body->append(ptr, size * nmemb);
+    return size * nmemb;
+}
+
+std::optional<std::string> curl_get(const std::string & url)
+{
+    static std::once_flag curl_init_flag;
+    std::call_once(curl_init_flag, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+    CURL * curl = curl_easy_init();
+    if (curl == nullptr) {
+        LOG_ERROR("Can't init curl");
+        return std::nullopt;
+    }
+
+    std::string body;
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, on_data_received);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 60L);
+
+    const CURLcode res = curl_easy_perform(curl);
+    curl_easy_cleanup(curl);
+    if (res != CURLE_OK) {
+        LOG_ERROR("Failed to fetch {}: {}", url, curl_easy_strerror(res));
+        return std::nullopt;
+    }
+    return body;
+}
+
+template <class T>
+bool parse_number(std::string_view str, T & value)
+{
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    return ec == std::errc{} && ptr == str.data() + str.size();
+}
+
+// [start, open, high, low, close, volume, turnover]
+std::optional<CandleRecord> parse_kline(JsonCursor & cursor)
+{
+    std::array<std::string_view, 7> fields;
+    if (!cursor.consume('[')) {
+        return std::nullopt;
+    }
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const auto field = cursor.string();
+        if (!field.has_value() || (i + 1 < fields.size() && !cursor.consume(','))) {
+            return std::nullopt;
+        }
+        fields[i] = field.value();
+    }
+    if (!cursor.consume(']')) {
+        return std::nullopt;
+    }
+
+    CandleRecord res;
+    double volume = 0.;
+    if (!parse_number(fields[0], res.ts) ||
+        !parse_number(fields[1], res.open) ||
+        !parse_number(fields[2], res.high) ||
+        !parse_number(fields[3], res.low) ||
+        !parse_number(fields[4], res.close) ||
+        !parse_number(fields[5], volume)) {
+        return std::nullopt;
+    }
+    res.buy_taker_volume = volume / 2.;
+    res.sell_taker_volume = volume / 2.;
+    return res;
+}
+
+// Uncovered ranges of the day, both ends inclusive. Klines must be sorted
+std::vector<std::pair<std::chrono::milliseconds, std::chrono::milliseconds>> find_gaps(
+        std::span<const CandleRecord> klines,
+        std::chrono::milliseconds day_start,
+        std::chrono::milliseconds day_end)
+{
+    std::vector<std::pair<std::chrono::milliseconds, std::chrono::milliseconds>> res;
+    std::chrono::milliseconds expected = day_start;
+    for (const auto & kline : klines) {
+        const std::chrono::milliseconds ts{kline.ts};
+        if (ts > expected) {
+            res.emplace_back(expected, ts - std::chrono::milliseconds{1});
+        }
+        expected = ts + BybitKlinesDownloader::kline_interval;
+    }
+    if (expected < day_end) {
+        res.emplace_back(expected, day_end - std::chrono::milliseconds{1});
+    }
+    return res;
+}
+
+} // namespace
+
+BybitKlinesDownloader::BybitKlinesDownloader(KlinesDownloaderConfig config)
+    : m_config(std::move(config))
+{
+    if (!m_config.fetch) {
+        m_config.fetch = curl_get;
+    }
+}
+
+std::optional<std::vector<CandleRecord>> BybitKlinesDownloader::parse_response(std::string_view response)
+{
+    // keys can go in any order
+    JsonCursor cursor{response};
+    const auto ret_code = cursor.find_key("retCode") ? cursor.number<int>() : std::nullopt;
+    if (!ret_code.has_value()) {
+        LOG_ERROR("Malformed kline response: {}", response.substr(0, 100));
+        return std::nullopt;
+    }
+    if (ret_code.value() != 0) {
+        cursor = JsonCursor{response};
+        const auto ret_msg = cursor.find_key("retMsg") ? cursor.string() : std::nullopt;
+        LOG_ERROR("Kline request failed: {} {}", ret_code.value(), ret_msg.value_or(""));
+        return std::nullopt;
+    }
+
+    cursor = JsonCursor{response};
+    if (!cursor.find_key("list") || !cursor.consume('[')) {
+        LOG_ERROR("No kline list in response: {}", response.substr(0, 100));
+        return std::nullopt;
+    }
+
+    // newest first
+    std::vector<CandleRecord> res;
+    res.reserve(page_limit);
+    while (!cursor.peek(']')) {
+        const auto kline = parse_kline(cursor);
+        if (!kline.has_value() || (!cursor.peek(']') && !cursor.consume(','))) {
+            LOG_ERROR("Malformed kline in response: {}", response.substr(0, 100));
+            return std::nullopt;
+        }
+        res.push_back(kline.value());
+    }
+    std::ranges::reverse(res);
+    if (!std::ranges::is_sorted(res, {}, &CandleRecord::ts)) {
+        std::ranges::sort(res, {}, &CandleRecord::ts);
+    }
+    return res;
+}
+
+std::optional<std::vector<CandleRecord>> BybitKlinesDownloader::fetch_page(const std::string & symbol_name, const Page & page) const
+{
+    const std::string url = m_config.rest_url +
+            "/v5/market/kline?category=linear&symbol=" + symbol_name +
+            "&interval=" + std::to_string(kline_interval.count()) +
+            "&start=" + std::to_string(page.start.count()) +
+            "&end=" + std::to_string(page.end.count()) +
+            "&limit=" + std::to_string(page_limit);
+
+    const auto response = m_config.fetch(url);
+    if (!response.has_value()) {
+        return std::nullopt;
+    }
+    auto klines = parse_response(response.value());
+    if (!klines.has_value()) {
+        return std::nullopt;
+    }
+
+    for (const auto & kline : klines.value()) {
+        if (kline.ts < page.start.count() || kline.ts > page.end.count()) {
+            LOG_ERROR("Unexpected kline at {} for page {}-{}", kline.ts, page.start.count(), page.end.count());
+            return std::nullopt;
+        }
+    }
+    return klines;
+}
+
+std::vector<std::optional<std::vector<CandleRecord>>> BybitKlinesDownloader::fetch_pages(const std::string & symbol_name, std::span<const Page> pages) const
+{
+    std::vector<std::optional<std::vector<CandleRecord>>> res(pages.size());
+    std::atomic<size_t> next_page = 0;
+    const auto worker = [&] {
+        for (size_t i = next_page++; i < pages.size(); i = next_page++) {
+            res[i] = fetch_page(symbol_name, pages[i]);
+        }
+    };
+
+    const size_t threads_count = std::clamp<size_t>(m_config.max_parallel_requests, 1, std::max<size_t>(pages.size(), 1));
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threads_count; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto & t : threads) {
+        t.join();
+    }
+    return res;
+}
+
+std::list<std::string> BybitKlinesDownloader::download(const HistoricalMDRequest & req) const
+{
+    std::filesystem::create_directories(m_config.download_dir);
+
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
+    const std::chrono::milliseconds page_duration = kline_interval * page_limit;
+
+    std::vector<std::chrono::milliseconds> day_starts;
+    std::vector<std::string> paths;
+    for (std::chrono::milliseconds day_start = std::chrono::floor<std::chrono::days>(req.data.start);
+         day_start < req.data.end;
+         day_start += std::chrono::days{1}) {
+        if (day_start + std::chrono::days{1} > now) {
+            LOG_WARNING("Klines of unfinished days are not served, skipping {}", DateTimeConverter::date(day_start));
+            break;
+        }
+        day_starts.push_back(day_start);
+        // BTCUSDT2024-12-25.klines
+        paths.push_back(m_config.download_dir + "/" + req.symbol.symbol_name + DateTimeConverter::date(day_start) + std::string{extension});
+    }
+
+    // pages of all missing days go at once, so the latency is paid once per max_parallel_requests pages
+    std::vector<char> fetching(day_starts.size(), false);
+    std::vector<Page> pages;
+    for (size_t day = 0; day < day_starts.size(); ++day) {
+        if (CandleFile::has_valid_header(paths[day])) {
+            continue;
+        }
+        fetching[day] = true;
+        const auto day_end = day_starts[day] + std::chrono::days{1};
+        for (auto page_start = day_starts[day]; page_start < day_end; page_start += page_duration) {
+            pages.push_back({.day = day, .start = page_start, .end = std::min(page_start + page_duration, day_end) - std::chrono::milliseconds{1}});
+        }
+    }
+
+    size_t failed_count = 0;
+    std::vector<std::vector<CandleRecord>> day_klines(day_starts.size());
+    const auto page_results = fetch_pages(req.symbol.symbol_name, pages);
+    for (size_t i = 0; i < pages.size(); ++i) {
+        const size_t day = pages[i].day;
+        if (!fetching[day]) {
+            continue;
+        }
+        if (!page_results[i].has_value()) {
+            LOG_ERROR("Can't fetch klines of {} for {}", req.symbol.symbol_name, DateTimeConverter::date(day_starts[day]));
+            fetching[day] = false;
+            ++failed_count;
+            continue;
+        }
+        day_klines[day].insert(day_klines[day].end(), page_results[i]->begin(), page_results[i]->end());
+    }
+
+    // gaps are requested once more, a response of the exchange can be incomplete
+    std::vector<Page> repair_pages;
+    for (size_t day = 0; day < day_starts.size(); ++day) {
+        if (!fetching[day]) {
+            continue;
+        }
+        // a gap can be longer than a page, e.g. a page that came back empty
+        for (const auto & [gap_start, gap_end] : find_gaps(day_klines[day], day_starts[day], day_starts[day] + std::chrono::days{1})) {
+            for (auto page_start = gap_start; page_start <= gap_end; page_start += page_duration) {
+                repair_pages.push_back({.day = day, .start = page_start, .end = std::min(page_start + page_duration - std::chrono::milliseconds{1}, gap_end)});
+            }
+        }
+    }
+    const auto repair_results = fetch_pages(req.symbol.symbol_name, repair_pages);
+    for (size_t i = 0; i < repair_pages.size(); ++i) {
+        if (repair_results[i].has_value()) {
+            auto & klines = day_klines[repair_pages[i].day];
+            klines.insert(klines.end(), repair_results[i]->begin(), repair_results[i]->end());
+        }
+    }
+
+    for (size_t day = 0; day < day_starts.size(); ++day) {
+        if (!fetching[day]) {
+            continue;
+        }
+
+        auto & klines = day_klines[day];
+        std::ranges::sort(klines, {}, &CandleRecord::ts);
+        const auto [first, last] = std::ranges::unique(klines, {}, &CandleRecord::ts);
+        klines.erase(first, last);
+
+        // there is no data for them, e.g. before the listing
+        if (const auto gaps = find_gaps(klines, day_starts[day], day_starts[day] + std::chrono::days{1}); !gaps.empty()) {
+            LOG_WARNING("{} gaps in klines of {} for {}", gaps.size(), req.symbol.symbol_name, DateTimeConverter::date(day_starts[day]));
+        }
+        if (!CandleFile::write(paths[day], klines, kline_interval)) {
+            ++failed_count;
+        }
+    }
+
+    if (failed_count > 0) {
+        // fetched days stay on disk, next request continues from there
+        LOG_ERROR("{} of {} days of klines are not available", failed_count, day_starts.size());
+        return {};
+    }
+    return {paths.begin(), paths.end()};
+}
+
+std::shared_ptr<SequentialCandleReader> BybitKlinesDownloader::request(const HistoricalMDRequest & req, std::chrono::milliseconds timeframe) const
+{
+    return std::make_shared<SequentialCandleReader>(download(req), req.data, timeframe);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "BybitTradesDownloader.h"
+#include "CandleFile.h"
+#include "Events.h"
+
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct KlinesDownloaderConfig
+{
+    // GET of the URL, response body or nullopt on a transport error. Called from several threads at once
+    using Fetcher = std::function<std::optional<std::string>(const std::string & url)>;
+
+    std::string rest_url = "https://api.bybit.com";
+    std::string download_dir = ".download";
+    unsigned max_parallel_requests = 4;
+    Fetcher fetch = {}; // curl if not set, tests put a local stand-in of the REST endpoint here
+};
+
+/*
+ * 1-minute klines of /v5/market/kline, cached on disk per symbol-day as candle files with 1m and 1h levels.
+ * Only finished days are served, so a cached day never changes.
+ * Pages of all the missing days are fetched concurrently. Gaps in a fetched day are requested once more,
+ * by pages of the same limit, what is still missing is considered a gap of the exchange's data and is cached as is.
+ * Klines have no taker side, the volume is split evenly between buy and sell.
+ */
+class BybitKlinesDownloader
+{
+public:
+    static constexpr std::chrono::minutes kline_interval{1};
+    static constexpr size_t page_limit = 1000;
+    static constexpr std::string_view extension = ".klines";
+
+    BybitKlinesDownloader(KlinesDownloaderConfig config = {});
+
+    std::shared_ptr<SequentialCandleReader> request(const HistoricalMDRequest & req, std::chrono::milliseconds timeframe) const;
+
+    // Klines of a /v5/market/kline response sorted by start, nullopt on an error response.
+    // Only the kline list is parsed, without building a json document
+    static std::optional<std::vector<CandleRecord>> parse_response(std::string_view response);
+
+private:
+    // Both ends are inclusive, as in the request
+    struct Page
+    {
+        size_t day = 0;
+        std::chrono::milliseconds start;
+        std::chrono::milliseconds end;
+    };
+
+    std::list<std::string> download(const HistoricalMDRequest & req) const;
+
+    // Results are in the order of the pages, nullopt for a page that failed
+    std::vector<std::optional<std::vector<CandleRecord>>> fetch_pages(const std::string & symbol_name, std::span<const Page> pages) const;
+    std::optional<std::vector<CandleRecord>> fetch_page(const std::string & symbol_name, const Page & page) const;
+
+private:
+    KlinesDownloaderConfig m_config;
+};
@@ -1,10 +1,18 @@
 #include "BybitTradesDownloader.h"
 
+#include "Checksum.h"
 #include "DateTimeConverter.h"
+#include "GzipDownloader.h"
 #include "Logger.h"
+#include "TradesCsvParser.h"
+#include "TradesDayCache.h"
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
+#include <fstream>
 #include <list>
+#include <thread>
 
 namespace {
 
@@ -12,7 +20,8 @@ std::list<std::string> time_range_to_string_list(HistoricalMDRequestData timeran
 {
     std::list<std::string> res;
 
-    auto current = timerange.start;
+    // from the start of the first day, so a range ending in the middle of the next day doesn't lose it
+    std::chrono::milliseconds current = std::chrono::floor<std::chrono::days>(timerange.start);
     auto end = timerange.end;
     while (end > current) {
         res.push_back(DateTimeConverter::date(current));
@@ -35,161 +44,338 @@ std::list<std::string> csv_file_list(const HistoricalMDRequest & req)
     return res;
 }
 
-std::vector<std::string> split_string(const std::string & s, const std::string & delimiter)
+std::string trades_path_for(const std::string & csv_path)
 {
-    size_t pos_start = 0, pos_end = 0;
-    const auto delim_len = delimiter.length();
-    std::string token;
-    std::vector<std::string> res;
+    return std::filesystem::path(csv_path).replace_extension(TradesFile::extension).string();
+}
+
+std::string candles_path_for(const std::string & path)
+{
+    return std::filesystem::path(path).replace_extension(CandleFile::extension).string();
+}
 
-    while ((pos_end = s.find(delimiter, pos_start)) != std::string::npos) {
-        token = s.substr(pos_start, pos_end - pos_start);
-        pos_start = pos_end + delim_len;
-        res.push_back(token);
+// Builds the candle pyramid from the trades file
+bool prepare_candles(const std::string & trades_path)
+{
+    const std::string candles_path = candles_path_for(trades_path);
+    if (CandleFile::has_valid_header(candles_path)) {
+        return true;
     }
 
-    res.push_back(s.substr(pos_start));
-    return res;
+    // through the cache, the day is likely to be replayed right after
+    const auto day = TradesDayCache::i().get(trades_path);
+    if (day == nullptr || !CandleFile::write(candles_path, *day)) {
+        LOG_ERROR("Can't build candles for: {}", trades_path);
+        return false;
+    }
+    return true;
 }
 
-} // namespace
+std::string checksum_path_for(const std::string & csv_path)
+{
+    return csv_path + ".fnv1a";
+}
 
-FileReader::FileReader(std::string filepath)
-    : ifs(filepath)
+void record_checksum(const std::string & csv_path, uint64_t checksum)
 {
+    std::ofstream ofs(checksum_path_for(csv_path), std::ios::trunc);
+    ofs << std::hex << checksum;
+}
+
+std::optional<uint64_t> file_checksum(const std::string & path)
+{
+    std::ifstream ifs(path, std::ios::binary);
     if (!ifs.is_open()) {
-        LOG_ERROR("Can't open file: {}, {}", filepath, errno);
-        return;
+        return std::nullopt;
+    }
+
+    Fnv1a hash;
+    std::vector<char> buffer(1024 * 1024);
+    while (ifs.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || ifs.gcount() > 0) {
+        hash.update(buffer.data(), static_cast<size_t>(ifs.gcount()));
     }
-    std::getline(ifs, last_line); // skip csv header
+    return hash.value();
 }
 
-// 0 - timestamp,
-// 1 - symbol,
-// 2 - side,
-// 3 - size,
-// 4 - price,
-// 5 - tickDirection,
-// 6 - trdMatchID,
-// 7 - grossValue,
-// 8 - homeNotional,
-// 9 - foreignNotional
-std::optional<PublicTrade> FileReader::get_next()
+// A file without a recorded checksum could be left by an interrupted download
+bool is_download_complete(const std::string & csv_path)
 {
-    if (!std::getline(ifs, last_line)) {
-        return std::nullopt;
+    std::ifstream ifs(checksum_path_for(csv_path));
+    uint64_t recorded = 0;
+    if (!(ifs >> std::hex >> recorded)) {
+        return false;
     }
+    return file_checksum(csv_path) == recorded;
+}
+
+} // namespace
+
+SequentialMarketDataReader::SequentialMarketDataReader(
+        std::list<std::string> files,
+        std::optional<HistoricalMDRequestData> time_range)
+    : m_files(std::move(files))
+    , m_time_range(time_range)
+{
+}
+
+bool SequentialMarketDataReader::open_next_day_if_needed()
+{
+    while (m_day == nullptr || m_next_trade >= m_end_trade) {
+        if (m_files.empty()) {
+            return false;
+        }
 
-    const auto split_str = split_string(last_line, ",");
-    const std::string & ts_str = split_str[0];
-    const auto ts_split = split_string(ts_str, ".");
-    const auto seconds = std::stoll(ts_split[0]);
+        // previous day is released here and becomes evictable if no other reader uses it
+        m_day_path = std::move(m_files.front());
+        m_files.pop_front();
+        m_block.reset();
+        m_block_trades.reset();
+        m_day = TradesDayCache::i().get(m_day_path);
+        if (m_day == nullptr) {
+            continue;
+        }
 
-    size_t milli = 0;
-    if (ts_split.size() > 1) {
-        // there can be from 0 to N digits.
-        // keeping first 3
-        const std::string milli_str = ts_split[1].substr(0, 3);
-        // the rest must be multiplied, e.g 1712967661.67 -> multiply by 10 to get 670
-        const auto multiplier = std::pow(10, 3 - milli_str.size());
-        milli = std::stoll(milli_str) * multiplier;
+        m_next_trade = 0;
+        m_end_trade = m_day->size();
+        if (m_time_range.has_value()) {
+            m_next_trade = lower_bound(m_time_range->start);
+            m_end_trade = lower_bound(m_time_range->end);
+        }
     }
 
-    const std::chrono::milliseconds ts = std::chrono::seconds{seconds} + std::chrono::milliseconds{milli};
+    const size_t block = m_next_trade / m_day->block_size();
+    if (m_block != block) {
+        m_block_trades = TradesDayCache::i().get_block(m_day_path, block);
+        if (m_block_trades == nullptr) {
+            // rest of a corrupted day is skipped
+            m_day.reset();
+            m_block.reset();
+            return open_next_day_if_needed();
+        }
+        m_block = block;
+    }
+    return true;
+}
 
-    const std::string & price_str = split_str[4];
-    const double price = std::stod(price_str);
+size_t SequentialMarketDataReader::lower_bound(std::chrono::milliseconds ts) const
+{
+    const auto block = m_day->lower_bound_block(ts);
+    if (!block.has_value()) {
+        return 0;
+    }
 
-    const std::string side_str = split_str[2];
-    const Side side = side_str == "Buy" ? Side::buy() : Side::sell();
+    const size_t block_begin = block.value() * m_day->block_size();
+    const auto trades = TradesDayCache::i().get_block(m_day_path, block.value());
+    if (trades == nullptr) {
+        return block_begin;
+    }
+    const auto trade_it = std::ranges::lower_bound(*trades, ts, {}, &PublicTrade::ts);
+    return block_begin + static_cast<size_t>(trade_it - trades->begin());
+}
 
-    const std::string & volume_str = split_str[3];
-    const double volume_double = std::stod(volume_str);
-    const SignedVolume volume = SignedVolume(UnsignedVolume::from(volume_double).value(), side); // assuming vol is positive
+std::optional<PublicTrade> SequentialMarketDataReader::get_next()
+{
+    if (!open_next_day_if_needed()) {
+        return std::nullopt;
+    }
 
-    return {{ts, price, volume}};
+    return (*m_block_trades)[m_next_trade++ % m_day->block_size()];
 }
 
-SequentialMarketDataReader::SequentialMarketDataReader(std::list<std::string> files)
+size_t SequentialMarketDataReader::get_next_batch(std::vector<PublicTrade> & out, size_t max_count)
+{
+    out.clear();
+    while (out.size() < max_count && open_next_day_if_needed()) {
+        // up to the end of the block
+        const auto & block_trades = *m_block_trades;
+        const size_t block_begin = m_block.value() * m_day->block_size();
+        const size_t end = std::min({m_end_trade, m_next_trade + (max_count - out.size()), block_begin + block_trades.size()});
+        out.insert(out.end(), block_trades.begin() + (m_next_trade - block_begin), block_trades.begin() + (end - block_begin));
+        m_next_trade = end;
+    }
+    return out.size();
+}
+
+SequentialCandleReader::SequentialCandleReader(
+        std::list<std::string> files,
+        std::optional<HistoricalMDRequestData> time_range,
+        std::chrono::milliseconds timeframe)
     : m_files(std::move(files))
+    , m_time_range(time_range)
+    , m_timeframe(timeframe)
 {
 }
 
-std::optional<PublicTrade> SequentialMarketDataReader::get_next()
+bool SequentialCandleReader::open_next_day_if_needed()
 {
-    if (!m_public_trades.empty()) {
-        auto res = m_public_trades.front();
-        m_public_trades.pop_front();
-        return res;
+    while (m_candles.empty()) {
+        if (m_files.empty()) {
+            return false;
+        }
+
+        m_day = CandleFile::map(m_files.front());
+        m_files.pop_front();
+        if (!m_day.has_value()) {
+            continue;
+        }
+
+        const auto level = m_day->level_for(m_timeframe);
+        if (!level.has_value()) {
+            LOG_ERROR("No candles to build timeframe of {}ms", m_timeframe.count());
+            continue;
+        }
+
+        m_level_timeframe = m_day->level_timeframe(level.value());
+        m_candles = m_day->candles(level.value());
+        if (m_time_range.has_value()) {
+            const auto begin = std::ranges::lower_bound(m_candles, m_time_range->start.count(), {}, &CandleRecord::ts);
+            const auto end = std::ranges::lower_bound(m_candles, m_time_range->end.count(), {}, &CandleRecord::ts);
+            m_candles = {begin, end};
+        }
     }
+    return true;
+}
 
-    if (m_files.empty()) {
-        return std::nullopt;
+size_t SequentialCandleReader::get_next_batch(std::vector<Candle> & out, size_t max_count)
+{
+    out.clear();
+    while (out.size() < max_count && open_next_day_if_needed()) {
+        const size_t count = std::min(m_candles.size(), max_count - out.size());
+        for (const auto & candle : m_candles.first(count)) {
+            out.push_back(candle.to_candle(m_level_timeframe));
+        }
+        m_candles = m_candles.subspan(count);
     }
+    return out.size();
+}
 
-    auto reader = FileReader{m_files.front()};
-    m_files.pop_front();
+BybitTradesDownloader::BybitTradesDownloader(TradesDownloaderConfig config)
+    : m_config(std::move(config))
+{
+}
+
+bool BybitTradesDownloader::convert_to_binary(const std::string & csv_path, const std::string & trades_path)
+{
+    LOG_DEBUG("Converting {} to {}", csv_path, trades_path);
 
-    for (auto line = reader.get_next(); line.has_value(); line = reader.get_next()) {
-        m_public_trades.push_back(line.value());
+    const auto columns = TradesCsvParser::parse_file(csv_path);
+    if (!columns.has_value()) {
+        LOG_ERROR("Can't parse file: {}", csv_path);
+        return false;
     }
 
-    return get_next();
+    if (columns->empty()) {
+        LOG_ERROR("No trades in file: {}", csv_path);
+        return false;
+    }
+
+    return TradesFile::write(trades_path, columns.value());
 }
 
-std::list<std::string> BybitTradesDownloader::download(const HistoricalMDRequest & req)
+bool BybitTradesDownloader::download_csv(const std::string & url, const std::string & csv_path) const
 {
-    if (!std::filesystem::is_directory(download_dir)) {
-        std::filesystem::create_directory(download_dir);
+    for (unsigned attempt = 1; attempt <= m_config.download_attempts; ++attempt) {
+        LOG_DEBUG("Downloading {}, attempt {}", url, attempt);
+        const auto checksum = GzipDownloader::download(url, csv_path);
+        if (checksum.has_value()) {
+            // recorded only after the file got its final name
+            record_checksum(csv_path, checksum.value());
+            LOG_DEBUG("Downloaded file: {}", csv_path);
+            return true;
+        }
     }
 
+    LOG_ERROR("Can't download file: {}", url);
+    return false;
+}
+
+bool BybitTradesDownloader::prepare_day(const std::string & symbol_name, const std::string & csv_file) const
+{
+    const std::string csv_path = m_config.download_dir + "/" + csv_file;
+    const std::string trades_path = trades_path_for(csv_path);
+
+    if (TradesFile::has_valid_header(trades_path)) {
+        return prepare_candles(trades_path);
+    }
+
+    if (!is_download_complete(csv_path)) {
+        const std::string url = m_config.url_base +
+                "/trading/" +
+                symbol_name +
+                "/" +
+                csv_file +
+                ".gz";
+
+        if (!download_csv(url, csv_path)) {
+            return false;
+        }
+    }
+
+    if (!convert_to_binary(csv_path, trades_path)) {
+        LOG_ERROR("Can't convert file: {}", csv_file);
+        return false;
+    }
+
+    if (!m_config.keep_csv) {
+        // raw csv is several times bigger than the trades file
+        std::error_code ec;
+        std::filesystem::remove(csv_path, ec);
+        std::filesystem::remove(checksum_path_for(csv_path), ec);
+    }
+    return prepare_candles(trades_path);
+}
+
+std::list<std::string> BybitTradesDownloader::download(const HistoricalMDRequest & req) const
+{
+    std::filesystem::create_directories(m_config.download_dir);
+
     const auto files_list = csv_file_list(req);
-    for (const auto & csv_file : files_list) {
-        if (!std::filesystem::exists(std::string(download_dir) + "/" + csv_file)) {
-
-            const std::string url = std::string(url_base) +
-                    "/trading/" +
-                    req.symbol.symbol_name +
-                    "/" +
-                    csv_file +
-                    ".gz";
-
-            LOG_DEBUG("Downloading {}", csv_file);
-            std::string curl = "curl -XGET '";
-            curl += url;
-            curl += "' -o ";
-            curl += std::string(download_dir);
-            curl += "/";
-            curl += csv_file;
-            curl += ".gz";
-            LOG_DEBUG("Rest request: {}", curl.c_str());
-            system(curl.c_str());
-            const auto gunzip = "gunzip " + std::string(download_dir) + "/" + csv_file + ".gz";
-            LOG_DEBUG("Unzipping: {}", gunzip);
-            system(gunzip.c_str());
-
-            if (!std::filesystem::exists(std::string(download_dir) + "/" + csv_file)) {
-                LOG_ERROR("Can't download file: {}", csv_file);
-                return {};
-            }
-
-            LOG_DEBUG("Downloaded file: {}", csv_file);
+    const std::vector<std::string> csv_files(files_list.begin(), files_list.end());
+
+    std::vector<char> results(csv_files.size(), false);
+    std::atomic<size_t> next_file = 0;
+    const auto worker = [&] {
+        for (size_t i = next_file++; i < csv_files.size(); i = next_file++) {
+            results[i] = prepare_day(req.symbol.symbol_name, csv_files[i]);
         }
+    };
+
+    const size_t threads_count = std::clamp<size_t>(m_config.max_parallel_downloads, 1, std::max<size_t>(csv_files.size(), 1));
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threads_count; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto & t : threads) {
+        t.join();
+    }
+
+    const auto failed_count = std::ranges::count(results, false);
+    if (failed_count > 0) {
+        // days that succeeded stay on disk, next request continues from there
+        LOG_ERROR("{} of {} files are not available", failed_count, csv_files.size());
+        return {};
     }
 
     std::list<std::string> res;
-    for (const auto & csv_file : files_list) {
-        res.push_back(std::string{download_dir} + "/" + csv_file);
+    for (const auto & csv_file : csv_files) {
+        res.push_back(trades_path_for(m_config.download_dir + "/" + csv_file));
     }
     return res;
 }
 
-std::shared_ptr<SequentialMarketDataReader> BybitTradesDownloader::request(const HistoricalMDRequest & req)
+std::shared_ptr<SequentialMarketDataReader> BybitTradesDownloader::request(const HistoricalMDRequest & req) const
 {
-    std::vector<std::pair<std::chrono::milliseconds, double>> res;
-
     const auto files = download(req);
-    const auto reader = std::make_shared<SequentialMarketDataReader>(files);
+    const auto reader = std::make_shared<SequentialMarketDataReader>(files, req.data);
 
     return reader;
 }
+
+std::shared_ptr<SequentialCandleReader> BybitTradesDownloader::request_candles(const HistoricalMDRequest & req, std::chrono::milliseconds timeframe) const
+{
+    std::list<std::string> files;
+    for (const auto & trades_file : download(req)) {
+        files.push_back(candles_path_for(trades_file));
+    }
+    return std::make_shared<SequentialCandleReader>(std::move(files), req.data, timeframe);
+}
@@ -1,44 +1,98 @@
 #pragma once
 
+#include "CandleFile.h"
 #include "Events.h"
+#include "TradesFile.h"
 
-#include <fstream>
 #include <list>
 
-class FileReader
+class SequentialMarketDataReader
 {
 public:
-    FileReader(std::string filepath);
+    // Only trades with start <= ts < end are read if there is a time range
+    SequentialMarketDataReader(
+            std::list<std::string> files,
+            std::optional<HistoricalMDRequestData> time_range = {});
 
     std::optional<PublicTrade> get_next();
 
+    // Replaces the content of 'out' with up to max_count next trades. Returns 0 when there are no trades left
+    size_t get_next_batch(std::vector<PublicTrade> & out, size_t max_count);
+
+private:
+    // Returns false if there are no trades left, otherwise the block with the next trade is taken from the cache
+    bool open_next_day_if_needed();
+
+    // TradesDay::lower_bound with the block decoded by the cache
+    size_t lower_bound(std::chrono::milliseconds ts) const;
+
 private:
-    std::ifstream ifs;
-    std::string last_line;
+    std::list<std::string> m_files;
+    std::optional<HistoricalMDRequestData> m_time_range;
+    std::string m_day_path;
+    std::shared_ptr<const TradesDay> m_day;
+    size_t m_next_trade = 0;
+    size_t m_end_trade = 0;
+
+    // decoded once for all readers of the day
+    std::optional<size_t> m_block;
+    std::shared_ptr<const std::vector<PublicTrade>> m_block_trades;
 };
 
-class SequentialMarketDataReader
+// Reads candles of the coarsest pyramid level the timeframe can be built from
+class SequentialCandleReader
 {
 public:
-    SequentialMarketDataReader(std::list<std::string> files);
+    // Only candles with start <= ts < end are read if there is a time range
+    SequentialCandleReader(
+            std::list<std::string> files,
+            std::optional<HistoricalMDRequestData> time_range,
+            std::chrono::milliseconds timeframe);
 
-    std::optional<PublicTrade> get_next();
+    // Replaces the content of 'out' with up to max_count next candles. Returns 0 when there are no candles left
+    size_t get_next_batch(std::vector<Candle> & out, size_t max_count);
+
+private:
+    // Returns false if there are no candles left
+    bool open_next_day_if_needed();
 
 private:
     std::list<std::string> m_files;
-    std::list<PublicTrade> m_public_trades;
+    std::optional<HistoricalMDRequestData> m_time_range;
+    std::chrono::milliseconds m_timeframe;
+
+    std::optional<CandleDay> m_day;
+    std::chrono::milliseconds m_level_timeframe = {};
+    std::span<const CandleRecord> m_candles; // left to read
 };
 
-class BybitTradesDownloader
+struct TradesDownloaderConfig
 {
-    static constexpr std::string_view url_base = "https://public.bybit.com";
-    static constexpr std::string_view download_dir = ".download";
+    std::string url_base = "https://public.bybit.com"; // file:// URL of a local mirror works too
+    std::string download_dir = ".download";
+    unsigned max_parallel_downloads = 4;
+    unsigned download_attempts = 3;
+    bool keep_csv = false; // lets a newer trades file version be converted without downloading again
+};
 
+class BybitTradesDownloader
+{
 public:
-    BybitTradesDownloader();
+    BybitTradesDownloader(TradesDownloaderConfig config = {});
+
+    std::shared_ptr<SequentialMarketDataReader> request(const HistoricalMDRequest & req) const;
+    // Candle pyramids are built with the trades files, so they are available for every downloaded day
+    std::shared_ptr<SequentialCandleReader> request_candles(const HistoricalMDRequest & req, std::chrono::milliseconds timeframe) const;
+
+private:
+    std::list<std::string> download(const HistoricalMDRequest & req) const;
+
+    // Makes sure there are valid trades and candles files for the day, downloading and converting if needed
+    bool prepare_day(const std::string & symbol_name, const std::string & csv_file) const;
+    bool download_csv(const std::string & url, const std::string & csv_path) const;
 
-    static std::shared_ptr<SequentialMarketDataReader> request(const HistoricalMDRequest & req);
+    static bool convert_to_binary(const std::string & csv_path, const std::string & trades_path);
 
 private:
-    static std::list<std::string> download(const HistoricalMDRequest & req);
+    TradesDownloaderConfig m_config;
 };
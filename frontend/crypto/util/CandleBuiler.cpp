@@ -1,6 +1,7 @@
 #include "CandleBuiler.h"
 
 #include "ScopeExit.h"
+#include "Tracer.h"
 
 CandleBuilder::CandleBuilder(std::chrono::milliseconds timeframe)
     : m_timeframe(timeframe)
@@ -8,6 +9,65 @@ CandleBuilder::CandleBuilder(std::chrono::milliseconds timeframe)
 }
 
 std::vector<Candle> CandleBuilder::push_trade(double price, SignedVolume volume, std::chrono::milliseconds timestamp)
+{
+    std::vector<Candle> res;
+    push_trade_impl(price, volume, timestamp, res);
+    return res;
+}
+
+void CandleBuilder::push_trades(std::span<const PublicTrade> trades, std::vector<Candle> & out)
+{
+    for (const auto & trade : trades) {
+        push_trade_impl(trade.price(), trade.volume(), trade.ts(), out);
+    }
+}
+
+size_t CandleBuilder::first_closing_index(std::span<const PublicTrade> trades) const
+{
+    auto start = m_start;
+    for (size_t i = 0; i < trades.size(); ++i) {
+        const auto current_timeframe_iter = trades[i].ts().count() / m_timeframe.count();
+        if (current_timeframe_iter != start.count() / m_timeframe.count() &&
+            start != std::chrono::milliseconds{}) {
+            return i;
+        }
+        start = std::chrono::milliseconds{current_timeframe_iter * m_timeframe.count()};
+    }
+    return trades.size();
+}
+
+void CandleBuilder::push_candle(const Candle & candle, std::vector<Candle> & out)
+{
+    push_impl(
+            candle.ts(),
+            candle.open(),
+            candle.high(),
+            candle.low(),
+            candle.close(),
+            candle.buy_taker_volume(),
+            candle.sell_taker_volume(),
+            candle.trade_count(),
+            out);
+}
+
+void CandleBuilder::push_trade_impl(double price, SignedVolume volume, std::chrono::milliseconds timestamp, std::vector<Candle> & out)
+{
+    const auto [unsigned_volume, side] = volume.as_unsigned_and_side();
+    const double buy_taker_volume = side == Side::buy() ? unsigned_volume.value() : 0.;
+    const double sell_taker_volume = side == Side::buy() ? 0. : unsigned_volume.value();
+    push_impl(timestamp, price, price, price, price, buy_taker_volume, sell_taker_volume, 1, out);
+}
+
+void CandleBuilder::push_impl(
+        std::chrono::milliseconds timestamp,
+        double open,
+        double high,
+        double low,
+        double close,
+        double buy_taker_volume,
+        double sell_taker_volume,
+        size_t trades_count,
+        std::vector<Candle> & out)
 {
     const auto current_timeframe_iter = timestamp.count() / m_timeframe.count();
     const auto saved_timeframe_iter = m_start.count() / m_timeframe.count();
@@ -19,28 +79,22 @@ std::vector<Candle> CandleBuilder::push_trade(double price, SignedVolume volume,
 
     // filling the current candle
     if (current_timeframe_iter == saved_timeframe_iter) {
-        m_high = std::max(m_high, price);
-        m_low = std::min(m_low, price);
-        m_close = price;
-
-        const auto side = volume.as_unsigned_and_side().second;
-        if (side == Side::buy()) {
-            m_buy_taker_volume += volume.as_unsigned_and_side().first.value();
-        }
-        else {
-            m_sell_taker_volume += volume.as_unsigned_and_side().first.value();
-        }
+        m_high = std::max(m_high, high);
+        m_low = std::min(m_low, low);
+        m_close = close;
+        m_buy_taker_volume += buy_taker_volume;
+        m_sell_taker_volume += sell_taker_volume;
+        m_trades_count += trades_count;
 
-        m_trades_count += 1;
-
-        return {};
+        return;
     }
 
-    std::vector<Candle> res;
-
     // it's not the very first trade since creation
     if (m_start != std::chrono::milliseconds{}) {
-        res.emplace_back(
+        if (Tracer::i().enabled()) {
+            Tracer::i().instant("candles", "candle_closed");
+        }
+        out.emplace_back(
                 m_timeframe,
                 m_start,
                 m_open,
@@ -53,7 +107,7 @@ std::vector<Candle> CandleBuilder::push_trade(double price, SignedVolume volume,
 
         // pushing empty candles with close price
         for (int i = 1; i < current_timeframe_iter - saved_timeframe_iter; ++i) {
-            res.emplace_back(
+            out.emplace_back(
                     m_timeframe,
                     (saved_timeframe_iter + i) * m_timeframe,
                     m_close,
@@ -67,22 +121,11 @@ std::vector<Candle> CandleBuilder::push_trade(double price, SignedVolume volume,
     }
 
     // initializing the new candle
-    m_open = price;
-    m_high = price;
-    m_low = price;
-    m_close = price;
-
-    const auto side = volume.as_unsigned_and_side().second;
-    if (side == Side::buy()) {
-        m_buy_taker_volume = volume.as_unsigned_and_side().first.value();
-        m_sell_taker_volume = 0;
-    }
-    else {
-        m_buy_taker_volume = 0;
-        m_sell_taker_volume = volume.as_unsigned_and_side().first.value();
-    }
-
-    m_trades_count = 1;
-
-    return res;
+    m_open = open;
+    m_high = high;
+    m_low = low;
+    m_close = close;
+    m_buy_taker_volume = buy_taker_volume;
+    m_sell_taker_volume = sell_taker_volume;
+    m_trades_count = trades_count;
 }
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "Candle.h"
+#include "Trade.h"
 #include "Volume.h"
 
+#include <span>
+#include <vector>
+
 /*
     Builds candle only on a first trade of the next candle
     so, there can be some empty candles if there were no trades in between.
@@ -18,6 +22,30 @@ public:
 
     std::vector<Candle> push_trade(double price, SignedVolume volume, std::chrono::milliseconds timestamp); // TODO use PublicTrade as arg
 
+    // Same as push_trade for every trade in order. Closed candles are appended to 'out'
+    void push_trades(std::span<const PublicTrade> trades, std::vector<Candle> & out);
+
+    // Index of the first trade that would close a candle, trades.size() if there is no such trade
+    size_t first_closing_index(std::span<const PublicTrade> trades) const;
+
+    // Same as pushing all the trades of a smaller candle. Its timeframe must be a divisor of the builder's one
+    void push_candle(const Candle & candle, std::vector<Candle> & out);
+
+    std::chrono::milliseconds timeframe() const { return m_timeframe; }
+
+private:
+    void push_trade_impl(double price, SignedVolume volume, std::chrono::milliseconds timestamp, std::vector<Candle> & out);
+    void push_impl(
+            std::chrono::milliseconds timestamp,
+            double open,
+            double high,
+            double low,
+            double close,
+            double buy_taker_volume,
+            double sell_taker_volume,
+            size_t trades_count,
+            std::vector<Candle> & out);
+
 private:
     const std::chrono::milliseconds m_timeframe = {};
 
@@ -0,0 +1,276 @@
+#include "CandleFile.h"
+
+#include "Checksum.h"
+#include "Logger.h"
+#include "TradesFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+uintmax_t expected_file_size(std::span<const CandleFile::LevelInfo> levels)
+{
+    uintmax_t res = sizeof(CandleFile::Header) + levels.size_bytes();
+    for (const auto & level : levels) {
+        res += level.count * sizeof(CandleRecord);
+    }
+    return res;
+}
+
+bool is_consistent(const CandleFile::Header & header)
+{
+    return header.magic == CandleFile::magic &&
+            header.version == CandleFile::version &&
+            header.levels_count > 0 &&
+            header.levels_count <= CandleFile::levels.size();
+}
+
+int64_t candle_start(int64_t ts, std::chrono::milliseconds timeframe)
+{
+    return (ts / timeframe.count()) * timeframe.count();
+}
+
+// Same fields as CandleBuilder fills on a trade
+void add_trade(std::vector<CandleRecord> & candles, std::chrono::milliseconds timeframe, const PublicTrade & trade)
+{
+    const auto [volume, side] = trade.volume().as_unsigned_and_side();
+    const int64_t start = candle_start(trade.ts().count(), timeframe);
+    if (candles.empty() || candles.back().ts != start) {
+        candles.push_back({.ts = start, .open = trade.price(), .high = trade.price(), .low = trade.price()});
+    }
+
+    auto & candle = candles.back();
+    candle.high = std::max(candle.high, trade.price());
+    candle.low = std::min(candle.low, trade.price());
+    candle.close = trade.price();
+    if (side == Side::buy()) {
+        candle.buy_taker_volume += volume.value();
+    }
+    else {
+        candle.sell_taker_volume += volume.value();
+    }
+    ++candle.trades_count;
+}
+
+void add_candle(std::vector<CandleRecord> & candles, std::chrono::milliseconds timeframe, const CandleRecord & candle)
+{
+    const int64_t start = candle_start(candle.ts, timeframe);
+    if (candles.empty() || candles.back().ts != start) {
+        candles.push_back({.ts = start, .open = candle.open, .high = candle.high, .low = candle.low});
+    }
+
+    auto & res = candles.back();
+    res.high = std::max(res.high, candle.high);
+    res.low = std::min(res.low, candle.low);
+    res.close = candle.close;
+    res.buy_taker_volume += candle.buy_taker_volume;
+    res.sell_taker_volume += candle.sell_taker_volume;
+    res.trades_count += candle.trades_count;
+}
+
+} // namespace
+
+Candle CandleRecord::to_candle(std::chrono::milliseconds timeframe) const
+{
+    return {timeframe,
+            std::chrono::milliseconds{ts},
+            open,
+            high,
+            low,
+            close,
+            buy_taker_volume,
+            sell_taker_volume,
+            trades_count};
+}
+
+CandleDay::CandleDay(MappedFile file, uint64_t levels_count)
+    : m_file(std::move(file))
+{
+    const auto data = m_file.data().subspan(sizeof(CandleFile::Header));
+    m_levels = {reinterpret_cast<const CandleFile::LevelInfo *>(data.data()), levels_count};
+
+    const auto * candles = reinterpret_cast<const CandleRecord *>(data.data() + m_levels.size_bytes());
+    for (const auto & level : m_levels) {
+        m_candles.emplace_back(candles, level.count);
+        candles += level.count;
+    }
+}
+
+std::optional<size_t> CandleDay::level_for(std::chrono::milliseconds timeframe) const
+{
+    for (size_t level = m_levels.size(); level > 0; --level) {
+        if (timeframe.count() % m_levels[level - 1].timeframe == 0) {
+            return level - 1;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<CandleRecord> CandleFile::build_level(std::span<const PublicTrade> trades, std::chrono::milliseconds timeframe)
+{
+    std::vector<CandleRecord> res;
+    for (const auto & trade : trades) {
+        add_trade(res, timeframe, trade);
+    }
+    return res;
+}
+
+std::vector<CandleRecord> CandleFile::build_level(std::span<const CandleRecord> candles, std::chrono::milliseconds timeframe)
+{
+    std::vector<CandleRecord> res;
+    for (const auto & candle : candles) {
+        add_candle(res, timeframe, candle);
+    }
+    return res;
+}
+
+bool CandleFile::write(const std::filesystem::path & path, const TradesDay & trades)
+{
+    std::vector<std::vector<CandleRecord>> candles(levels.size());
+    std::vector<PublicTrade> block_trades;
+    for (size_t block = 0; block < trades.blocks_count(); ++block) {
+        if (!trades.decode_block(block, block_trades)) {
+            return false;
+        }
+        for (const auto & trade : block_trades) {
+            add_trade(candles.front(), levels.front(), trade);
+        }
+    }
+    for (size_t level = 1; level < levels.size(); ++level) {
+        candles[level] = build_level(candles[level - 1], levels[level]);
+    }
+
+    return write_levels(path, levels, candles);
+}
+
+bool CandleFile::write(const std::filesystem::path & path, std::span<const CandleRecord> candles, std::chrono::milliseconds timeframe)
+{
+    std::vector<std::chrono::milliseconds> timeframes = {timeframe};
+    std::vector<std::vector<CandleRecord>> level_candles = {{candles.begin(), candles.end()}};
+    for (const auto level_timeframe : levels) {
+        if (level_timeframe > timeframe && level_timeframe % timeframe == std::chrono::milliseconds{0}) {
+            level_candles.push_back(build_level(level_candles.back(), level_timeframe));
+            timeframes.push_back(level_timeframe);
+        }
+    }
+
+    return write_levels(path, timeframes, level_candles);
+}
+
+bool CandleFile::write_levels(
+        const std::filesystem::path & path,
+        std::span<const std::chrono::milliseconds> timeframes,
+        std::span<const std::vector<CandleRecord>> candles)
+{
+    std::vector<LevelInfo> level_infos;
+    Fnv1a hash;
+    for (size_t level = 0; level < timeframes.size(); ++level) {
+        level_infos.push_back({.timeframe = timeframes[level].count(), .count = candles[level].size()});
+    }
+    hash.update(level_infos.data(), std::span{level_infos}.size_bytes());
+    for (const auto & level_candles : candles) {
+        hash.update(level_candles.data(), std::span{level_candles}.size_bytes());
+    }
+
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open()) {
+            LOG_ERROR("Can't open file for writing: {}", tmp_path.string());
+            return false;
+        }
+
+        const Header header{
+                .magic = magic,
+                .version = version,
+                .checksum = hash.value(),
+                .levels_count = level_infos.size(),
+        };
+        ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        ofs.write(reinterpret_cast<const char *>(level_infos.data()), static_cast<std::streamsize>(std::span{level_infos}.size_bytes()));
+        for (const auto & level_candles : candles) {
+            ofs.write(reinterpret_cast<const char *>(level_candles.data()), static_cast<std::streamsize>(std::span{level_candles}.size_bytes()));
+        }
+
+        if (!ofs.good()) {
+            LOG_ERROR("Failed to write file: {}", tmp_path.string());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        LOG_ERROR("Can't rename {} to {}: {}", tmp_path.string(), path.string(), ec.message());
+        return false;
+    }
+    return true;
+}
+
+bool CandleFile::has_valid_header(const std::filesystem::path & path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+        return false;
+    }
+
+    Header header;
+    ifs.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!ifs.good() || !is_consistent(header)) {
+        return false;
+    }
+
+    std::vector<LevelInfo> level_infos(header.levels_count);
+    ifs.read(reinterpret_cast<char *>(level_infos.data()), static_cast<std::streamsize>(std::span{level_infos}.size_bytes()));
+    if (!ifs.good()) {
+        return false;
+    }
+
+    std::error_code ec;
+    const auto file_size = std::filesystem::file_size(path, ec);
+    return !ec && file_size == expected_file_size(level_infos);
+}
+
+std::optional<CandleDay> CandleFile::map(const std::filesystem::path & path)
+{
+    auto file = MappedFile::open(path);
+    if (!file.has_value()) {
+        return std::nullopt;
+    }
+
+    Header header;
+    if (file->size() < sizeof(header)) {
+        LOG_ERROR("Wrong candles file header: {}", path.string());
+        return std::nullopt;
+    }
+    std::memcpy(&header, file->data().data(), sizeof(header));
+    if (!is_consistent(header) || file->size() < sizeof(header) + (header.levels_count * sizeof(LevelInfo))) {
+        LOG_ERROR("Wrong candles file header: {}", path.string());
+        return std::nullopt;
+    }
+
+    const std::span<const LevelInfo> level_infos{
+            reinterpret_cast<const LevelInfo *>(file->data().data() + sizeof(header)),
+            header.levels_count};
+    if (!std::ranges::all_of(level_infos, [](const LevelInfo & level) { return level.timeframe > 0; })) {
+        LOG_ERROR("Wrong candles file levels: {}", path.string());
+        return std::nullopt;
+    }
+    if (file->size() != expected_file_size(level_infos)) {
+        LOG_ERROR("Candles file is truncated: {}", path.string());
+        return std::nullopt;
+    }
+
+    Fnv1a hash;
+    hash.update(file->data().data() + sizeof(header), file->size() - sizeof(header));
+    if (hash.value() != header.checksum) {
+        LOG_ERROR("Candles file checksum mismatch: {}", path.string());
+        return std::nullopt;
+    }
+
+    return CandleDay{std::move(file.value()), header.levels_count};
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Candle.h"
+#include "MappedFile.h"
+#include "Trade.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+class TradesDay;
+
+// Candle with the fields of Candle, but with fixed layout to be stored in files
+struct CandleRecord
+{
+    Candle to_candle(std::chrono::milliseconds timeframe) const;
+
+    int64_t ts = 0; // start, milliseconds
+    double open = 0.;
+    double high = 0.;
+    double low = 0.;
+    double close = 0.;
+    double buy_taker_volume = 0.;
+    double sell_taker_volume = 0.;
+    uint64_t trades_count = 0;
+};
+
+class CandleDay;
+
+/*
+ * Candle pyramid of a day of trades: candles of several timeframes, each level is built from the previous one.
+ * Only candles with trades are stored.
+ * Layout (native byte order):
+ * | Header | LevelInfo levels[levels_count] | CandleRecord candles of level 0 | of level 1 | ... |
+ * Checksum is FNV-1a of the level infos and all candles.
+ */
+class CandleFile
+{
+public:
+    static constexpr uint32_t magic = 0x4c444343; // "CCDL"
+    static constexpr uint32_t version = 1;
+    static constexpr std::string_view extension = ".candles";
+
+    // every level timeframe is a multiple of the previous one
+    static constexpr std::array<std::chrono::milliseconds, 3> levels = {
+            std::chrono::seconds{1},
+            std::chrono::minutes{1},
+            std::chrono::hours{1},
+    };
+
+    struct Header
+    {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint64_t checksum = 0;
+        uint64_t levels_count = 0;
+    };
+
+    struct LevelInfo
+    {
+        int64_t timeframe = 0; // milliseconds
+        uint64_t count = 0;
+    };
+
+    // Trades must be sorted by timestamp
+    static std::vector<CandleRecord> build_level(std::span<const PublicTrade> trades, std::chrono::milliseconds timeframe);
+    // Timeframe must be a multiple of the timeframe of the candles
+    static std::vector<CandleRecord> build_level(std::span<const CandleRecord> candles, std::chrono::milliseconds timeframe);
+
+    // Writes to a temporary file first, so a partially written file never has the target name
+    static bool write(const std::filesystem::path & path, const TradesDay & trades);
+    // Candles of the timeframe are the first level, coarser levels are the ones of 'levels' that are its multiples
+    static bool write(const std::filesystem::path & path, std::span<const CandleRecord> candles, std::chrono::milliseconds timeframe);
+
+    // Maps the file and verifies the checksum, returns nullopt on any inconsistency
+    static std::optional<CandleDay> map(const std::filesystem::path & path);
+
+    // Cheap check of the header and file size, without reading the candles
+    static bool has_valid_header(const std::filesystem::path & path);
+
+private:
+    static bool write_levels(
+            const std::filesystem::path & path,
+            std::span<const std::chrono::milliseconds> timeframes,
+            std::span<const std::vector<CandleRecord>> candles);
+};
+
+// Memory mapped candle pyramid
+class CandleDay
+{
+public:
+    size_t levels_count() const { return m_levels.size(); }
+    std::chrono::milliseconds level_timeframe(size_t level) const { return std::chrono::milliseconds{m_levels[level].timeframe}; }
+    std::span<const CandleRecord> candles(size_t level) const { return m_candles[level]; }
+
+    // Coarsest level that the timeframe can be built from, nullopt if there is no such level
+    std::optional<size_t> level_for(std::chrono::milliseconds timeframe) const;
+
+private:
+    friend class CandleFile;
+    CandleDay(MappedFile file, uint64_t levels_count);
+
+    MappedFile m_file;
+    std::span<const CandleFile::LevelInfo> m_levels;
+    std::vector<std::span<const CandleRecord>> m_candles;
+};
@@ -0,0 +1,26 @@
+#include "CandlePath.h"
+
+namespace {
+
+bool low_first(const Candle & candle, CandlePathModel model)
+{
+    switch (model) {
+    case CandlePathModel::OpenHighLowClose: return false;
+    case CandlePathModel::OpenLowHighClose: return true;
+    case CandlePathModel::ByDirection: break;
+    }
+    return candle.close() >= candle.open();
+}
+
+} // namespace
+
+PublicTrade CandlePath::point(const Candle & candle, size_t index, CandlePathModel model)
+{
+    const bool low_is_first = low_first(candle, model);
+    switch (index) {
+    case 0: return {candle.ts(), candle.open(), SignedVolume{0.}};
+    case 1: return {candle.ts() + (candle.timeframe() / 3), low_is_first ? candle.low() : candle.high(), SignedVolume{0.}};
+    case 2: return {candle.ts() + (candle.timeframe() * 2 / 3), low_is_first ? candle.high() : candle.low(), SignedVolume{0.}};
+    default: return {candle.close_ts() - std::chrono::milliseconds{1}, candle.close(), SignedVolume{0.}};
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Candle.h"
+#include "Trade.h"
+
+#include <cstddef>
+
+// Order of the extremes inside of a candle when only its OHLC is known
+enum class CandlePathModel
+{
+    ByDirection, // O-L-H-C for a rising candle, O-H-L-C for a falling one
+    OpenHighLowClose,
+    OpenLowHighClose,
+};
+
+/*
+ * Synthetic price path of a candle: open, first extreme, second extreme, close.
+ * Points are spread over the candle, the close is at its last millisecond, so paths of consecutive candles don't overlap.
+ * Volume is in the candle already, so the points have none.
+ */
+class CandlePath
+{
+public:
+    static constexpr size_t points_count = 4;
+
+    static PublicTrade point(const Candle & candle, size_t index, CandlePathModel model);
+};
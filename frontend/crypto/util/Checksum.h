@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit FNV-1a, can be fed incrementally
+class Fnv1a
+{
+    static constexpr uint64_t offset_basis = 0xcbf29ce484222325ULL;
+    static constexpr uint64_t prime = 0x100000001b3ULL;
+
+public:
+    void update(const void * data, size_t size)
+    {
+        const auto * bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i) {
+            m_hash ^= bytes[i];
+            m_hash *= prime;
+        }
+    }
+
+    uint64_t value() const { return m_hash; }
+
+private:
+    uint64_t m_hash = offset_basis;
+};
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+template <class ObjectT>
+class ChunkedTimeseries;
+
+// Values of a timeseries chunk are only appended and never moved.
+// The count is published after the value is constructed, readers don't touch values past it
+template <class ObjectT>
+class TimeseriesChunk
+{
+    friend class ChunkedTimeseries<ObjectT>;
+
+public:
+    using TimeT = std::chrono::milliseconds;
+    using Item = std::pair<TimeT, ObjectT>;
+
+    explicit TimeseriesChunk(size_t capacity)
+        : m_capacity(capacity)
+        , m_items(std::allocator<Item>{}.allocate(capacity))
+    {
+    }
+
+    ~TimeseriesChunk()
+    {
+        clear();
+        std::allocator<Item>{}.deallocate(m_items, m_capacity);
+    }
+
+    TimeseriesChunk(const TimeseriesChunk &) = delete;
+    TimeseriesChunk & operator=(const TimeseriesChunk &) = delete;
+
+    const Item & at(size_t i) const { return m_items[i]; }
+    size_t size() const { return m_size.load(std::memory_order_acquire); }
+
+private:
+    // writer only
+    bool full() const { return m_size.load(std::memory_order_relaxed) == m_capacity; }
+
+    void emplace_back(TimeT timestamp, const ObjectT & object)
+    {
+        const size_t size = m_size.load(std::memory_order_relaxed);
+        std::construct_at(m_items + size, timestamp, object);
+        m_size.store(size + 1, std::memory_order_release);
+    }
+
+    // only for a chunk without readers
+    void clear()
+    {
+        std::destroy_n(m_items, m_size.load(std::memory_order_relaxed));
+        m_size.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    const size_t m_capacity;
+    Item * const m_items;
+    std::atomic<size_t> m_size = 0;
+};
+
+/*
+    Immutable view of a timeseries taken at some moment.
+    Shares chunks with the channel, so it's cheap to take and to copy.
+    Values pushed after the snapshot was taken are not visible in it.
+*/
+template <class ObjectT>
+class TimeseriesSnapshot
+{
+    friend class ChunkedTimeseries<ObjectT>;
+
+    struct Range
+    {
+        std::shared_ptr<const TimeseriesChunk<ObjectT>> chunk;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+public:
+    using Item = typename TimeseriesChunk<ObjectT>::Item;
+
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Item;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Item *;
+        using reference = const Item &;
+
+        Iterator() = default;
+        Iterator(const std::vector<Range> * ranges, size_t range, size_t pos)
+            : m_ranges(ranges)
+            , m_range(range)
+            , m_pos(pos)
+        {
+        }
+
+        reference operator*() const { return (*m_ranges)[m_range].chunk->at(m_pos); }
+        pointer operator->() const { return &**this; }
+
+        Iterator & operator++()
+        {
+            ++m_pos;
+            if (m_pos == (*m_ranges)[m_range].end) {
+                ++m_range;
+                m_pos = m_range < m_ranges->size() ? (*m_ranges)[m_range].begin : 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            auto res = *this;
+            ++*this;
+            return res;
+        }
+
+        bool operator==(const Iterator & other) const { return m_range == other.m_range && m_pos == other.m_pos; }
+
+    private:
+        const std::vector<Range> * m_ranges = nullptr;
+        size_t m_range = 0;
+        size_t m_pos = 0;
+    };
+
+    TimeseriesSnapshot() = default;
+
+    Iterator begin() const { return {&m_ranges, 0, m_ranges.empty() ? 0 : m_ranges.front().begin}; }
+    Iterator end() const { return {&m_ranges, m_ranges.size(), 0}; }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    const Item & front() const { return m_ranges.front().chunk->at(m_ranges.front().begin); }
+    const Item & back() const { return m_ranges.back().chunk->at(m_ranges.back().end - 1); }
+
+private:
+    std::vector<Range> m_ranges;
+    size_t m_size = 0;
+};
+
+/*
+    Timeseries history in fixed size chunks. Front is trimmed by whole values, chunks are released when emptied.
+    A released chunk that isn't used by any snapshot is reused for new values, so a channel with a capacity
+    works as a ring buffer without allocations.
+
+    Not thread safe, snapshots are.
+*/
+template <class ObjectT>
+class ChunkedTimeseries
+{
+    using Chunk = TimeseriesChunk<ObjectT>;
+
+public:
+    using TimeT = std::chrono::milliseconds;
+    using Item = typename Chunk::Item;
+
+    static constexpr size_t default_chunk_size = 1024;
+
+    explicit ChunkedTimeseries(size_t chunk_size = default_chunk_size)
+        : m_chunk_size(chunk_size)
+    {
+    }
+
+    void push_back(TimeT timestamp, const ObjectT & object)
+    {
+        if (m_chunks.empty() || m_chunks.back()->full()) {
+            m_chunks.push_back(make_chunk());
+        }
+        m_chunks.back()->emplace_back(timestamp, object);
+        ++m_size;
+    }
+
+    // Removes values with timestamps less than min_ts from the front
+    void trim_before(TimeT min_ts)
+    {
+        while (m_size > 0 && front().first < min_ts) {
+            ++m_front;
+            --m_size;
+            if (m_front == m_chunks.front()->size()) {
+                release_front_chunk();
+            }
+        }
+    }
+
+    TimeseriesSnapshot<ObjectT> snapshot() const
+    {
+        TimeseriesSnapshot<ObjectT> res;
+        res.m_ranges.reserve(m_chunks.size());
+        for (size_t i = 0; i < m_chunks.size(); ++i) {
+            const size_t begin = i == 0 ? m_front : 0;
+            const size_t end = m_chunks[i]->size();
+            if (begin < end) {
+                res.m_ranges.push_back({m_chunks[i], begin, end});
+            }
+        }
+        res.m_size = m_size;
+        return res;
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    const Item & front() const { return m_chunks.front()->at(m_front); }
+    const Item & back() const { return m_chunks.back()->at(m_chunks.back()->size() - 1); }
+
+private:
+    std::shared_ptr<Chunk> make_chunk()
+    {
+        if (m_spare) {
+            m_spare->clear();
+            return std::move(m_spare);
+        }
+        return std::make_shared<Chunk>(m_chunk_size);
+    }
+
+    void release_front_chunk()
+    {
+        // snapshots may still read it, then it's freed by the last of them
+        if (m_chunks.front().use_count() == 1) {
+            m_spare = std::move(m_chunks.front());
+        }
+        m_chunks.pop_front();
+        m_front = 0;
+    }
+
+private:
+    const size_t m_chunk_size;
+
+    std::deque<std::shared_ptr<Chunk>> m_chunks;
+    std::shared_ptr<Chunk> m_spare;
+
+    size_t m_front = 0; // index of the first value in the front chunk
+    size_t m_size = 0;
+};
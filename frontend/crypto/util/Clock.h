@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+class IClock
+{
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    virtual ~IClock() = default;
+    virtual TimePoint now() const = 0;
+};
+
+class SteadyClock final : public IClock
+{
+public:
+    TimePoint now() const override { return std::chrono::steady_clock::now(); }
+};
+
+// Time goes only when it's moved, for simulations and tests
+class VirtualClock final : public IClock
+{
+public:
+    VirtualClock(TimePoint start = {})
+        : m_now_ns(std::chrono::nanoseconds{start.time_since_epoch()}.count())
+    {
+    }
+
+    TimePoint now() const override { return TimePoint{std::chrono::nanoseconds{m_now_ns.load()}}; }
+
+    void advance(std::chrono::nanoseconds duration) { m_now_ns += duration.count(); }
+
+private:
+    std::atomic<std::chrono::nanoseconds::rep> m_now_ns;
+};
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "Events.h"
+#include "ILambdaAcceptor.h"
+#include "SubscriberToken.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <variant>
+#include <vector>
+
+/*
+ * How a subscription gets events of a channel.
+ * By default every event is a separate callback, so a consumer that can't keep up gets a queue as long as the burst.
+ * Conflating and batching subscriptions keep at most a couple of events queued, values wait in the subscription.
+ * Both bound what waits there: a newer value replaces the old one, the oldest batch is dropped.
+ * Delayed pushes are delivered one by one whatever the policy is
+ */
+namespace delivery {
+
+// Values that are not delivered yet are replaced by a newer one
+struct Latest
+{
+};
+
+// Values are handed over as a span. A batch is closed when it gets max_size long or max_delay after its first value.
+// With zero delay a batch is whatever came before the consumer got to it. Non-zero delay needs consumer's push_delayed.
+// A consumer that can't keep up loses the oldest closed batches beyond max_closed
+struct Batched
+{
+    size_t max_size = 1024;
+    std::chrono::milliseconds max_delay{0};
+    size_t max_closed = 16;
+};
+
+} // namespace delivery
+
+template <class T>
+class EveryEventDelivery
+{
+public:
+    EveryEventDelivery(std::function<void(const T &)> callback, const char * source)
+        : m_callback(std::make_shared<const std::function<void(const T &)>>(std::move(callback)))
+        , m_source(source)
+    {
+    }
+
+    void push(ILambdaAcceptor & consumer, SubscriberToken subscriber, Priority priority, const T & value) const
+    {
+        consumer.push(LambdaEvent{subscriber, [cb = m_callback, value] { (*cb)(value); }, priority, m_source});
+    }
+
+    void push_delayed(ILambdaAcceptor & consumer, SubscriberToken subscriber, Priority priority, const T & value, std::chrono::milliseconds delay) const
+    {
+        consumer.push_delayed(delay, LambdaEvent{subscriber, [cb = m_callback, value] { (*cb)(value); }, priority, m_source});
+    }
+
+private:
+    // shared with queued events, so an event doesn't copy the callback
+    std::shared_ptr<const std::function<void(const T &)>> m_callback;
+    const char * m_source;
+};
+
+template <class T>
+class LatestDelivery
+{
+    struct State
+    {
+        std::mutex mutex;
+        std::optional<T> value;
+        std::function<void(const T &)> callback;
+    };
+
+public:
+    LatestDelivery(std::function<void(const T &)> callback, const char * source)
+        : m_state(std::make_shared<State>())
+        , m_source(source)
+    {
+        m_state->callback = std::move(callback);
+    }
+
+    void push(ILambdaAcceptor & consumer, SubscriberToken subscriber, Priority priority, const T & value) const
+    {
+        {
+            std::lock_guard lock(m_state->mutex);
+            const bool queued = m_state->value.has_value();
+            m_state->value = value;
+            if (queued) {
+                return;
+            }
+        }
+
+        consumer.push(LambdaEvent{
+                subscriber,
+                [state = m_state] {
+                    std::optional<T> latest;
+                    {
+                        std::lock_guard lock(state->mutex);
+                        latest.swap(state->value);
+                    }
+                    state->callback(latest.value());
+                },
+                priority,
+                m_source});
+    }
+
+    void push_delayed(ILambdaAcceptor & consumer, SubscriberToken subscriber, Priority priority, const T & value, std::chrono::milliseconds delay) const
+    {
+        consumer.push_delayed(delay, LambdaEvent{subscriber, [state = m_state, value] { state->callback(value); }, priority, m_source});
+    }
+
+private:
+    std::shared_ptr<State> m_state;
+    const char * m_source;
+};
+
+template <class T>
+class BatchedDelivery
+{
+    struct State
+    {
+        // Hands over closed batches and the one being collected, in push order. Clears the flag of the flushing event
+        void flush(bool & flush_flag)
+        {
+            std::vector<std::vector<T>> batches;
+            {
+                std::lock_guard lock(mutex);
+                flush_flag = false;
+                batches.swap(closed);
+                if (!pending.empty()) {
+                    batches.push_back(std::move(pending));
+                    pending.clear();
+                }
+            }
+            for (const auto & batch : batches) {
+                callback(batch);
+            }
+        }
+
+        std::mutex mutex;
+        std::vector<std::vector<T>> closed;
+        std::vector<T> pending;
+        bool flush_queued = false;
+        bool flush_delayed = false;
+
+        delivery::Batched limits;
+        std::function<void(std::span<const T>)> callback;
+    };
+
+public:
+    BatchedDelivery(std::function<void(std::span<const T>)> callback, delivery::Batched limits, const char * source)
+        : m_state(std::make_shared<State>())
+        , m_source(source)
+    {
+        m_state->limits = limits;
+        m_state->limits.max_size = std::max<size_t>(limits.max_size, 1);
+        m_state->limits.max_closed = std::max<size_t>(limits.max_closed, 1);
+        m_state->callback = std::move(callback);
+    }
+
+    void push(ILambdaAcceptor & consumer, SubscriberToken subscriber, Priority priority, const T & value) const
+    {
+        bool queue_flush = false;
+        bool delay_flush = false;
+        {
+            std::lock_guard lock(m_state->mutex);
+            m_state->pending.push_back(value);
+            const bool full = m_state->pending.size() >= m_state->limits.max_size;
+            if (full) {
+                if (m_state->closed.size() >= m_state->limits.max_closed) {
+                    m_state->closed.erase(m_state->closed.begin());
+                }
+                m_state->closed.push_back(std::move(m_state->pending));
+                m_state->pending.clear();
+            }
+
+            if (m_state->flush_queued) {
+                return;
+            }
+            if (full || m_state->limits.max_delay.count() == 0) {
+                m_state->flush_queued = queue_flush = true;
+            }
+            else if (!m_state->flush_delayed) {
+                m_state->flush_delayed = delay_flush = true;
+            }
+        }
+
+        if (queue_flush) {
+            consumer.push(LambdaEvent{
+                    subscriber,
+                    [state = m_state] { state->flush(state->flush_queued); },
+                    priority,
+                    m_source});
+        }
+        else if (delay_flush) {
+            consumer.push_delayed(
+                    m_state->limits.max_delay,
+                    LambdaEvent{
+                            subscriber,
+                            [state = m_state] { state->flush(state->flush_delayed); },
+                            priority,
+                            m_source});
+        }
+    }
+
+    void push_delayed(ILambdaAcceptor & consumer, SubscriberToken subscriber, Priority priority, const T & value, std::chrono::milliseconds delay) const
+    {
+        consumer.push_delayed(
+                delay,
+                LambdaEvent{
+                        subscriber,
+                        [state = m_state, value] { state->callback(std::span<const T>{&value, 1}); },
+                        priority,
+                        m_source});
+    }
+
+private:
+    std::shared_ptr<State> m_state;
+    const char * m_source;
+};
+
+template <class T>
+using Delivery = std::variant<EveryEventDelivery<T>, LatestDelivery<T>, BatchedDelivery<T>>;
@@ -0,0 +1,15 @@
+#include "Demangle.h"
+
+#include <cstdlib>
+#include <cxxabi.h>
+#include <memory>
+
+std::string demangle(const char * name)
+{
+    if (name == nullptr) {
+        return "unknown";
+    }
+    int status = 0;
+    std::unique_ptr<char, decltype(&std::free)> demangled{abi::__cxa_demangle(name, nullptr, nullptr, &status), &std::free};
+    return status == 0 ? std::string{demangled.get()} : std::string{name};
+}
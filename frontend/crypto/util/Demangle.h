@@ -0,0 +1,6 @@
+#pragma once
+
+#include <string>
+
+// Readable form of a typeid name, "unknown" for null
+std::string demangle(const char * name);
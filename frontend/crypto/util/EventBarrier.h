@@ -9,7 +9,8 @@ class EventBarrier
 {
 public:
     EventBarrier(EventLoop & el, EventChannel<BarrierEvent> & ch)
-        : m_future(m_promise.get_future())
+        : m_event_loop(el)
+        , m_future(m_promise.get_future())
         , m_sub{el}
     {
         BarrierEvent ev;
@@ -27,10 +28,18 @@ public:
 
     void wait()
     {
+        // nobody else is going to execute events before the barrier
+        if (m_event_loop.mode() == EventLoopMode::CallerDriven) {
+            m_event_loop.run_until([this] {
+                return m_future.wait_for(std::chrono::seconds{0}) == std::future_status::ready;
+            });
+            return;
+        }
         m_future.wait();
     };
 
 private:
+    EventLoop & m_event_loop;
     std::promise<void> m_promise;
     std::future<void> m_future;
     EventSubcriber m_sub;
@@ -1,14 +1,15 @@
 #pragma once
 
+#include "DeliveryPolicy.h"
 #include "Events.h"
-#include "Guarded.h"
 #include "ILambdaAcceptor.h"
 #include "ISubsription.h"
-#include "Macros.h"
+#include "SubscriberList.h"
+#include "Tracer.h"
 
 #include <crossguid/guid.hpp>
-#include <list>
 #include <memory>
+#include <typeinfo>
 
 template <typename ObjectT>
 class EventChannel;
@@ -21,16 +22,16 @@ class EventSubscription final : public ISubscription
 public:
     EventSubscription(
             ILambdaAcceptor & consumer,
-            std::function<void(const EventT &)> callback,
+            Delivery<EventT> delivery,
             Priority priority,
             EventChannel<EventT> & channel,
-            xg::Guid subscription_guid,
+            SubscriberToken subscriber,
             xg::Guid guid)
         : m_consumer(consumer)
-        , m_callback(callback)
+        , m_delivery(std::move(delivery))
         , m_priority(priority)
         , m_channel(&channel)
-        , m_subscriber_guid(subscription_guid)
+        , m_subscriber(subscriber)
         , m_guid(guid)
     {
     }
@@ -46,12 +47,12 @@ public:
 
 private:
     ILambdaAcceptor & m_consumer;
-    std::function<void(const EventT &)> m_callback;
+    Delivery<EventT> m_delivery;
     Priority m_priority;
 
     // ptr because channel can be destroyed in another thread before subscription
     EventChannel<EventT> * m_channel;
-    xg::Guid m_subscriber_guid;
+    SubscriberToken m_subscriber;
     xg::Guid m_guid;
 };
 
@@ -69,53 +70,64 @@ public:
     [[nodiscard]] std::shared_ptr<EventSubscription<EventT>>
     subscribe(
             ILambdaAcceptor & consumer,
-            xg::Guid subcriber_guid,
+            SubscriberToken subscriber,
             std::function<void(const EventT &)> && update_callback,
             Priority priority = Priority::Normal);
+    // Events that wait for the consumer are replaced by newer ones
+    [[nodiscard]] std::shared_ptr<EventSubscription<EventT>>
+    subscribe_latest(
+            ILambdaAcceptor & consumer,
+            SubscriberToken subscriber,
+            std::function<void(const EventT &)> && update_callback,
+            Priority priority = Priority::Normal);
+    [[nodiscard]] std::shared_ptr<EventSubscription<EventT>>
+    subscribe_batched(
+            ILambdaAcceptor & consumer,
+            SubscriberToken subscriber,
+            std::function<void(std::span<const EventT>)> && batch_callback,
+            delivery::Batched batched,
+            Priority priority = Priority::Normal);
     void unsubscribe(xg::Guid guid);
 
 private:
-    using SubWPtr = std::weak_ptr<EventSubscription<EventT>>;
-    // Guid is here because wptr will be null on unsub on dtor
-    Guarded<std::list<std::pair<xg::Guid, SubWPtr>>> m_subscriptions;
+    std::shared_ptr<EventSubscription<EventT>> add_subscription(
+            ILambdaAcceptor & consumer,
+            SubscriberToken subscriber,
+            Delivery<EventT> && delivery,
+            Priority priority);
+
+private:
+    // Names events of the channel in event loop statistics
+    static const char * source_name() { return typeid(EventChannel).name(); }
+
+    // subscriptions unsubscribe in their destructors, so listed ones are alive
+    SubscriberList<EventSubscription<EventT> *> m_subscriptions;
 };
 
 template <typename EventT>
 void EventChannel<EventT>::push(const EventT & object)
 {
-    auto subs_lref = m_subscriptions.lock();
-
-    for (const auto & [_, wptr] : subs_lref.get()) {
-
-        // TODO nodiscard on sub
-        // it can't be nullptr, unsub always happens before
-        UNWRAP_CONTINUE(subsription, wptr.lock());
-
-        subsription.m_consumer.push(
-                LambdaEvent{
-                        subsription.m_subscriber_guid,
-                        [cb = subsription.m_callback, object] { cb(object); },
-                        subsription.m_priority});
-    }
+    TraceScope trace("channel", "publish", source_name());
+    m_subscriptions.for_each([&](const EventSubscription<EventT> * subsription) {
+        std::visit(
+                [&](const auto & delivery) {
+                    delivery.push(subsription->m_consumer, subsription->m_subscriber, subsription->m_priority, object);
+                },
+                subsription->m_delivery);
+    });
 }
 
 template <typename EventT>
 void EventChannel<EventT>::push_delayed(const EventT & object, std::chrono::milliseconds delay)
 {
-    auto subs_lref = m_subscriptions.lock();
-
-    for (const auto & [_, wptr] : subs_lref.get()) {
-
-        // it can't be nullptr, unsub always happens before
-        UNWRAP_CONTINUE(subsription, wptr.lock());
-
-        subsription.m_consumer.push_delayed(
-                delay,
-                LambdaEvent{
-                        subsription.m_subscriber_guid,
-                        [cb = subsription.m_callback, object] { cb(object); },
-                        subsription.m_priority});
-    }
+    TraceScope trace("channel", "publish_delayed", source_name());
+    m_subscriptions.for_each([&](const EventSubscription<EventT> * subsription) {
+        std::visit(
+                [&](const auto & delivery) {
+                    delivery.push_delayed(subsription->m_consumer, subsription->m_subscriber, subsription->m_priority, object, delay);
+                },
+                subsription->m_delivery);
+    });
 }
 
 // TODO callback's argument type can be different from channel's EventT. Make a static assert to weld them
@@ -123,15 +135,48 @@ template <typename EventT>
 std::shared_ptr<EventSubscription<EventT>>
 EventChannel<EventT>::subscribe(
         ILambdaAcceptor & consumer,
-        xg::Guid subcriber_guid,
+        SubscriberToken subscriber,
+        std::function<void(const EventT &)> && update_callback,
+        Priority priority)
+{
+    return add_subscription(consumer, subscriber, EveryEventDelivery<EventT>{std::move(update_callback), source_name()}, priority);
+}
+
+template <typename EventT>
+std::shared_ptr<EventSubscription<EventT>>
+EventChannel<EventT>::subscribe_latest(
+        ILambdaAcceptor & consumer,
+        SubscriberToken subscriber,
         std::function<void(const EventT &)> && update_callback,
         Priority priority)
+{
+    return add_subscription(consumer, subscriber, LatestDelivery<EventT>{std::move(update_callback), source_name()}, priority);
+}
+
+template <typename EventT>
+std::shared_ptr<EventSubscription<EventT>>
+EventChannel<EventT>::subscribe_batched(
+        ILambdaAcceptor & consumer,
+        SubscriberToken subscriber,
+        std::function<void(std::span<const EventT>)> && batch_callback,
+        delivery::Batched batched,
+        Priority priority)
+{
+    return add_subscription(consumer, subscriber, BatchedDelivery<EventT>{std::move(batch_callback), batched, source_name()}, priority);
+}
+
+template <typename EventT>
+std::shared_ptr<EventSubscription<EventT>>
+EventChannel<EventT>::add_subscription(
+        ILambdaAcceptor & consumer,
+        SubscriberToken subscriber,
+        Delivery<EventT> && delivery,
+        Priority priority)
 {
     const auto guid = xg::newGuid();
-    auto sptr = std::make_shared<EventSubscription<EventT>>(consumer, update_callback, priority, *this, subcriber_guid, guid);
+    auto sptr = std::make_shared<EventSubscription<EventT>>(consumer, std::move(delivery), priority, *this, subscriber, guid);
 
-    auto subs_lref = m_subscriptions.lock();
-    subs_lref.get().push_back(std::make_pair(guid, std::weak_ptr{sptr}));
+    m_subscriptions.add(sptr.get());
 
     return sptr;
 }
@@ -139,28 +184,15 @@ EventChannel<EventT>::subscribe(
 template <typename EventT>
 void EventChannel<EventT>::unsubscribe(xg::Guid guid)
 {
-    auto subs_lref = m_subscriptions.lock();
-    auto & callbacks = subs_lref.get();
-
-    for (auto it = callbacks.begin(); it != callbacks.end(); ++it) {
-        auto & [sub_guid, wptr] = *it;
-
-        if (sub_guid == guid) {
-            callbacks.erase(it);
-            break;
-        }
-    }
+    m_subscriptions.remove_if([guid](const EventSubscription<EventT> * subscription) {
+        return subscription->m_guid == guid;
+    });
 }
 
 template <typename EventT>
 EventChannel<EventT>::~EventChannel()
 {
-    auto subs_lref = m_subscriptions.lock();
-
-    for (auto & [_, wptr] : subs_lref.get()) {
-        if (auto sptr = wptr.lock()) {
-            sptr->m_channel = nullptr;
-        }
-    }
-    subs_lref.get().clear();
+    m_subscriptions.clear([](EventSubscription<EventT> * subscription) {
+        subscription->m_channel = nullptr;
+    });
 }
@@ -1,12 +1,19 @@
 #pragma once
 
+#include "EventLoopStats.h"
 #include "EventLoopSubscriber.h"
 #include "Events.h"
 #include "ILambdaAcceptor.h"
+#include "LockFreePriorityQueue.h"
+#include "Logger.h"
 #include "Scheduler.h"
-#include "ThreadSafePriorityQueue.h"
+#include "ThreadPool.h"
+#include "Tracer.h"
 
 #include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <thread>
 
 template <class... Ts>
@@ -15,15 +22,27 @@ struct VariantMatcher : Ts...
     using Ts::operator()...;
 };
 
+enum class EventLoopMode
+{
+    Background,   // events are executed by loop's own thread
+    Pooled,       // events are executed by threads of a pool, one at a time. No thread of its own
+    CallerDriven, // events are executed by a thread calling run_until, one at a time. Deterministic, used in backtests
+};
+
 class EventLoop;
 class BasicEventLoop : public ILambdaAcceptor
 {
     friend class EventLoop;
 
 public:
-    BasicEventLoop()
+    // Pooled loops run on the given pool, on the shared one by default
+    BasicEventLoop(EventLoopMode mode = EventLoopMode::Background, ThreadPool * pool = nullptr)
+        : m_mode(mode)
+        , m_pool(mode != EventLoopMode::Pooled ? nullptr : pool != nullptr ? pool : &ThreadPool::i())
     {
-        m_thread = std::thread([this] { run(); });
+        if (m_mode == EventLoopMode::Background) {
+            m_thread = std::thread([this] { run(); });
+        }
     }
 
     ~BasicEventLoop() override
@@ -31,58 +50,233 @@ public:
         stop();
     }
 
+    // Must not be called from the loop's own events, the loop has to outlive the running event.
+    // From there it only stops the queue and returns, the strand leaves after the event
     void stop()
     {
         m_queue.stop();
-        m_thread.join();
+        if (std::this_thread::get_id() == m_strand_thread.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+        // a scheduled strand sees the stop and leaves. The loop can be gone right after,
+        // the strand notifies through the state it shares with its task
+        for (auto state = m_strand_state->load(); state != StrandState::Idle; state = m_strand_state->load()) {
+            m_strand_state->wait(state);
+        }
+
+        // loop thread is gone, events left in the queue are dropped here
+        while (auto opt = m_queue.try_pop()) {
+            if (is_timed(opt.value())) {
+                m_stats.on_popped(opt->m_priority);
+            }
+        }
     }
 
-    void discard_subscriber_events(xg::Guid sub_guid) override
+    EventLoopMode mode() const { return m_mode; }
+
+    // Disabled by default
+    EventLoopStats & stats() { return m_stats; }
+
+    // Events run with the level instead of their thread's one, nullopt resets it
+    void set_log_level(std::optional<LogLevel> level) { m_log_level.store(level, std::memory_order_relaxed); }
+
+    // For event callbacks only. Lets a long running event yield to the ones pushed after it
+    bool has_pending_events() const { return m_queue.has_pending_events(); }
+
+    // CallerDriven mode only. Executes events until the predicate is true, waits for new events if there are none.
+    // Returns false if the loop was stopped
+    template <class Pred>
+    bool run_until(Pred && pred)
     {
-        m_queue.discard_events(
-                [sub_guid](const LambdaEvent & ev) -> bool {
-                    return ev.m_subscriber_guid == sub_guid;
-                });
+        if (m_mode != EventLoopMode::CallerDriven) {
+            throw std::runtime_error("run_until is only for caller driven event loops");
+        }
+
+        while (!pred()) {
+            auto opt = m_queue.wait_and_pop();
+            if (!opt) {
+                return false;
+            }
+            execute(opt.value());
+        }
+        return true;
     }
 
 protected:
     void push(LambdaEvent value) override
     {
-        m_queue.push(std::move(value));
+        if (m_stats.enabled()) {
+            value.m_enqueued_at = std::chrono::steady_clock::now();
+            m_stats.on_pushed(value.m_priority);
+        }
+        if (Tracer::i().enabled()) {
+            value.m_flow_id = Tracer::i().flow_start();
+        }
+        const auto priority = value.m_priority;
+        const bool timed = is_timed(value);
+        if (!m_queue.push(std::move(value))) {
+            if (timed) {
+                m_stats.on_popped(priority);
+            }
+            return;
+        }
+        if (m_pool != nullptr && m_strand_state->exchange(StrandState::Notified) == StrandState::Idle) {
+            submit_strand();
+        }
     }
 
 private:
     void run()
     {
         while (true) {
-            const auto opt = m_queue.wait_and_pop();
+            auto opt = m_queue.wait_and_pop();
             if (!opt) {
                 return;
             }
 
-            opt.value().func();
+            execute(opt.value());
+        }
+    }
+
+    // Waiters of stop() are notified by the task, the loop may be destroyed once the strand is idle.
+    // A strand that used up its turn goes behind the other tasks of the worker
+    void submit_strand(bool turn_used_up = false)
+    {
+        auto task = [this, state = m_strand_state] {
+            if (run_strand()) {
+                state->notify_all();
+            }
+        };
+        if (turn_used_up) {
+            m_pool->resubmit(std::move(task));
+        }
+        else {
+            m_pool->submit(std::move(task));
+        }
+    }
+
+    // Executes a limited number of events and goes back to the pool, so loops of the pool take turns.
+    // Producers notify the strand after pushing, only the one that finds it idle submits it.
+    // Returns true if the strand became idle, the loop is not touched after that
+    bool run_strand()
+    {
+        // events of producers that notified before are visible after the exchange
+        m_strand_state->exchange(StrandState::Running);
+        m_strand_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        for (size_t i = 0; i < strand_events_per_turn; ++i) {
+            if (m_queue.stopped()) {
+                m_strand_thread.store({}, std::memory_order_relaxed);
+                m_strand_state->store(StrandState::Idle);
+                return true;
+            }
+
+            if (auto opt = m_queue.try_pop(); opt.has_value()) {
+                execute(opt.value());
+                continue;
+            }
+
+            m_strand_thread.store({}, std::memory_order_relaxed);
+            auto expected = StrandState::Running;
+            if (m_strand_state->compare_exchange_strong(expected, StrandState::Idle)) {
+                return true;
+            }
+            // notified while running, there are new events
+            m_strand_state->exchange(StrandState::Running);
+            m_strand_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        }
+        m_strand_thread.store({}, std::memory_order_relaxed);
+        submit_strand(true);
+        return false;
+    }
+
+    static bool is_timed(const LambdaEvent & event)
+    {
+        return event.m_enqueued_at != std::chrono::steady_clock::time_point{};
+    }
+
+    // Events of destroyed subscribers are skipped. Events pushed while statistics or tracing were off are not measured
+    void execute(LambdaEvent & event)
+    {
+        const bool timed = is_timed(event);
+        if (timed) {
+            m_stats.on_popped(event.m_priority);
+        }
+        if (!event.m_subscriber.is_alive()) {
+            return;
+        }
+        std::optional<ScopedLogLevel> log_level;
+        if (const auto level = m_log_level.load(std::memory_order_relaxed); level.has_value()) {
+            log_level.emplace(level);
+        }
+
+        const bool measured = timed && m_stats.enabled();
+        const bool traced = event.m_flow_id != 0 && Tracer::i().enabled();
+        if (!measured && !traced) {
+            event.func();
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        if (traced) {
+            Tracer::i().flow_end(event.m_flow_id, start);
+        }
+        event.func();
+        const auto end = std::chrono::steady_clock::now();
+        if (measured) {
+            const std::string_view source = event.m_source != nullptr ? event.m_source : std::string_view{};
+            m_stats.on_executed(event.m_priority, {event.m_subscriber.id(), source}, start - event.m_enqueued_at, end - start);
+        }
+        if (traced) {
+            Tracer::i().complete("loop", "dispatch", start, end, event.m_source);
         }
     }
 
 private:
-    ThreadSafePriorityQueue<LambdaEvent> m_queue;
+    enum class StrandState
+    {
+        Idle,
+        Running,
+        Notified,
+    };
+
+    static constexpr size_t strand_events_per_turn = 256;
+
+    const EventLoopMode m_mode;
+    ThreadPool * const m_pool;
+    LockFreePriorityQueue<LambdaEvent> m_queue;
     std::thread m_thread;
+    // shared with submitted strand tasks, which notify it after the loop may be gone
+    const std::shared_ptr<std::atomic<StrandState>> m_strand_state = std::make_shared<std::atomic<StrandState>>(StrandState::Idle);
+    // compared only by the thread itself, to detect stop() from the loop's own events
+    std::atomic<std::thread::id> m_strand_thread;
+    EventLoopStats m_stats;
+    std::atomic<std::optional<LogLevel>> m_log_level;
 };
 
 class EventLoop final : public ILambdaAcceptor
 {
 public:
-    EventLoop()
-        : m_sub(m_ev)
+    EventLoop(EventLoopMode mode = EventLoopMode::Background, Scheduler & scheduler = Scheduler::i(), ThreadPool * pool = nullptr)
+        : m_scheduler(scheduler)
+        , m_ev(mode, pool)
+        , m_sub(m_ev)
     {
-        auto & ch = Scheduler::i().delayed_channel(m_guid);
+        auto & ch = m_scheduler.delayed_channel(m_guid);
         m_sub.subscribe(
                 ch,
-                [this](LambdaEvent ev) {
-                    m_ev.push(std::move(ev));
+                [this](const std::shared_ptr<LambdaEvent> & ev) {
+                    m_ev.push(std::move(*ev));
                 });
     }
 
+    ~EventLoop() override
+    {
+        m_scheduler.remove_channel(m_guid);
+    }
+
     void push(LambdaEvent event) override
     {
         return m_ev.push(std::move(event));
@@ -90,16 +284,26 @@ public:
 
     void push_delayed(std::chrono::milliseconds delay, LambdaEvent value) override
     {
-        Scheduler::i().delay_event(m_guid, delay, value);
+        m_scheduler.delay_event(m_guid, delay, std::move(value));
     }
 
-    void discard_subscriber_events(xg::Guid sub_guid) override
+    EventLoopMode mode() const { return m_ev.mode(); }
+
+    EventLoopStats & stats() { return m_ev.stats(); }
+
+    void set_log_level(std::optional<LogLevel> level) { m_ev.set_log_level(level); }
+
+    bool has_pending_events() const { return m_ev.has_pending_events(); }
+
+    template <class Pred>
+    bool run_until(Pred && pred)
     {
-        m_ev.discard_subscriber_events(sub_guid);
+        return m_ev.run_until(std::forward<Pred>(pred));
     }
 
 private:
-    xg::Guid m_guid;
+    xg::Guid m_guid = xg::newGuid();
+    Scheduler & m_scheduler;
 
     BasicEventLoop m_ev;
     EventSubcriber m_sub;
@@ -0,0 +1,105 @@
+#include "EventLoopStats.h"
+
+#include "Demangle.h"
+
+#include <bit>
+
+namespace {
+
+nlohmann::json histogram_to_json(const EventLoopStats::Histogram & histogram)
+{
+    nlohmann::json res;
+    res["count"] = histogram.count;
+    res["mean_ns"] = histogram.count == 0 ? 0 : histogram.total.count() / static_cast<int64_t>(histogram.count);
+    res["max_ns"] = histogram.max.count();
+    res["p50_ns"] = histogram.quantile(0.5).count();
+    res["p99_ns"] = histogram.quantile(0.99).count();
+    return res;
+}
+
+} // namespace
+
+void EventLoopStats::Histogram::add(std::chrono::nanoseconds duration)
+{
+    const auto ns = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+    ++count;
+    total += duration;
+    max = std::max(max, duration);
+    ++buckets[std::min<size_t>(std::bit_width(ns), buckets_count - 1)];
+}
+
+std::chrono::nanoseconds EventLoopStats::Histogram::quantile(double q) const
+{
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets_count; ++i) {
+        seen += buckets[i];
+        if (seen != 0 && static_cast<double>(seen) >= q * static_cast<double>(count)) {
+            return std::min(max, std::chrono::nanoseconds{(int64_t{1} << i) - 1});
+        }
+    }
+    return max;
+}
+
+void EventLoopStats::on_pushed(Priority priority)
+{
+    m_queue_depth[static_cast<size_t>(priority)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void EventLoopStats::on_popped(Priority priority)
+{
+    m_queue_depth[static_cast<size_t>(priority)].fetch_sub(1, std::memory_order_relaxed);
+}
+
+void EventLoopStats::on_executed(Priority priority, HandlerKey handler, std::chrono::nanoseconds latency, std::chrono::nanoseconds execution)
+{
+    std::lock_guard lock(m_mutex);
+    m_dispatch_latency[static_cast<size_t>(priority)].add(latency);
+    m_handlers[handler].add(execution);
+}
+
+EventLoopStats::Snapshot EventLoopStats::snapshot() const
+{
+    Snapshot res;
+    for (size_t i = 0; i < priorities_count; ++i) {
+        res.queue_depth[i] = m_queue_depth[i].load(std::memory_order_relaxed);
+    }
+    std::lock_guard lock(m_mutex);
+    res.dispatch_latency = m_dispatch_latency;
+    res.handlers = m_handlers;
+    return res;
+}
+
+nlohmann::json EventLoopStats::to_json() const
+{
+    const auto snap = snapshot();
+
+    nlohmann::json priorities = nlohmann::json::array();
+    for (size_t i = 0; i < priorities_count; ++i) {
+        auto json = histogram_to_json(snap.dispatch_latency[i]);
+        json["priority"] = i;
+        json["queue_depth"] = snap.queue_depth[i];
+        priorities.push_back(std::move(json));
+    }
+
+    nlohmann::json handlers = nlohmann::json::array();
+    for (const auto & [key, histogram] : snap.handlers) {
+        auto json = histogram_to_json(histogram);
+        json["subscriber"] = key.subscriber;
+        // views cover whole names, null for an unknown source
+        json["source"] = demangle(key.source.data());
+        handlers.push_back(std::move(json));
+    }
+
+    nlohmann::json res;
+    res["enabled"] = enabled();
+    res["priorities"] = std::move(priorities);
+    res["handlers"] = std::move(handlers);
+    return res;
+}
+
+void EventLoopStats::reset()
+{
+    std::lock_guard lock(m_mutex);
+    m_dispatch_latency = {};
+    m_handlers.clear();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Priority.h"
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Instrumentation of an event loop: queue depth and enqueue-to-dispatch latency per priority,
+ * execution time per subscriber and channel type.
+ * Off by default, then a loop only checks a flag per event. Enabled, it reads the clock three times per event.
+ * Recorded by the loop's consumer, read by anyone
+ */
+class EventLoopStats
+{
+public:
+    static constexpr size_t priorities_count = static_cast<size_t>(Priority::Barrier) + 1;
+    // Bucket i counts durations below 2^i ns
+    static constexpr size_t buckets_count = 48;
+
+    struct Histogram
+    {
+        uint64_t count = 0;
+        std::chrono::nanoseconds total{0};
+        std::chrono::nanoseconds max{0};
+        std::array<uint64_t, buckets_count> buckets = {};
+
+        void add(std::chrono::nanoseconds duration);
+        // Upper bound of the bucket with the quantile
+        std::chrono::nanoseconds quantile(double q) const;
+    };
+
+    struct HandlerKey
+    {
+        uint64_t subscriber = 0;
+        // typeid name of the channel type, compared by content. Names of a type can have several addresses across libraries
+        std::string_view source;
+
+        auto operator<=>(const HandlerKey &) const = default;
+    };
+
+    struct Snapshot
+    {
+        std::array<int64_t, priorities_count> queue_depth = {};
+        std::array<Histogram, priorities_count> dispatch_latency;
+        std::map<HandlerKey, Histogram> handlers;
+    };
+
+    void set_enabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    void on_pushed(Priority priority);
+    void on_popped(Priority priority);
+    void on_executed(Priority priority, HandlerKey handler, std::chrono::nanoseconds latency, std::chrono::nanoseconds execution);
+
+    Snapshot snapshot() const;
+    nlohmann::json to_json() const;
+    void reset();
+
+private:
+    std::atomic_bool m_enabled = false;
+    std::array<std::atomic<int64_t>, priorities_count> m_queue_depth = {};
+
+    mutable std::mutex m_mutex;
+    std::array<Histogram, priorities_count> m_dispatch_latency;
+    std::map<HandlerKey, Histogram> m_handlers;
+};
@@ -1,8 +1,9 @@
 #pragma once
 
+#include "DeliveryPolicy.h"
 #include "ILambdaAcceptor.h"
 #include "ISubsription.h"
-#include "crossguid/guid.hpp"
+#include "SubscriberToken.h"
 
 #include <list>
 #include <memory>
@@ -12,7 +13,7 @@
     Events are pushed to a specified EventLoop.
     Automatically unsubscribes from all subscriptions on destruction
     Can be destructed in an EventLoop's callback
-    Dangled events are discarded after destruction
+    Dangled events are skipped by the EventLoop after destruction, the destructor doesn't wait for the loop
 
     Uses a guarantee: EventSubcriber will be destructed before any object that used in its callbacks
     Uses a guarantee: EventLoop's lifetime is bigger than EventSubcriber's
@@ -25,7 +26,7 @@ class EventSubcriber
 {
 public:
     EventSubcriber(ILambdaAcceptor & el)
-        : m_guid{xg::newGuid()}
+        : m_token{SubscriberToken::acquire()}
         , m_event_loop{el}
     {
     }
@@ -33,9 +34,12 @@ public:
     ~EventSubcriber()
     {
         m_subscriptions.clear();
-        m_event_loop.discard_subscriber_events(m_guid);
+        m_token.release();
     }
 
+    // Identifies subscriber's handlers in event loop statistics
+    SubscriberToken token() const { return m_token; }
+
     template <class EventChannelT, class UpdateCallbackT>
     void subscribe(
             EventChannelT & channel,
@@ -44,7 +48,7 @@ public:
     {
         const auto sub = channel.subscribe(
                 m_event_loop,
-                m_guid,
+                m_token,
                 std::forward<UpdateCallbackT>(callback),
                 priority);
         m_subscriptions.push_back(sub);
@@ -58,14 +62,78 @@ public:
     {
         const auto sub = channel.subscribe(
                 m_event_loop,
-                m_guid,
+                m_token,
+                std::forward<SnapshotCallbackT>(snapshot_callback),
+                std::forward<UpdateCallbackT>(update_callback));
+        m_subscriptions.push_back(sub);
+    }
+
+    // Callback gets the latest value only if the loop lags behind
+    template <class EventChannelT, class UpdateCallbackT>
+    void subscribe(
+            EventChannelT & channel,
+            UpdateCallbackT && callback,
+            delivery::Latest,
+            Priority priority = Priority::Normal)
+    {
+        const auto sub = channel.subscribe_latest(
+                m_event_loop,
+                m_token,
+                std::forward<UpdateCallbackT>(callback),
+                priority);
+        m_subscriptions.push_back(sub);
+    }
+
+    // Callback gets a span of events
+    template <class EventChannelT, class BatchCallbackT>
+    void subscribe(
+            EventChannelT & channel,
+            BatchCallbackT && callback,
+            delivery::Batched batched,
+            Priority priority = Priority::Normal)
+    {
+        const auto sub = channel.subscribe_batched(
+                m_event_loop,
+                m_token,
+                std::forward<BatchCallbackT>(callback),
+                batched,
+                priority);
+        m_subscriptions.push_back(sub);
+    }
+
+    template <class EventTimeseriesChannelT, class SnapshotCallbackT, class UpdateCallbackT>
+    void subscribe(
+            EventTimeseriesChannelT & channel,
+            SnapshotCallbackT && snapshot_callback,
+            UpdateCallbackT && update_callback,
+            delivery::Latest)
+    {
+        const auto sub = channel.subscribe_latest(
+                m_event_loop,
+                m_token,
                 std::forward<SnapshotCallbackT>(snapshot_callback),
                 std::forward<UpdateCallbackT>(update_callback));
         m_subscriptions.push_back(sub);
     }
 
+    template <class EventTimeseriesChannelT, class SnapshotCallbackT, class BatchCallbackT>
+    void subscribe(
+            EventTimeseriesChannelT & channel,
+            SnapshotCallbackT && snapshot_callback,
+            BatchCallbackT && batch_callback,
+            delivery::Batched batched)
+    {
+        const auto sub = channel.subscribe_batched(
+                m_event_loop,
+                m_token,
+                std::forward<SnapshotCallbackT>(snapshot_callback),
+                std::forward<BatchCallbackT>(batch_callback),
+                batched);
+        m_subscriptions.push_back(sub);
+    }
+
 private:
-    xg::Guid m_guid;
+    SubscriberToken m_token;
 
     ILambdaAcceptor & m_event_loop;
 
@@ -4,11 +4,13 @@
 #include "Events.h"
 #include "Guarded.h"
 #include "ISubsription.h"
-#include "Macros.h"
+#include "SubscriberList.h"
+#include "Tracer.h"
 
 #include <crossguid/guid.hpp>
 #include <functional>
 #include <memory>
+#include <typeinfo>
 #include <vector>
 
 template <typename ObjectT>
@@ -24,12 +26,12 @@ public:
             ILambdaAcceptor & consumer,
             std::function<void(const ObjectT &)> update_callback,
             EventObjectChannel<ObjectT> & channel,
-            xg::Guid subscriber_guid,
+            SubscriberToken subscriber,
             xg::Guid guid)
         : m_consumer(consumer)
-        , m_callback(update_callback)
+        , m_callback(std::make_shared<const std::function<void(const ObjectT &)>>(std::move(update_callback)))
         , m_channel(&channel)
-        , m_subscriber_guid(subscriber_guid)
+        , m_subscriber(subscriber)
         , m_guid(guid)
     {
     }
@@ -44,10 +46,11 @@ public:
 private:
     ILambdaAcceptor & m_consumer;
 
-    std::function<void(const ObjectT &)> m_callback;
+    // shared with queued events, so an event doesn't copy the callback
+    std::shared_ptr<const std::function<void(const ObjectT &)>> m_callback;
     EventObjectChannel<ObjectT> * m_channel; // TODO make it atomic
 
-    xg::Guid m_subscriber_guid;
+    SubscriberToken m_subscriber;
     xg::Guid m_guid;
 };
 
@@ -77,24 +80,25 @@ public:
     [[nodiscard]] std::shared_ptr<EventObjectSubscription<ObjectT>>
     subscribe(
             ILambdaAcceptor & consumer,
-            xg::Guid subscriber_guid,
+            SubscriberToken subscriber,
             std::function<void(const ObjectT &)> && update_callback,
             Priority priority = Priority::Normal);
     void unsubscribe(xg::Guid guid);
 
     size_t subscribers_count()
     {
-        return m_subscriptions.lock().get().size();
+        return m_subscriptions.size();
     };
 
 private:
-    // can't copy because of mutexes
-    Guarded<ObjectT> m_data;
+    // Names events of the channel in event loop statistics
+    static const char * source_name() { return typeid(EventObjectChannel).name(); }
 
-    using SubWPtr = std::weak_ptr<EventObjectSubscription<ObjectT>>;
+    // can't copy because of mutexes. Held while updates are dispatched, so they come in order
+    Guarded<ObjectT> m_data;
 
-    // Guid is here because wptr will be null on unsub on dtor
-    Guarded<std::vector<std::pair<xg::Guid, SubWPtr>>> m_subscriptions;
+    // subscriptions unsubscribe in their destructors, so listed ones are alive
+    SubscriberList<EventObjectSubscription<ObjectT> *> m_subscriptions;
 
     std::function<void(size_t)> m_sub_count_callback;
 };
@@ -102,48 +106,47 @@ private:
 template <typename ObjectT>
 void EventObjectChannel<ObjectT>::push(const ObjectT & object)
 {
-    auto subs_lref = m_subscriptions.lock();
+    TraceScope trace("channel", "publish", source_name());
     auto data_lref = m_data.lock();
 
     data_lref.get() = object;
 
-    for (const auto & [_, wptr] : subs_lref.get()) {
-        UNWRAP_CONTINUE(subscription, wptr.lock());
-        subscription.m_consumer.push(LambdaEvent{
-                subscription.m_subscriber_guid,
-                [cb = subscription.m_callback, object] {
-                    cb(object);
+    m_subscriptions.for_each([&](const EventObjectSubscription<ObjectT> * subscription) {
+        subscription->m_consumer.push(LambdaEvent{
+                subscription->m_subscriber,
+                [cb = subscription->m_callback, object] {
+                    (*cb)(object);
                 },
-                Priority::Normal});
-    }
+                Priority::Normal,
+                source_name()});
+    });
 }
 
 template <typename ObjectT>
 void EventObjectChannel<ObjectT>::update(std::function<void(ObjectT &)> && update_callback)
 {
-    auto subs_lref = m_subscriptions.lock();
+    TraceScope trace("channel", "publish", source_name());
     auto data_lref = m_data.lock();
 
     update_callback(data_lref.get());
 
-    // TODO erase if nullptr
-    for (const auto & [_, wptr] : subs_lref.get()) {
-        UNWRAP_CONTINUE(subscription, wptr.lock());
-        subscription.m_consumer.push(LambdaEvent{
-                subscription.m_subscriber_guid,
-                [cb = subscription.m_callback,
+    m_subscriptions.for_each([&](const EventObjectSubscription<ObjectT> * subscription) {
+        subscription->m_consumer.push(LambdaEvent{
+                subscription->m_subscriber,
+                [cb = subscription->m_callback,
                  object = data_lref.get()] {
-                    cb(object);
+                    (*cb)(object);
                 },
-                Priority::Normal});
-    }
+                Priority::Normal,
+                source_name()});
+    });
 }
 
 template <typename ObjectT>
 std::shared_ptr<EventObjectSubscription<ObjectT>>
 EventObjectChannel<ObjectT>::subscribe(
         ILambdaAcceptor & consumer,
-        xg::Guid subscriber_guid,
+        SubscriberToken subscriber,
         std::function<void(const ObjectT &)> && update_callback,
         Priority) // TODO use priority?
 {
@@ -152,15 +155,13 @@ EventObjectChannel<ObjectT>::subscribe(
             consumer,
             update_callback,
             *this,
-            subscriber_guid,
+            subscriber,
             guid);
 
-    auto lref = m_subscriptions.lock();
-
-    lref.get().push_back({guid, std::weak_ptr{sptr}});
+    const size_t sub_count = m_subscriptions.add(sptr.get());
 
     if (m_sub_count_callback) {
-        m_sub_count_callback(lref.get().size());
+        m_sub_count_callback(sub_count);
     }
 
     return sptr;
@@ -169,21 +170,9 @@ EventObjectChannel<ObjectT>::subscribe(
 template <typename ObjectT>
 void EventObjectChannel<ObjectT>::unsubscribe(xg::Guid guid)
 {
-    size_t sub_count = 0;
-    {
-        auto lref = m_subscriptions.lock();
-        auto & subs = lref.get();
-
-        for (auto it = subs.begin(); it != subs.end(); ++it) {
-            auto & [sub_guid, _] = *it;
-            if (sub_guid == guid) {
-                subs.erase(it);
-                break;
-            }
-        }
-
-        sub_count = subs.size();
-    }
+    const size_t sub_count = m_subscriptions.remove_if([guid](const EventObjectSubscription<ObjectT> * subscription) {
+        return subscription->m_guid == guid;
+    });
 
     if (m_sub_count_callback) {
         m_sub_count_callback(sub_count);
@@ -193,15 +182,7 @@ void EventObjectChannel<ObjectT>::unsubscribe(xg::Guid guid)
 template <typename ObjectT>
 EventObjectChannel<ObjectT>::~EventObjectChannel()
 {
-    auto lref = m_subscriptions.lock();
-    auto & subs = lref.get();
-
-    for (const auto [guid, wptr] : subs) {
-        auto sptr = wptr.lock();
-        if (sptr) {
-            sptr->m_channel = nullptr;
-        }
-    }
-
-    subs.clear();
+    m_subscriptions.clear([](EventObjectSubscription<ObjectT> * subscription) {
+        subscription->m_channel = nullptr;
+    });
 }
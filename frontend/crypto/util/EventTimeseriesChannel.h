@@ -1,16 +1,20 @@
 #pragma once
 
+#include "ChunkedTimeseries.h"
+#include "DeliveryPolicy.h"
 #include "EventLoop.h"
 #include "Events.h"
 #include "Guarded.h"
 #include "ISubsription.h"
-#include "Macros.h"
+#include "SubscriberList.h"
+#include "Tracer.h"
 
 #include <chrono>
 #include <crossguid/guid.hpp>
 #include <functional>
-#include <list>
 #include <memory>
+#include <optional>
+#include <typeinfo>
 
 template <typename ObjectT>
 class EventTimeseriesChannel;
@@ -19,19 +23,20 @@ template <typename ObjectT>
 class EventTimeseriesSubsription final : public ISubscription
 {
     using TimeT = std::chrono::milliseconds;
+    using Item = std::pair<TimeT, ObjectT>;
     friend class EventTimeseriesChannel<ObjectT>;
 
 public:
     EventTimeseriesSubsription(
             ILambdaAcceptor & consumer,
-            std::function<void(TimeT, const ObjectT &)> callback,
+            Delivery<Item> delivery,
             EventTimeseriesChannel<ObjectT> & channel,
-            xg::Guid subscriber_guid,
+            SubscriberToken subscriber,
             xg::Guid guid)
         : m_consumer(consumer)
-        , m_callback(callback)
+        , m_delivery(std::move(delivery))
         , m_channel(&channel)
-        , m_subscriber_guid(subscriber_guid)
+        , m_subscriber(subscriber)
         , m_guid(guid)
     {
     }
@@ -45,9 +50,9 @@ public:
 
 private:
     ILambdaAcceptor & m_consumer;
-    std::function<void(TimeT, const ObjectT &)> m_callback;
+    Delivery<Item> m_delivery;
     EventTimeseriesChannel<ObjectT> * m_channel;
-    xg::Guid m_subscriber_guid;
+    SubscriberToken m_subscriber;
     xg::Guid m_guid;
 };
 
@@ -56,6 +61,8 @@ class EventTimeseriesChannel
 {
 public:
     using TimeT = std::chrono::milliseconds;
+    using Snapshot = TimeseriesSnapshot<ObjectT>;
+    using Item = std::pair<TimeT, ObjectT>;
 
     EventTimeseriesChannel() = default;
     EventTimeseriesChannel(EventTimeseriesChannel &) = delete;
@@ -64,23 +71,44 @@ public:
     void push(TimeT timestamp, const ObjectT & object);
     [[nodiscard]] std::shared_ptr<EventTimeseriesSubsription<ObjectT>> subscribe(
             ILambdaAcceptor & consumer,
-            xg::Guid subcriber_guid,
-            std::function<void(const std::list<std::pair<TimeT, ObjectT>> &)> && snapshot_callback,
+            SubscriberToken subscriber,
+            std::function<void(const Snapshot &)> && snapshot_callback,
             std::function<void(TimeT, const ObjectT &)> && increment_callback);
+    // Increments that wait for the consumer are replaced by newer ones
+    [[nodiscard]] std::shared_ptr<EventTimeseriesSubsription<ObjectT>> subscribe_latest(
+            ILambdaAcceptor & consumer,
+            SubscriberToken subscriber,
+            std::function<void(const Snapshot &)> && snapshot_callback,
+            std::function<void(TimeT, const ObjectT &)> && increment_callback);
+    [[nodiscard]] std::shared_ptr<EventTimeseriesSubsription<ObjectT>> subscribe_batched(
+            ILambdaAcceptor & consumer,
+            SubscriberToken subscriber,
+            std::function<void(const Snapshot &)> && snapshot_callback,
+            std::function<void(std::span<const Item>)> && batch_callback,
+            delivery::Batched batched);
 
     // thread unsafe
     void set_capacity(std::optional<std::chrono::milliseconds> capacity) { m_capacity = capacity; }
 
-    std::list<std::pair<TimeT, ObjectT>> data_copy() { return m_data.lock().get(); }
+    Snapshot snapshot() { return m_data.lock().get().snapshot(); }
 
     void unsubscribe(xg::Guid guid);
 
 private:
-    Guarded<std::list<std::pair<TimeT, ObjectT>>> m_data;
+    std::shared_ptr<EventTimeseriesSubsription<ObjectT>> add_subscription(
+            ILambdaAcceptor & consumer,
+            SubscriberToken subscriber,
+            std::function<void(const Snapshot &)> && snapshot_callback,
+            Delivery<Item> && delivery);
 
-    using SubWPtr = std::weak_ptr<EventTimeseriesSubsription<ObjectT>>;
-    // Guid is here because wptr will be null on unsub on dtor
-    Guarded<std::list<std::pair<xg::Guid, SubWPtr>>> m_subscriptions;
+private:
+    // Names events of the channel in event loop statistics
+    static const char * source_name() { return typeid(EventTimeseriesChannel).name(); }
+
+    Guarded<ChunkedTimeseries<ObjectT>> m_data;
+
+    // subscriptions unsubscribe in their destructors, so listed ones are alive
+    SubscriberList<EventTimeseriesSubsription<ObjectT> *> m_subscriptions;
 
     std::optional<std::chrono::milliseconds> m_capacity;
 };
@@ -88,55 +116,94 @@ private:
 template <typename ObjectT>
 void EventTimeseriesChannel<ObjectT>::push(EventTimeseriesChannel::TimeT timestamp, const ObjectT & object)
 {
+    TraceScope trace("channel", "publish", source_name());
     {
         auto data_lref = m_data.lock();
         auto & data = data_lref.get();
-        while (m_capacity.has_value() && !data.empty() && data.front().first < timestamp - *m_capacity) {
-            data.pop_front();
+        if (m_capacity.has_value()) {
+            data.trim_before(timestamp - *m_capacity);
         }
-        data.emplace_back(timestamp, object);
+        data.push_back(timestamp, object);
     }
 
-    auto subs_lref = m_subscriptions.lock();
-    for (const auto & [_, sub_wptr] : subs_lref.get()) {
-
-        // TODO nodiscard on sub
-        // it can't be nullptr, unsub always happens before
-        UNWRAP_CONTINUE(subscribtion, sub_wptr.lock());
-
-        subscribtion.m_consumer.push(LambdaEvent{
-                subscribtion.m_subscriber_guid,
-                [cb = subscribtion.m_callback,
-                 timestamp,
-                 object] { cb(timestamp, object); },
-                Priority::Normal});
-    }
+    const Item item{timestamp, object};
+    m_subscriptions.for_each([&](const EventTimeseriesSubsription<ObjectT> * subscribtion) {
+        std::visit(
+                [&](const auto & delivery) {
+                    delivery.push(subscribtion->m_consumer, subscribtion->m_subscriber, Priority::Normal, item);
+                },
+                subscribtion->m_delivery);
+    });
 }
 
 template <typename ObjectT>
 std::shared_ptr<EventTimeseriesSubsription<ObjectT>> EventTimeseriesChannel<ObjectT>::subscribe(
         ILambdaAcceptor & consumer,
-        xg::Guid subcriber_guid,
-        std::function<void(const std::list<std::pair<TimeT, ObjectT>> &)> && snapshot_callback,
+        SubscriberToken subscriber,
+        std::function<void(const Snapshot &)> && snapshot_callback,
         std::function<void(TimeT, const ObjectT &)> && increment_callback)
+{
+    return add_subscription(
+            consumer,
+            subscriber,
+            std::move(snapshot_callback),
+            EveryEventDelivery<Item>{[cb = std::move(increment_callback)](const Item & item) { cb(item.first, item.second); }, source_name()});
+}
+
+template <typename ObjectT>
+std::shared_ptr<EventTimeseriesSubsription<ObjectT>> EventTimeseriesChannel<ObjectT>::subscribe_latest(
+        ILambdaAcceptor & consumer,
+        SubscriberToken subscriber,
+        std::function<void(const Snapshot &)> && snapshot_callback,
+        std::function<void(TimeT, const ObjectT &)> && increment_callback)
+{
+    return add_subscription(
+            consumer,
+            subscriber,
+            std::move(snapshot_callback),
+            LatestDelivery<Item>{[cb = std::move(increment_callback)](const Item & item) { cb(item.first, item.second); }, source_name()});
+}
+
+template <typename ObjectT>
+std::shared_ptr<EventTimeseriesSubsription<ObjectT>> EventTimeseriesChannel<ObjectT>::subscribe_batched(
+        ILambdaAcceptor & consumer,
+        SubscriberToken subscriber,
+        std::function<void(const Snapshot &)> && snapshot_callback,
+        std::function<void(std::span<const Item>)> && batch_callback,
+        delivery::Batched batched)
+{
+    return add_subscription(
+            consumer,
+            subscriber,
+            std::move(snapshot_callback),
+            BatchedDelivery<Item>{std::move(batch_callback), batched, source_name()});
+}
+
+template <typename ObjectT>
+std::shared_ptr<EventTimeseriesSubsription<ObjectT>> EventTimeseriesChannel<ObjectT>::add_subscription(
+        ILambdaAcceptor & consumer,
+        SubscriberToken subscriber,
+        std::function<void(const Snapshot &)> && snapshot_callback,
+        Delivery<Item> && delivery)
 {
     const auto guid = xg::newGuid();
     auto sptr = std::make_shared<EventTimeseriesSubsription<ObjectT>>(
             consumer,
-            increment_callback,
+            std::move(delivery),
             *this,
-            subcriber_guid,
+            subscriber,
             guid);
 
-    auto subs_lref = m_subscriptions.lock();
-    subs_lref.get().emplace_back(std::make_pair(guid, std::weak_ptr{sptr}));
+    // not under the data lock, adding waits for publishers
+    m_subscriptions.add(sptr.get());
     auto data_lref = m_data.lock();
 
     consumer.push(LambdaEvent{
-            subcriber_guid,
+            subscriber,
             [cb = std::move(snapshot_callback),
-             d = data_lref.get()] { cb(d); },
-            Priority::Normal});
+             snapshot = data_lref.get().snapshot()] { cb(snapshot); },
+            Priority::Normal,
+            source_name()});
 
     return sptr;
 }
@@ -144,28 +211,15 @@ std::shared_ptr<EventTimeseriesSubsription<ObjectT>> EventTimeseriesChannel<Obje
 template <typename ObjectT>
 void EventTimeseriesChannel<ObjectT>::unsubscribe(xg::Guid guid)
 {
-    auto subs_lref = m_subscriptions.lock();
-    auto & consumers = subs_lref.get();
-
-    for (auto it = consumers.begin(); it != consumers.end(); ++it) {
-        auto & [sub_guid, _] = *it;
-
-        if (sub_guid == guid) {
-            consumers.erase(it);
-            break;
-        }
-    }
+    m_subscriptions.remove_if([guid](const EventTimeseriesSubsription<ObjectT> * subscription) {
+        return subscription->m_guid == guid;
+    });
 }
 
 template <typename ObjectT>
 EventTimeseriesChannel<ObjectT>::~EventTimeseriesChannel()
 {
-    auto subs_lref = m_subscriptions.lock();
-
-    for (auto & [_, sub_wptr] : subs_lref.get()) {
-        UNWRAP_CONTINUE(subscription, sub_wptr.lock());
-        subscription.m_channel = nullptr;
-    }
-
-    subs_lref.get().clear();
+    m_subscriptions.clear([](EventTimeseriesSubsription<ObjectT> * subscription) {
+        subscription->m_channel = nullptr;
+    });
 }
@@ -24,14 +24,15 @@ HistoricalMDPackEvent::HistoricalMDPackEvent(xg::Guid request_guid)
 std::ostream & operator<<(std::ostream & os, const HistoricalMDRequestData & data)
 {
     return os << "HistoricalMDRequestData{"
-              << "start: " << data.start << ", end: " << data.end << "}";
+              << "start: " << data.start << ", end: " << data.end << ", source: " << static_cast<int>(data.source) << "}";
 }
 
-std::optional<HistoricalMDPriceEvent> HistoricalMDGeneratorEvent::get_next()
+bool HistoricalMDGeneratorEvent::get_next_batch(std::vector<PublicTrade> & out)
 {
-    const auto price_opt = m_reader->get_next();
-    if (!price_opt.has_value()) {
-        return std::nullopt;
-    }
-    return HistoricalMDPriceEvent{price_opt.value()};
+    return m_reader->get_next_batch(out, batch_size) > 0;
+}
+
+bool HistoricalCandlesGeneratorEvent::get_next_batch(std::vector<Candle> & out)
+{
+    return m_reader->get_next_batch(out, batch_size) > 0;
 }
@@ -1,17 +1,22 @@
 #pragma once
 
-#include "LogLevel.h"
+#include "Candle.h"
+#include "CandlePath.h"
+#include "InplaceFunction.h"
 #include "MarketOrder.h"
 #include "Ohlc.h"
 #include "Priority.h"
 #include "Signal.h"
+#include "SubscriberToken.h"
 #include "Symbol.h"
 #include "Trade.h"
 #include "TrailingStopLoss.h"
 
+#include <chrono>
 #include <crossguid/guid.hpp>
 #include <map>
 #include <utility>
+#include <vector>
 
 struct OneWayEvent
 {
@@ -43,6 +48,8 @@ class HistoricalMDGeneratorEvent : public OneWayEvent
 {
     using PricePackPtr = std::shared_ptr<const std::vector<std::pair<std::chrono::milliseconds, double>>>;
 
+    static constexpr size_t batch_size = 4096;
+
 public:
     HistoricalMDGeneratorEvent(xg::Guid guid, std::shared_ptr<SequentialMarketDataReader> reader)
         : m_request_guid(guid)
@@ -82,7 +89,8 @@ public:
         return *this;
     }
 
-    std::optional<HistoricalMDPriceEvent> get_next();
+    // Replaces the content of 'out' with the next trades. Returns false when there are no trades left
+    bool get_next_batch(std::vector<PublicTrade> & out);
 
     auto request_guid() const { return m_request_guid; }
 
@@ -92,6 +100,36 @@ private:
     std::shared_ptr<SequentialMarketDataReader> m_reader;
 };
 
+class SequentialCandleReader;
+
+// Precomputed candles, used instead of trades when they are enough for a backtest
+class HistoricalCandlesGeneratorEvent : public OneWayEvent
+{
+    static constexpr size_t batch_size = 1024;
+
+public:
+    HistoricalCandlesGeneratorEvent(xg::Guid guid, std::shared_ptr<SequentialCandleReader> reader)
+        : m_request_guid(guid)
+        , m_reader(std::move(reader))
+    {
+    }
+
+    // Replaces the content of 'out' with the next candles. Returns false when there are no candles left
+    bool get_next_batch(std::vector<Candle> & out);
+
+    auto request_guid() const { return m_request_guid; }
+
+private:
+    xg::Guid m_request_guid;
+
+    std::shared_ptr<SequentialCandleReader> m_reader;
+};
+
+// Continues replaying of the current historical trades batch after other pending events are handled
+struct HistoricalMDBatchEvent : public OneWayEvent
+{
+};
+
 struct HistoricalMDPackEvent : public OneWayEvent
 {
     HistoricalMDPackEvent(xg::Guid request_guid);
@@ -100,10 +138,20 @@ struct HistoricalMDPackEvent : public OneWayEvent
     xg::Guid request_guid;
 };
 
+// Candle sources are much faster to replay than trades, but prices inside of a candle follow CandlePathModel
+enum class HistoricalMDSource
+{
+    Trades,
+    Candles, // precomputed from the trades
+    Klines, // 1-minute klines of the exchange, nothing is built from trades
+};
+
 struct HistoricalMDRequestData
 {
     std::chrono::milliseconds start;
     std::chrono::milliseconds end;
+    HistoricalMDSource source = HistoricalMDSource::Trades;
+    CandlePathModel path_model = CandlePathModel::ByDirection;
 };
 std::ostream & operator<<(std::ostream & os, const HistoricalMDRequestData & data);
 
@@ -114,6 +162,7 @@ struct HistoricalMDRequest : public OneWayEvent
             HistoricalMDRequestData data);
 
     HistoricalMDRequestData data;
+    std::chrono::milliseconds candle_timeframe = {}; // timeframe of candles the requester builds, for candle replay
     Symbol symbol;
     xg::Guid guid;
 };
@@ -268,36 +317,31 @@ using TimerEvent = OneWayEvent;
 using PingCheckEvent = TimerEvent;
 
 // TODO move it to a more basic file
+// Move-only. A callback pointer with a trade or a timestamped value fits inline, so no allocations per event
 struct LambdaEvent : public OneWayEvent
 {
-    LambdaEvent(xg::Guid subscriber_guid, std::function<void()> func, Priority priority)
+    static constexpr size_t inline_capacity = 64;
+    using Func = InplaceFunction<inline_capacity>;
+
+    // Source names the channel type in event loop statistics
+    LambdaEvent(SubscriberToken subscriber, Func func, Priority priority, const char * source = nullptr)
         : func(std::move(func))
         , m_priority(priority)
-        , m_subscriber_guid(subscriber_guid)
+        , m_subscriber(subscriber)
+        , m_source(source)
     {
     }
 
-    Priority priority() const { return m_priority; }
+    Priority priority() const override { return m_priority; }
 
-    std::function<void()> func;
+    Func func;
     Priority m_priority;
-    xg::Guid m_subscriber_guid;
-};
-
-struct LogEvent : public OneWayEvent
-{
-    using TimePoint = std::chrono::time_point<std::chrono::system_clock, std::chrono::duration<long, std::ratio<1, 1000000000>>>;
-
-    LogEvent(LogLevel level, std::string && log)
-        : log_str(std::move(log))
-        , ts(std::chrono::system_clock::now())
-        , level(level)
-    {
-    }
-
-    std::string log_str;
-    TimePoint ts;
-    LogLevel level;
+    SubscriberToken m_subscriber;
+    const char * m_source;
+    // Set by a loop that collects statistics
+    std::chrono::steady_clock::time_point m_enqueued_at;
+    // Set by a loop while tracing, links the enqueue to the dispatch
+    uint64_t m_flow_id = 0;
 };
 
 struct BarrierEvent : public OneWayEvent
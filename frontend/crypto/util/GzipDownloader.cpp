@@ -0,0 +1,159 @@
+#include "GzipDownloader.h"
+
+#include "Checksum.h"
+#include "Logger.h"
+
+#include <curl/curl.h>
+#include <zlib.h>
+
+#include <array>
+#include <fstream>
+#include <mutex>
+
+namespace {
+
+class InflatingWriter
+{
+public:
+    InflatingWriter(const std::filesystem::path & path)
+        : m_ofs(path, std::ios::binary | std::ios::trunc)
+    {
+        // 16 + MAX_WBITS: expect gzip header
+        m_initialized = inflateInit2(&m_stream, 16 + MAX_WBITS) == Z_OK;
+    }
+
+    ~InflatingWriter()
+    {
+        if (m_initialized) {
+            inflateEnd(&m_stream);
+        }
+    }
+
+    InflatingWriter(const InflatingWriter &) = delete;
+    InflatingWriter & operator=(const InflatingWriter &) = delete;
+
+    bool is_open() const { return m_initialized && m_ofs.is_open(); }
+
+    bool write(const char * data, size_t size)
+    {
+        m_stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        m_stream.avail_in = static_cast<uInt>(size);
+
+        while (m_stream.avail_in > 0) {
+            if (m_finished) {
+                // gzip allows several concatenated members
+                if (inflateReset(&m_stream) != Z_OK) {
+                    return false;
+                }
+                m_finished = false;
+            }
+
+            m_stream.next_out = reinterpret_cast<Bytef *>(m_buffer.data());
+            m_stream.avail_out = static_cast<uInt>(m_buffer.size());
+
+            const int ret = inflate(&m_stream, Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END) {
+                LOG_ERROR("Gzip stream error: {}", ret);
+                return false;
+            }
+
+            const size_t produced = m_buffer.size() - m_stream.avail_out;
+            m_checksum.update(m_buffer.data(), produced);
+            m_ofs.write(m_buffer.data(), static_cast<std::streamsize>(produced));
+            if (!m_ofs.good()) {
+                return false;
+            }
+
+            m_finished = ret == Z_STREAM_END;
+        }
+        return true;
+    }
+
+    bool close()
+    {
+        m_ofs.close();
+        return m_finished && !m_ofs.fail();
+    }
+
+    uint64_t checksum() const { return m_checksum.value(); }
+
+private:
+    std::ofstream m_ofs;
+    z_stream m_stream = {};
+    bool m_initialized = false;
+    bool m_finished = false;
+    Fnv1a m_checksum;
+    std::array<char, 256 * 1024> m_buffer = {};
+};
+
+size_t on_data_received(char * ptr, size_t size, size_t nmemb, void * userdata)
+{
+    auto * writer = static_cast<InflatingWriter *>(userdata);
+    const size_t bytes = size * nmemb;
+    // returning less than received aborts the transfer
+    return writer->write(ptr, bytes) ? bytes : 0;
+}
+
+} // namespace
+
+std::optional<uint64_t> GzipDownloader::download(const std::string & url, const std::filesystem::path & target)
+{
+    static std::once_flag curl_init_flag;
+    std::call_once(curl_init_flag, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+    auto tmp_path = target;
+    tmp_path += ".tmp";
+
+    bool completed = false;
+    uint64_t checksum = 0;
+    {
+        auto writer = std::make_unique<InflatingWriter>(tmp_path);
+        if (!writer->is_open()) {
+            LOG_ERROR("Can't open file for writing: {}", tmp_path.string());
+            return std::nullopt;
+        }
+
+        CURL * curl = curl_easy_init();
+        if (curl == nullptr) {
+            LOG_ERROR("Can't init curl");
+            return std::nullopt;
+        }
+
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, on_data_received);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, writer.get());
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
+        // abort stalled transfers: less than 1KB/s for a minute
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1024L);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 60L);
+
+        const CURLcode res = curl_easy_perform(curl);
+        curl_easy_cleanup(curl);
+
+        const bool stream_complete = writer->close();
+        if (res != CURLE_OK) {
+            LOG_ERROR("Failed to download {}: {}", url, curl_easy_strerror(res));
+        }
+        else if (!stream_complete) {
+            LOG_ERROR("Incomplete gzip stream: {}", url);
+        }
+        completed = res == CURLE_OK && stream_complete;
+        checksum = writer->checksum();
+    }
+
+    std::error_code ec;
+    if (!completed) {
+        std::filesystem::remove(tmp_path, ec);
+        return std::nullopt;
+    }
+
+    std::filesystem::rename(tmp_path, target, ec);
+    if (ec) {
+        LOG_ERROR("Can't rename {} to {}: {}", tmp_path.string(), target.string(), ec.message());
+        return std::nullopt;
+    }
+    return checksum;
+}
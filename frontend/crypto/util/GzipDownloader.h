@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+/*
+ * Downloads a gzipped file and decompresses it on the fly.
+ * Any URL supported by libcurl works, including file:// for a local mirror.
+ * Data is written to "<target>.tmp" and renamed to the target only after
+ * the whole gzip stream is received and decoded.
+ */
+class GzipDownloader
+{
+public:
+    // Returns FNV-1a checksum of the decompressed data on success
+    static std::optional<uint64_t> download(const std::string & url, const std::filesystem::path & target);
+};
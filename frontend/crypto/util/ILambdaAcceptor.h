@@ -14,6 +14,4 @@ public:
     {
         throw std::runtime_error("push_delayed not implemented");
     }
-
-    virtual void discard_subscriber_events(xg::Guid sub_guid) = 0;
 };
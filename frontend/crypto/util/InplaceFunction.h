@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Move-only replacement for std::function<Signature>.
+ * Callables up to Capacity bytes are stored inline, bigger ones are allocated on the heap.
+ */
+template <size_t Capacity, class Signature = void()>
+class InplaceFunction;
+
+template <size_t Capacity, class R, class... Args>
+class InplaceFunction<Capacity, R(Args...)>
+{
+    struct VTable
+    {
+        R (*invoke)(void * storage, Args... args);
+        // move-constructs into 'to' and destroys 'from'
+        void (*relocate)(void * from, void * to) noexcept;
+        void (*destroy)(void * storage) noexcept;
+    };
+
+    template <class F>
+    static constexpr bool fits_inline =
+            sizeof(F) <= Capacity &&
+            alignof(F) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible_v<F>;
+
+    template <class F>
+    static constexpr VTable inline_vtable{
+            .invoke = [](void * storage, Args... args) -> R { return (*static_cast<F *>(storage))(std::forward<Args>(args)...); },
+            .relocate =
+                    [](void * from, void * to) noexcept {
+                        ::new (to) F(std::move(*static_cast<F *>(from)));
+                        static_cast<F *>(from)->~F();
+                    },
+            .destroy = [](void * storage) noexcept { static_cast<F *>(storage)->~F(); },
+    };
+
+    // storage holds a pointer to the callable
+    template <class F>
+    static constexpr VTable heap_vtable{
+            .invoke = [](void * storage, Args... args) -> R { return (**static_cast<F **>(storage))(std::forward<Args>(args)...); },
+            .relocate = [](void * from, void * to) noexcept { ::new (to) F *(*static_cast<F **>(from)); },
+            .destroy = [](void * storage) noexcept { delete *static_cast<F **>(storage); },
+    };
+
+public:
+    template <class F>
+    static constexpr bool is_inline = fits_inline<std::decay_t<F>>;
+
+    InplaceFunction() = default;
+
+    template <class F>
+        requires(!std::is_same_v<std::decay_t<F>, InplaceFunction> && std::is_invocable_r_v<R, std::decay_t<F> &, Args...>)
+    InplaceFunction(F && func)
+    {
+        using Fn = std::decay_t<F>;
+        if constexpr (fits_inline<Fn>) {
+            ::new (static_cast<void *>(m_storage)) Fn(std::forward<F>(func));
+            m_vtable = &inline_vtable<Fn>;
+        }
+        else {
+            ::new (static_cast<void *>(m_storage)) Fn *(new Fn(std::forward<F>(func)));
+            m_vtable = &heap_vtable<Fn>;
+        }
+    }
+
+    InplaceFunction(InplaceFunction && other) noexcept
+        : m_vtable(other.m_vtable)
+    {
+        if (m_vtable != nullptr) {
+            m_vtable->relocate(other.m_storage, m_storage);
+            other.m_vtable = nullptr;
+        }
+    }
+
+    InplaceFunction & operator=(InplaceFunction && other) noexcept
+    {
+        if (this == &other) {
+            return *this;
+        }
+        reset();
+        if (other.m_vtable != nullptr) {
+            other.m_vtable->relocate(other.m_storage, m_storage);
+            m_vtable = std::exchange(other.m_vtable, nullptr);
+        }
+        return *this;
+    }
+
+    InplaceFunction(const InplaceFunction &) = delete;
+    InplaceFunction & operator=(const InplaceFunction &) = delete;
+
+    ~InplaceFunction()
+    {
+        reset();
+    }
+
+    explicit operator bool() const { return m_vtable != nullptr; }
+
+    R operator()(Args... args)
+    {
+        return m_vtable->invoke(m_storage, std::forward<Args>(args)...);
+    }
+
+private:
+    void reset()
+    {
+        if (m_vtable != nullptr) {
+            m_vtable->destroy(m_storage);
+            m_vtable = nullptr;
+        }
+    }
+
+private:
+    const VTable * m_vtable = nullptr;
+    alignas(std::max_align_t) std::byte m_storage[Capacity];
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+/*
+ * On-demand reader of a json text, for hot paths where building a json document costs too much.
+ * Views point into the text, so nothing is allocated. Escapes in strings are kept as is.
+ */
+class JsonCursor
+{
+public:
+    JsonCursor(std::string_view text)
+        : m_text(text)
+    {
+    }
+
+    // Moves past the key, returns false if there is no such key
+    bool find_key(std::string_view key)
+    {
+        for (size_t pos = m_text.find(key); pos != std::string_view::npos; pos = m_text.find(key, pos + 1)) {
+            if (pos > 0 && m_text[pos - 1] == '"' && pos + key.size() < m_text.size() && m_text[pos + key.size()] == '"') {
+                m_text.remove_prefix(pos + key.size() + 1);
+                return consume(':');
+            }
+        }
+        return false;
+    }
+
+    bool consume(char c)
+    {
+        skip_spaces();
+        if (m_text.empty() || m_text.front() != c) {
+            return false;
+        }
+        m_text.remove_prefix(1);
+        return true;
+    }
+
+    bool peek(char c)
+    {
+        skip_spaces();
+        return !m_text.empty() && m_text.front() == c;
+    }
+
+    std::optional<std::string_view> string()
+    {
+        if (!consume('"')) {
+            return std::nullopt;
+        }
+        for (size_t i = 0; i < m_text.size(); ++i) {
+            if (m_text[i] == '\\') {
+                ++i;
+            }
+            else if (m_text[i] == '"') {
+                const auto res = m_text.substr(0, i);
+                m_text.remove_prefix(i + 1);
+                return res;
+            }
+        }
+        return std::nullopt;
+    }
+
+    template <class T>
+    std::optional<T> number()
+    {
+        skip_spaces();
+        T value = {};
+        const auto [ptr, ec] = std::from_chars(m_text.data(), m_text.data() + m_text.size(), value);
+        if (ec != std::errc{}) {
+            return std::nullopt;
+        }
+        m_text.remove_prefix(static_cast<size_t>(ptr - m_text.data()));
+        return value;
+    }
+
+    // Bybit sends most of the numbers as strings
+    template <class T>
+    std::optional<T> quoted_number()
+    {
+        const auto str = string();
+        if (!str.has_value()) {
+            return std::nullopt;
+        }
+        T value = {};
+        const auto [ptr, ec] = std::from_chars(str->data(), str->data() + str->size(), value);
+        if (ec != std::errc{} || ptr != str->data() + str->size()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    // Calls on_member(key) for every member, it has to read or skip the value
+    template <class F>
+    bool object(F && on_member)
+    {
+        if (!consume('{')) {
+            return false;
+        }
+        if (consume('}')) {
+            return true;
+        }
+        do {
+            const auto key = string();
+            if (!key.has_value() || !consume(':') || !on_member(key.value())) {
+                return false;
+            }
+        } while (consume(','));
+        return consume('}');
+    }
+
+    // Calls on_item() for every item, it has to read or skip the value
+    template <class F>
+    bool array(F && on_item)
+    {
+        if (!consume('[')) {
+            return false;
+        }
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            if (!on_item()) {
+                return false;
+            }
+        } while (consume(','));
+        return consume(']');
+    }
+
+    bool skip_value()
+    {
+        skip_spaces();
+        if (m_text.empty()) {
+            return false;
+        }
+        switch (m_text.front()) {
+        case '"': return string().has_value();
+        case '{': return object([this](std::string_view) { return skip_value(); });
+        case '[': return array([this] { return skip_value(); });
+        case 't': return literal("true");
+        case 'f': return literal("false");
+        case 'n': return literal("null");
+        default: return number<double>().has_value();
+        }
+    }
+
+private:
+    bool literal(std::string_view word)
+    {
+        if (!m_text.starts_with(word)) {
+            return false;
+        }
+        m_text.remove_prefix(word.size());
+        return true;
+    }
+
+    void skip_spaces()
+    {
+        while (!m_text.empty() && (m_text.front() == ' ' || m_text.front() == '\n' || m_text.front() == '\r' || m_text.front() == '\t')) {
+            m_text.remove_prefix(1);
+        }
+    }
+
+    std::string_view m_text;
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "MpscRingBuffer.h"
+#include "Priority.h"
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+/*
+ * Multi-producer single-consumer priority queue, one lock-free ring per priority.
+ * Values of the same priority are popped in push order of every producer.
+ *
+ * A full ring never blocks a producer: the value goes to a mutex guarded overflow list,
+ * and the whole lane stays on overflow until the consumer drains it.
+ * This keeps pushes from the consumer's own thread deadlock-free.
+ *
+ * Consumer spins for a while when there's nothing to pop and then parks on an atomic.
+ * wait_and_pop, try_pop and has_pending_events are for the consumer thread only.
+ */
+template <typename T, size_t RingCapacity = 1024>
+class LockFreePriorityQueue
+{
+    static constexpr size_t priorities_count = static_cast<size_t>(Priority::Barrier) + 1;
+    static constexpr unsigned spin_iterations = 512;
+
+    class Lane
+    {
+    public:
+        void push(T & value)
+        {
+            if (!m_overflowed.load(std::memory_order_acquire) && m_ring.try_push(value)) {
+                return;
+            }
+
+            std::lock_guard lock(m_overflow_mutex);
+            m_overflow.push_back(std::move(value));
+            m_overflowed.store(true, std::memory_order_release);
+        }
+
+        std::optional<T> try_pop()
+        {
+            // spill holds values that were pushed before anything currently in the ring
+            if (!m_spill.empty()) {
+                return pop_spill();
+            }
+
+            if (auto value = m_ring.try_pop(); value.has_value()) {
+                return value;
+            }
+
+            // a value still being written to the ring can be older than the overflow, wait for it
+            if (m_overflowed.load(std::memory_order_acquire) && m_ring.empty()) {
+                std::lock_guard lock(m_overflow_mutex);
+                m_spill.swap(m_overflow);
+                m_overflowed.store(false, std::memory_order_release);
+            }
+
+            if (!m_spill.empty()) {
+                return pop_spill();
+            }
+            return std::nullopt;
+        }
+
+        bool has_pending() const
+        {
+            return !m_spill.empty() || m_ring.has_published() || m_overflowed.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::optional<T> pop_spill()
+        {
+            std::optional<T> res = std::move(m_spill.front());
+            m_spill.pop_front();
+            return res;
+        }
+
+        MpscRingBuffer<T, RingCapacity> m_ring;
+
+        std::atomic_bool m_overflowed = false;
+        std::mutex m_overflow_mutex;
+        std::deque<T> m_overflow;
+
+        std::deque<T> m_spill; // consumer only
+    };
+
+public:
+    ~LockFreePriorityQueue()
+    {
+        stop();
+    }
+
+    void stop()
+    {
+        m_keep_waiting.store(false);
+        wake_consumer();
+    }
+
+    bool stopped() const { return !m_keep_waiting.load(); }
+
+    bool push(T value)
+    {
+        if (!m_keep_waiting.load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        m_lanes[static_cast<size_t>(value.priority())].push(value);
+
+        // pairs with the fence in wait_and_pop, either the consumer sees the value or we see it parked
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_consumer_parked.load(std::memory_order_relaxed)) {
+            wake_consumer();
+        }
+        return true;
+    }
+
+    std::optional<T> try_pop()
+    {
+        while (true) {
+            // Lanes can't be checked at once, so a higher priority value can show up after its lane was checked.
+            // Everything pushed before a visible value is visible too, so higher lanes are checked again
+            // until none of them has anything. That keeps barriers behind the values pushed before them.
+            size_t lane = priorities_count;
+            for (size_t i = 0; i < lane;) {
+                if (m_lanes[i].has_pending()) {
+                    lane = i;
+                    i = 0;
+                }
+                else {
+                    ++i;
+                }
+            }
+
+            if (lane == priorities_count) {
+                return std::nullopt;
+            }
+            if (auto value = m_lanes[lane].try_pop(); value.has_value()) {
+                return value;
+            }
+            // has_pending gave a false positive for a value that is still being written
+            if (m_lanes[lane].has_pending()) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    // Returns nullopt only after stop
+    std::optional<T> wait_and_pop()
+    {
+        while (true) {
+            for (unsigned i = 0; i < spin_iterations; ++i) {
+                if (!m_keep_waiting.load(std::memory_order_relaxed)) {
+                    return std::nullopt;
+                }
+                if (auto value = try_pop(); value.has_value()) {
+                    return value;
+                }
+                cpu_relax();
+            }
+
+            const auto signal = m_signal.load();
+            m_consumer_parked.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (!m_keep_waiting.load()) {
+                m_consumer_parked.store(false, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+            if (auto value = try_pop(); value.has_value()) {
+                m_consumer_parked.store(false, std::memory_order_relaxed);
+                return value;
+            }
+
+            m_signal.wait(signal);
+            m_consumer_parked.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    bool has_pending_events() const
+    {
+        for (const auto & lane : m_lanes) {
+            if (lane.has_pending()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    void wake_consumer()
+    {
+        m_signal.fetch_add(1);
+        m_signal.notify_one();
+    }
+
+    static void cpu_relax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+private:
+    std::array<Lane, priorities_count> m_lanes;
+
+    std::atomic_bool m_keep_waiting = true;
+    std::atomic_bool m_consumer_parked = false;
+    std::atomic<uint32_t> m_signal = 0;
+};
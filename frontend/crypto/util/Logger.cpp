@@ -1,56 +1,138 @@
 #include "Logger.h"
 
-#include "Events.h"
 #include "LogLevel.h"
 
 #include <fmt/chrono.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
 
 Logger::Logger()
-    : m_sub(m_event_loop)
+    : m_writer([this] { write_loop(); })
 {
-    m_sub.subscribe(
-            m_log_channel,
-            [this](const LogEvent & e) { handle_event(e); });
 }
 
 Logger & Logger::i()
 {
-    static Logger l;
-    return l;
+    // never destroyed, threads of static objects can log after it. Records left at exit are printed by flush
+    static auto * l = [] {
+        auto * logger = new Logger{};
+        std::atexit([] { flush(); });
+        return logger;
+    }();
+    return *l;
 }
 
-void Logger::handle_event(const LogEvent & ev)
+void Logger::set_min_log_level(LogLevel ll)
 {
-    if (ev.level < m_min_log_level) {
-        return;
-    }
-    const std::string str = fmt::format("[{}][{}]: {}",
-                                        ev.ts,
-                                        to_string(ev.level),
-                                        ev.log_str)
-                                    .c_str();
-    std::cout << str << std::endl;
+    s_min_log_level.store(ll, std::memory_order_relaxed);
 }
 
-template <LogLevel level>
-void Logger::log(std::string && str)
+void Logger::set_thread_min_log_level(std::optional<LogLevel> ll)
 {
-    LogEvent ev(level, std::move(str));
-    i().m_log_channel.push(std::move(ev));
+    t_min_log_level = ll;
 }
 
-void Logger::set_min_log_level(LogLevel ll)
+std::optional<LogLevel> Logger::thread_min_log_level()
+{
+    return t_min_log_level;
+}
+
+void Logger::flush()
+{
+    auto & l = i();
+    std::unique_lock lock(l.m_writer_mutex);
+    const uint64_t request = ++l.m_flush_requests;
+    l.m_writer_cv.notify_all();
+    l.m_flushed_cv.wait(lock, [&] { return l.m_flushed >= request; });
+}
+
+void Logger::push(LogRecord && record)
+{
+    auto & thread_ring = this->thread_ring();
+    while (!thread_ring.ring.try_push(record)) {
+        // the writer is behind, waiting for it keeps the records
+        {
+            std::lock_guard lock(m_writer_mutex);
+            m_ring_full.store(true);
+        }
+        m_writer_cv.notify_all();
+        std::this_thread::yield();
+    }
+}
+
+Logger::ThreadRing & Logger::thread_ring()
 {
-    i().m_min_log_level = ll;
+    // shared with the writer, so records of a finished thread are still printed
+    thread_local std::shared_ptr<ThreadRing> t_ring;
+    if (t_ring == nullptr) {
+        t_ring = std::make_shared<ThreadRing>();
+        std::lock_guard lock(m_rings_mutex);
+        m_rings.push_back(t_ring);
+    }
+    return *t_ring;
 }
 
-LogLevel Logger::current_min_log_level()
+void Logger::write_loop()
 {
-    return i().m_min_log_level;
+    std::unique_lock lock(m_writer_mutex);
+    while (true) {
+        m_writer_cv.wait_for(lock, write_period, [this] {
+            return m_flush_requests != m_flushed || m_ring_full.load();
+        });
+        const uint64_t flush_requests = m_flush_requests;
+        m_ring_full.store(false);
+
+        lock.unlock();
+        write_pending();
+        lock.lock();
+
+        m_flushed = flush_requests;
+        m_flushed_cv.notify_all();
+    }
 }
 
-template void Logger::log<LogLevel::Debug>(std::string && str);
-template void Logger::log<LogLevel::Status>(std::string && str);
-template void Logger::log<LogLevel::Info>(std::string && str);
-template void Logger::log<LogLevel::Warning>(std::string && str);
-template void Logger::log<LogLevel::Error>(std::string && str);
+void Logger::write_pending()
+{
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    {
+        std::lock_guard lock(m_rings_mutex);
+        rings = m_rings;
+    }
+
+    for (const auto & thread_ring : rings) {
+        while (auto record = thread_ring->ring.try_pop()) {
+            m_records.push_back(std::move(record.value()));
+        }
+    }
+    // records of a thread are in order already
+    std::stable_sort(m_records.begin(), m_records.end(), [](const LogRecord & l, const LogRecord & r) {
+        return l.ts < r.ts;
+    });
+
+    for (auto & record : m_records) {
+        fmt::format_to(std::back_inserter(m_text), "[{}][{}]: ", record.ts, to_string(record.level));
+        try {
+            record.format(m_text);
+        }
+        catch (const fmt::format_error & e) {
+            m_text += fmt::format("bad log format: {}", e.what());
+        }
+        m_text += '\n';
+    }
+    m_records.clear();
+
+    if (!m_text.empty()) {
+        std::cout << m_text << std::flush;
+        m_text.clear();
+    }
+
+    // rings of finished threads are owned by the list and the local copy only
+    rings.clear();
+    std::lock_guard lock(m_rings_mutex);
+    std::erase_if(m_rings, [](const std::shared_ptr<ThreadRing> & thread_ring) {
+        return thread_ring.use_count() == 1 && thread_ring->ring.empty();
+    });
+}
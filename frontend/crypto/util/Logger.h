@@ -1,90 +1,196 @@
 #pragma once
 
-#include "EventLoop.h"
-#include "EventLoopSubscriber.h"
-#include "Events.h"
-
-#include <fmt/core.h>
-
-#define LOG_DEBUG(FMT, ...)                                                \
-    do {                                                                   \
-        if (Logger::current_min_log_level() <= LogLevel::Debug) {          \
-            Logger::logf<LogLevel::Debug>(FMT __VA_OPT__(, ) __VA_ARGS__); \
-        }                                                                  \
-    } while (false)
-
-#define LOG_STATUS(FMT, ...)                                                \
+#include "InplaceFunction.h"
+#include "LogLevel.h"
+#include "MpscRingBuffer.h"
+
+#include <fmt/format.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Statements below the level are compiled out, -DLOG_COMPILED_MIN_LEVEL=1 strips LOG_DEBUG
+#ifndef LOG_COMPILED_MIN_LEVEL
+#define LOG_COMPILED_MIN_LEVEL 0
+#endif
+
+// FMT has to be a string literal, it is checked against the arguments at compile time and read when the record is written
+#define LOG_AT(LEVEL, FMT, ...)                                             \
     do {                                                                    \
-        if (Logger::current_min_log_level() <= LogLevel::Status) {          \
-            Logger::logf<LogLevel::Status>(FMT __VA_OPT__(, ) __VA_ARGS__); \
+        if constexpr (static_cast<int>(LEVEL) >= LOG_COMPILED_MIN_LEVEL) {  \
+            if (Logger::current_min_log_level() <= (LEVEL)) {               \
+                Logger::logf<LEVEL>("" FMT __VA_OPT__(, ) __VA_ARGS__);     \
+            }                                                               \
         }                                                                   \
     } while (false)
 
-#define LOG_INFO(FMT, ...)                                                \
-    do {                                                                  \
-        if (Logger::current_min_log_level() <= LogLevel::Info) {          \
-            Logger::logf<LogLevel::Info>(FMT __VA_OPT__(, ) __VA_ARGS__); \
-        }                                                                 \
-    } while (false)
+#define LOG_DEBUG(FMT, ...) LOG_AT(LogLevel::Debug, FMT __VA_OPT__(, ) __VA_ARGS__)
+#define LOG_STATUS(FMT, ...) LOG_AT(LogLevel::Status, FMT __VA_OPT__(, ) __VA_ARGS__)
+#define LOG_INFO(FMT, ...) LOG_AT(LogLevel::Info, FMT __VA_OPT__(, ) __VA_ARGS__)
+#define LOG_WARNING(FMT, ...) LOG_AT(LogLevel::Warning, FMT __VA_OPT__(, ) __VA_ARGS__)
+#define LOG_ERROR(FMT, ...) LOG_AT(LogLevel::Error, FMT __VA_OPT__(, ) __VA_ARGS__)
 
-#define LOG_WARNING(FMT, ...)                                                \
-    do {                                                                     \
-        if (Logger::current_min_log_level() <= LogLevel::Warning) {          \
-            Logger::logf<LogLevel::Warning>(FMT __VA_OPT__(, ) __VA_ARGS__); \
-        }                                                                    \
-    } while (false)
+// Argument printed with its operator<< by the writer thread
+template <class T>
+struct StreamedLogArg
+{
+    T value;
+};
 
-#define LOG_ERROR(FMT, ...)                                                \
-    do {                                                                   \
-        if (Logger::current_min_log_level() <= LogLevel::Error) {          \
-            Logger::logf<LogLevel::Error>(FMT __VA_OPT__(, ) __VA_ARGS__); \
-        }                                                                  \
-    } while (false)
+template <class T>
+struct fmt::formatter<StreamedLogArg<T>> : fmt::formatter<std::string_view>
+{
+    template <class FormatContext>
+    auto format(const StreamedLogArg<T> & arg, FormatContext & ctx) const
+    {
+        std::ostringstream ss;
+        ss << arg.value;
+        return fmt::formatter<std::string_view>::format(ss.str(), ctx);
+    }
+};
 
+/*
+ * Logging thread only captures the arguments, a background thread formats and prints them.
+ * Numbers and other trivially copyable values (Guid, chrono types, enums) are copied as they are
+ * and printed by the writer, so their operator<< must not read through pointers.
+ * Strings are copied, long ones allocate. Other arguments (Trade, Symbol, json) own memory,
+ * they are still printed to a string on the calling thread.
+ * Every thread has a ring of its own, a thread waits for the writer only if its ring is full.
+ * Records of different threads are printed in the order of their timestamps
+ */
 class Logger
 {
+    template <class T>
+    static auto capture(T && v)
+    {
+        using ValueT = std::decay_t<T>;
+        if constexpr (std::is_arithmetic_v<ValueT>) {
+            return v;
+        }
+        else if constexpr (std::is_same_v<ValueT, std::string>) {
+            return std::string{std::forward<T>(v)};
+        }
+        else if constexpr (std::is_convertible_v<T, std::string_view>) {
+            return std::string{std::string_view{v}};
+        }
+        else if constexpr (std::is_trivially_copyable_v<ValueT>) {
+            return StreamedLogArg<ValueT>{v};
+        }
+        else {
+            std::stringstream ss;
+            ss << v;
+            return ss.str();
+        }
+    }
+
+    // Format string is checked at compile time against what is captured, the writer formats the same types
+    template <class T>
+    using CapturedT = decltype(capture(std::declval<T>()));
+
 public:
-    template <LogLevel level>
-    static void log(std::string && str);
+    using TimePoint = std::chrono::system_clock::time_point;
 
     template <LogLevel level, typename... Args>
-    static void logf(std::string_view fmt, Args &&... args)
+    static void logf(fmt::format_string<CapturedT<Args>...> fmt, Args &&... args)
     {
-        str_logf<level>(fmt, to_string(args)...);
+        i().push(LogRecord{
+                .level = level,
+                .ts = std::chrono::system_clock::now(),
+                .format = [fmt = fmt::string_view{fmt}, captured = std::make_tuple(capture(std::forward<Args>(args))...)](std::string & out) {
+                    std::apply(
+                            [&](const auto &... a) { fmt::vformat_to(std::back_inserter(out), fmt, fmt::make_format_args(a...)); },
+                            captured);
+                }});
     }
 
+    // For threads without a level of their own
     static void set_min_log_level(LogLevel ll);
-    static LogLevel current_min_log_level();
+    // Overrides the global level on the calling thread, nullopt resets it
+    static void set_thread_min_log_level(std::optional<LogLevel> ll);
+    static std::optional<LogLevel> thread_min_log_level();
+
+    static LogLevel current_min_log_level()
+    {
+        return t_min_log_level.value_or(s_min_log_level.load(std::memory_order_relaxed));
+    }
+
+    // Waits until everything logged before the call is printed
+    static void flush();
 
 private:
+    struct LogRecord
+    {
+        LogLevel level;
+        TimePoint ts;
+        InplaceFunction<128, void(std::string &)> format;
+    };
+
+    struct ThreadRing
+    {
+        MpscRingBuffer<LogRecord, 1024> ring;
+    };
+
+    static constexpr std::chrono::milliseconds write_period{10};
+
     Logger();
     static Logger & i();
 
-    template <class T>
-    static std::string to_string(const T & v)
+    void push(LogRecord && record);
+    ThreadRing & thread_ring();
+
+    void write_loop();
+    void write_pending();
+
+private:
+    static inline std::atomic<LogLevel> s_min_log_level = LogLevel::Debug;
+    static inline thread_local std::optional<LogLevel> t_min_log_level;
+
+    std::mutex m_rings_mutex;
+    std::vector<std::shared_ptr<ThreadRing>> m_rings;
+    std::atomic_bool m_ring_full = false;
+
+    // writer's buffers
+    std::vector<LogRecord> m_records;
+    std::string m_text;
+
+    std::mutex m_writer_mutex;
+    std::condition_variable m_writer_cv;
+    std::condition_variable m_flushed_cv;
+    uint64_t m_flush_requests = 0;
+    uint64_t m_flushed = 0;
+    std::thread m_writer;
+};
+
+// Level of the calling thread while the object lives
+class ScopedLogLevel
+{
+public:
+    explicit ScopedLogLevel(std::optional<LogLevel> level)
+        : m_previous(Logger::thread_min_log_level())
     {
-        std::stringstream ss;
-        ss << v;
-        return ss.str();
+        Logger::set_thread_min_log_level(level);
     }
 
-    template <LogLevel level, typename... Args>
-    static void str_logf(std::string_view fmt, Args &&... args)
+    ~ScopedLogLevel()
     {
-        static_assert(
-                (std::is_same_v<Args, std::string> && ...),
-                "Here we accept only strings");
-        log<level>(fmt::vformat(fmt, fmt::make_format_args(args...)));
+        Logger::set_thread_min_log_level(m_previous);
     }
 
-    void handle_event(const LogEvent & ev);
+    ScopedLogLevel(const ScopedLogLevel &) = delete;
+    ScopedLogLevel & operator=(const ScopedLogLevel &) = delete;
 
 private:
-    EventLoop m_event_loop;
-
-    EventChannel<LogEvent> m_log_channel;
-
-    LogLevel m_min_log_level = LogLevel::Debug;
-
-    EventSubcriber m_sub;
+    std::optional<LogLevel> m_previous;
 };
@@ -0,0 +1,79 @@
+#include "MappedFile.h"
+
+#include "Logger.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::optional<MappedFile> MappedFile::open(const std::filesystem::path & path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("Can't open file: {}, {}", path.string(), errno);
+        return std::nullopt;
+    }
+
+    struct stat st = {};
+    if (::fstat(fd, &st) != 0) {
+        LOG_ERROR("Can't stat file: {}, {}", path.string(), errno);
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    const auto size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return MappedFile{nullptr, 0};
+    }
+
+    void * addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // mapping keeps its own reference to the file
+    if (addr == MAP_FAILED) {
+        LOG_ERROR("Can't map file: {}, {}", path.string(), errno);
+        return std::nullopt;
+    }
+
+    // replay reads every column front to back
+    ::madvise(addr, size, MADV_SEQUENTIAL);
+
+    return MappedFile{static_cast<const std::byte *>(addr), size};
+}
+
+MappedFile::MappedFile(const std::byte * data, size_t size)
+    : m_data(data)
+    , m_size(size)
+{
+}
+
+MappedFile::MappedFile(MappedFile && other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+{
+}
+
+MappedFile & MappedFile::operator=(MappedFile && other) noexcept
+{
+    if (this == &other) {
+        return *this;
+    }
+    unmap();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+void MappedFile::unmap()
+{
+    if (m_data != nullptr) {
+        ::munmap(const_cast<std::byte *>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
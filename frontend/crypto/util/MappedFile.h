@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+    static std::optional<MappedFile> open(const std::filesystem::path & path);
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile && other) noexcept;
+    MappedFile & operator=(MappedFile && other) noexcept;
+    ~MappedFile();
+
+    std::span<const std::byte> data() const { return {m_data, m_size}; }
+    size_t size() const { return m_size; }
+
+private:
+    MappedFile(const std::byte * data, size_t size);
+
+    void unmap();
+
+    const std::byte * m_data = nullptr;
+    size_t m_size = 0;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+/*
+ * Bounded lock-free multi-producer single-consumer ring.
+ * Producers reserve a slot with CAS and publish it with the slot sequence,
+ * consumer owns every published slot until it releases it back.
+ * try_pop, has_published and empty must be called from the consumer thread only.
+ */
+template <class T, size_t Capacity>
+class MpscRingBuffer
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static constexpr size_t mask = Capacity - 1;
+    static constexpr size_t cache_line_size = 64;
+
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        std::optional<T> value;
+    };
+
+public:
+    MpscRingBuffer()
+        : m_slots(std::make_unique<Slot[]>(Capacity))
+    {
+        for (size_t i = 0; i < Capacity; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Moves from value only on success, returns false if the ring is full
+    bool try_push(T & value)
+    {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        Slot * slot = nullptr;
+        while (true) {
+            slot = &m_slots[pos & mask];
+            const size_t seq = slot->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value.emplace(std::move(value));
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> try_pop()
+    {
+        Slot & slot = m_slots[m_dequeue_pos & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != m_dequeue_pos + 1) {
+            return std::nullopt;
+        }
+
+        std::optional<T> res = std::move(slot.value);
+        slot.value.reset();
+        slot.sequence.store(m_dequeue_pos + Capacity, std::memory_order_release);
+        ++m_dequeue_pos;
+        return res;
+    }
+
+    // True if there is a published value at the head
+    bool has_published() const
+    {
+        const Slot & slot = m_slots[m_dequeue_pos & mask];
+        return slot.sequence.load(std::memory_order_acquire) == m_dequeue_pos + 1;
+    }
+
+    // True if no slot is published or being written by producers
+    bool empty() const
+    {
+        return m_enqueue_pos.load(std::memory_order_acquire) == m_dequeue_pos;
+    }
+
+private:
+    std::unique_ptr<Slot[]> m_slots;
+
+    alignas(cache_line_size) std::atomic<size_t> m_enqueue_pos = 0;
+    alignas(cache_line_size) size_t m_dequeue_pos = 0;
+};
@@ -1,5 +1,6 @@
 #include "OrdinaryLeastSquares.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace OLS {
@@ -67,4 +68,57 @@ std::pair<PriceRegressionFunction, double> solve_prices(
     return {reg, dev};
 }
 
+void IncrementalSolver::push(Point p)
+{
+    ++m_count;
+    const double dx = p.x - m_mean_x;
+    const double dy = p.y - m_mean_y;
+    m_mean_x += dx / static_cast<double>(m_count);
+    m_mean_y += dy / static_cast<double>(m_count);
+    m_m2_x += dx * (p.x - m_mean_x);
+    m_m2_y += dy * (p.y - m_mean_y);
+    m_c_xy += dx * (p.y - m_mean_y);
+}
+
+SimpleRegressionFunction IncrementalSolver::solve() const
+{
+    if (m_count < 2) {
+        return {};
+    }
+
+    const double k = m_c_xy / m_m2_x;
+    const double c = m_mean_y - k * m_mean_x;
+    return {.k = k, .c = c};
+}
+
+double IncrementalSolver::deviation() const
+{
+    if (m_count < 2) {
+        return 0.;
+    }
+
+    // residual sum of squares of the least squares line
+    const double rss = m_m2_y - (m_c_xy * m_c_xy / m_m2_x);
+    return sqrt(std::max(rss, 0.) / static_cast<double>(m_count));
+}
+
+void IncrementalPriceSolver::push(std::chrono::milliseconds ts, double price)
+{
+    if (empty()) {
+        m_first_ts = ts;
+    }
+    m_last_ts = ts;
+
+    constexpr unsigned milliseconds_in_day = 24 * 60 * 60 * 1000;
+    const auto days_from_begin = double(ts.count() - m_first_ts.count()) / milliseconds_in_day;
+    m_solver.push({.x = days_from_begin, .y = price});
+}
+
+std::pair<PriceRegressionFunction, double> IncrementalPriceSolver::solve() const
+{
+    const auto f = m_solver.solve();
+    const auto reg = PriceRegressionFunction{f, m_first_ts};
+    return {reg, m_solver.deviation()};
+}
+
 } // namespace OLS
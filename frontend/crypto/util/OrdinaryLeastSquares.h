@@ -53,4 +53,41 @@ std::vector<Point> from_prices(
 std::pair<PriceRegressionFunction, double> solve_prices(
         const std::vector<std::pair<std::chrono::milliseconds, double>> & prices);
 
+// Same as solve and deviation over all pushed points, but O(1) per point. Uses Welford's updates of means and co-moments
+class IncrementalSolver
+{
+public:
+    void push(Point p);
+
+    size_t size() const { return m_count; }
+    SimpleRegressionFunction solve() const;
+    double deviation() const;
+
+private:
+    size_t m_count = 0;
+    double m_mean_x = 0.;
+    double m_mean_y = 0.;
+    double m_m2_x = 0.; // sum of (x - mean_x)^2
+    double m_m2_y = 0.; // sum of (y - mean_y)^2
+    double m_c_xy = 0.; // sum of (x - mean_x) * (y - mean_y)
+};
+
+// Incremental version of solve_prices. Prices must be pushed in ascending order
+class IncrementalPriceSolver
+{
+public:
+    void push(std::chrono::milliseconds ts, double price);
+
+    bool empty() const { return m_solver.size() == 0; }
+    std::pair<PriceRegressionFunction, double> solve() const;
+
+    std::chrono::milliseconds first_ts() const { return m_first_ts; }
+    std::chrono::milliseconds last_ts() const { return m_last_ts; }
+
+private:
+    IncrementalSolver m_solver;
+    std::chrono::milliseconds m_first_ts = {};
+    std::chrono::milliseconds m_last_ts = {};
+};
+
 } // namespace OLS
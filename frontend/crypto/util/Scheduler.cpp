@@ -0,0 +1,130 @@
+#include "Scheduler.h"
+
+#include <stdexcept>
+
+Scheduler::Scheduler(std::shared_ptr<IClock> clock)
+    : m_clock(std::move(clock))
+    , m_epoch(m_clock->now())
+{
+    m_thread = std::thread([this] { run(); });
+}
+
+Scheduler::Scheduler(std::shared_ptr<VirtualClock> clock)
+    : m_clock(clock)
+    , m_virtual_clock(std::move(clock))
+    , m_epoch(m_clock->now())
+{
+}
+
+Scheduler::~Scheduler()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_running = false;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void Scheduler::delay_event(xg::Guid el_guid, std::chrono::milliseconds delay, LambdaEvent event)
+{
+    const int64_t tick = next_tick_after(m_clock->now() + delay);
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_delayed_events.insert(tick, DelayedEvent{.target_el_id = el_guid, .ev = std::move(event)});
+        m_timers_changed = true;
+    }
+    m_cv.notify_all();
+}
+
+EventChannel<std::shared_ptr<LambdaEvent>> & Scheduler::delayed_channel(xg::Guid guid)
+{
+    std::lock_guard lock(m_mutex);
+    return m_channels[guid];
+}
+
+void Scheduler::remove_channel(xg::Guid guid)
+{
+    std::lock_guard lock(m_mutex);
+    m_channels.erase(guid);
+}
+
+void Scheduler::advance(std::chrono::milliseconds duration)
+{
+    ensure_virtual("advance");
+
+    std::lock_guard lock(m_mutex);
+    m_virtual_clock->advance(duration);
+    fire_due_events();
+}
+
+bool Scheduler::advance_to_next_event()
+{
+    ensure_virtual("advance_to_next_event");
+
+    std::lock_guard lock(m_mutex);
+    const size_t events_before = m_delayed_events.size();
+    // next tick of the wheel can be a tick of moving timers between levels, nothing is fired there
+    while (m_delayed_events.size() == events_before) {
+        const auto next_tick = m_delayed_events.next_tick();
+        if (!next_tick.has_value()) {
+            return false;
+        }
+        const auto next_time = m_epoch + std::chrono::milliseconds{next_tick.value()};
+        m_virtual_clock->advance(std::max(next_time - m_clock->now(), std::chrono::nanoseconds{0}));
+        fire_due_events();
+    }
+    return true;
+}
+
+void Scheduler::run()
+{
+    std::unique_lock lock(m_mutex);
+    while (m_running) {
+        fire_due_events();
+
+        m_timers_changed = false;
+        const auto pred = [this] { return !m_running || m_timers_changed; };
+        const auto next_tick = m_delayed_events.next_tick();
+        if (!next_tick.has_value()) {
+            m_cv.wait(lock, pred);
+        }
+        else {
+            const auto next_time = m_epoch + std::chrono::milliseconds{next_tick.value()};
+            m_cv.wait_for(lock, next_time - m_clock->now(), pred);
+        }
+    }
+}
+
+void Scheduler::fire_due_events()
+{
+    m_delayed_events.advance(tick_at(m_clock->now()), [this](DelayedEvent && delayed) {
+        // the loop is gone
+        const auto ch_it = m_channels.find(delayed.target_el_id);
+        if (ch_it == m_channels.end()) {
+            return;
+        }
+        ch_it->second.push(std::make_shared<LambdaEvent>(std::move(delayed.ev)));
+    });
+}
+
+int64_t Scheduler::tick_at(IClock::TimePoint time_point) const
+{
+    return std::chrono::floor<std::chrono::milliseconds>(time_point - m_epoch).count();
+}
+
+// not earlier than the time point
+int64_t Scheduler::next_tick_after(IClock::TimePoint time_point) const
+{
+    return std::chrono::ceil<std::chrono::milliseconds>(time_point - m_epoch).count();
+}
+
+void Scheduler::ensure_virtual(const char * method) const
+{
+    if (m_virtual_clock == nullptr) {
+        throw std::runtime_error(std::string(method) + " is only for schedulers with a virtual clock");
+    }
+}
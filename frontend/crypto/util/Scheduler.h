@@ -1,23 +1,25 @@
 #pragma once
 
-#include "Events.h"
+#include "Clock.h"
 #include "EventChannel.h"
+#include "Events.h"
+#include "TimingWheel.h"
 
 #include <condition_variable>
-#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <thread>
 
+/*
+ * Delays events of event loops. Timers are kept in a timing wheel of 1ms ticks.
+ * With a real clock timers are fired by the scheduler's own thread.
+ * With a virtual clock there is no thread, timers are fired by a caller that moves the time, so timer-heavy
+ * flows run instantly and deterministically
+ */
 class Scheduler
 {
-    using CallbackT = std::function<void()>;
-
-    Scheduler()
-    {
-        m_thread = std::thread([this] { run(); });
-    }
-
-    struct IdentifiedLambdaEvent
+    struct DelayedEvent
     {
         xg::Guid target_el_id;
         LambdaEvent ev;
@@ -30,78 +32,46 @@ public:
         return s;
     }
 
-    ~Scheduler()
-    {
-        m_running = false;
-        m_cv.notify_all();
-        m_thread.join();
-    }
+    explicit Scheduler(std::shared_ptr<IClock> clock = std::make_shared<SteadyClock>());
+    explicit Scheduler(std::shared_ptr<VirtualClock> clock);
+    ~Scheduler();
 
-    void delay_event(xg::Guid el_guid, std::chrono::milliseconds delay, LambdaEvent event)
-    {
-        const auto now = std::chrono::steady_clock::now();
-        const auto future_ts = now + delay;
+    void delay_event(xg::Guid el_guid, std::chrono::milliseconds delay, LambdaEvent event);
 
-        std::unique_lock<std::mutex> lock(m_mutex);
+    // LambdaEvent is move-only, the subscriber takes it out of the pointer
+    EventChannel<std::shared_ptr<LambdaEvent>> & delayed_channel(xg::Guid guid);
+    // Events that are still delayed for the loop are dropped
+    void remove_channel(xg::Guid guid);
 
-        m_delayed_events.emplace(future_ts, IdentifiedLambdaEvent{.target_el_id = el_guid, .ev = std::move(event)});
+    const IClock & clock() const { return *m_clock; }
 
-        m_cv.notify_all();
-    }
-
-    EventChannel<LambdaEvent> & delayed_channel(xg::Guid guid)
-    {
-        return m_channels[guid];
-    }
+    // Virtual clock only. Moves the time, events that got due are pushed to their loops before it returns
+    void advance(std::chrono::milliseconds duration);
+    // Virtual clock only. Moves the time to the next delayed event. Returns false if there are none
+    bool advance_to_next_event();
 
 private:
-    void run()
-    {
-        while (m_running) {
-            const auto now = std::chrono::steady_clock::now();
-            std::unique_lock<std::mutex> lock(m_mutex);
-
-            for (auto it = m_delayed_events.begin(), end = m_delayed_events.end(); it != end;) {
-                if (it->first <= now) {
-                    auto & [guid, ev] = it->second;
-
-                    const auto ch_it = m_channels.find(guid);
-                    if (ch_it == m_channels.end()) {
-                        throw std::runtime_error("no channel in scheduler");
-                    }
-                    auto & ch = ch_it->second;
-
-                    ch.push(std::move(ev));
-                    it = m_delayed_events.erase(it);
-                }
-                else {
-                    ++it;
-                }
-            }
-
-            if (m_delayed_events.empty()) {
-                m_cv.wait(lock, [this] { return !m_running || !m_delayed_events.empty(); });
-            }
-            else {
-                m_cv.wait_until(
-                        lock,
-                        m_delayed_events.begin()->first,
-                        [this] {
-                            return !m_running ||
-                                    m_delayed_events.begin()->first <= std::chrono::steady_clock::now();
-                        });
-            }
-        }
-    }
+    void run();
+    // Under the mutex
+    void fire_due_events();
+
+    int64_t tick_at(IClock::TimePoint time_point) const;
+    int64_t next_tick_after(IClock::TimePoint time_point) const;
+    void ensure_virtual(const char * method) const;
 
 private:
+    const std::shared_ptr<IClock> m_clock;
+    const std::shared_ptr<VirtualClock> m_virtual_clock;
+    const IClock::TimePoint m_epoch;
+
     std::mutex m_mutex;
     std::condition_variable m_cv;
 
-    std::multimap<std::chrono::time_point<std::chrono::steady_clock>, IdentifiedLambdaEvent> m_delayed_events;
+    TimingWheel<DelayedEvent> m_delayed_events;
+    bool m_timers_changed = false;
 
-    std::atomic_bool m_running = true;
-    std::thread m_thread;
+    std::map<xg::Guid, EventChannel<std::shared_ptr<LambdaEvent>>> m_channels;
 
-    std::map<xg::Guid, EventChannel<LambdaEvent>> m_channels;
+    bool m_running = true;
+    std::thread m_thread;
 };
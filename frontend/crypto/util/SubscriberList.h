@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Subscribers of a channel, read-copy-update.
+ * Publishers iterate an immutable snapshot without locks, subscribe and unsubscribe replace it with a copy.
+ * Removal returns after all publishers that could see the removed subscriber are done,
+ * so nothing is published to it afterwards.
+ * Subscribers can't be added or removed from for_each of the same list, it would wait for itself
+ */
+template <class T>
+class SubscriberList
+{
+    using Snapshot = std::vector<T>;
+
+public:
+    SubscriberList()
+        : m_snapshot(new Snapshot{})
+    {
+    }
+
+    SubscriberList(const SubscriberList &) = delete;
+    SubscriberList & operator=(const SubscriberList &) = delete;
+
+    ~SubscriberList()
+    {
+        delete m_snapshot.load();
+    }
+
+    template <class F>
+    void for_each(F && f) const
+    {
+        const ReadGuard guard{*this};
+        for (const auto & subscriber : *m_snapshot.load()) {
+            f(subscriber);
+        }
+    }
+
+    // Returns count of subscribers
+    size_t add(T subscriber)
+    {
+        std::lock_guard lock(m_write_mutex);
+        auto next = std::make_unique<Snapshot>(*m_snapshot.load());
+        next->push_back(std::move(subscriber));
+        return replace(std::move(next));
+    }
+
+    // Returns count of subscribers left
+    template <class Pred>
+    size_t remove_if(Pred && pred)
+    {
+        std::lock_guard lock(m_write_mutex);
+        const Snapshot & current = *m_snapshot.load();
+        auto next = std::make_unique<Snapshot>();
+        next->reserve(current.size());
+        for (const auto & subscriber : current) {
+            if (!pred(subscriber)) {
+                next->push_back(subscriber);
+            }
+        }
+        if (next->size() == current.size()) {
+            return current.size();
+        }
+        return replace(std::move(next));
+    }
+
+    // Hands every subscriber to f under the writers' lock and removes them all
+    template <class F>
+    void clear(F && f)
+    {
+        std::lock_guard lock(m_write_mutex);
+        for (const auto & subscriber : *m_snapshot.load()) {
+            f(subscriber);
+        }
+        replace(std::make_unique<Snapshot>());
+    }
+
+    size_t size() const
+    {
+        std::lock_guard lock(m_write_mutex);
+        return m_snapshot.load()->size();
+    }
+
+private:
+    struct ReadGuard
+    {
+        ReadGuard(const SubscriberList & list)
+            : readers(list.m_readers[list.m_epoch.load() % 2])
+        {
+            ++readers;
+        }
+
+        ~ReadGuard() { --readers; }
+
+        std::atomic<size_t> & readers;
+    };
+
+    size_t replace(std::unique_ptr<Snapshot> next)
+    {
+        const size_t size = next->size();
+        const Snapshot * previous = m_snapshot.exchange(next.release());
+        wait_for_readers();
+        delete previous;
+        return size;
+    }
+
+    // New readers go to the other counter after the flip, so each counter drains.
+    // Both are waited for, a reader could pick its counter before the previous flip
+    void wait_for_readers()
+    {
+        for (size_t i = 0; i < m_readers.size(); ++i) {
+            const size_t counter = m_epoch.fetch_add(1) % 2;
+            while (m_readers[counter].load() != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    std::atomic<const Snapshot *> m_snapshot;
+    std::atomic<size_t> m_epoch = 0;
+    mutable std::array<std::atomic<size_t>, 2> m_readers = {};
+    mutable std::mutex m_write_mutex;
+};
@@ -0,0 +1,88 @@
+#include "SubscriberToken.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+constexpr size_t chunk_size = 4096;
+constexpr size_t max_chunks = 4096;
+
+// Generations of all slots. Chunks are never moved or freed, so readers don't lock
+struct Generations
+{
+    std::atomic<uint32_t> & at(uint32_t slot)
+    {
+        return chunks[slot / chunk_size].load(std::memory_order_acquire)[slot % chunk_size];
+    }
+
+    std::array<std::atomic<std::atomic<uint32_t> *>, max_chunks> chunks = {};
+
+    std::mutex mutex;
+    uint32_t slots_count = 0;
+    std::vector<uint32_t> free_slots;
+};
+
+Generations & generations()
+{
+    // never destroyed, subscribers of static objects can go after it
+    static auto * g = new Generations{};
+    return *g;
+}
+
+} // namespace
+
+SubscriberToken::SubscriberToken(uint32_t slot, uint32_t generation)
+    : m_slot(slot)
+    , m_generation(generation)
+{
+}
+
+SubscriberToken SubscriberToken::acquire()
+{
+    auto & g = generations();
+    std::lock_guard lock(g.mutex);
+
+    uint32_t slot = 0;
+    if (!g.free_slots.empty()) {
+        slot = g.free_slots.back();
+        g.free_slots.pop_back();
+    }
+    else {
+        if (g.slots_count == chunk_size * max_chunks) {
+            throw std::runtime_error("Too many subscribers");
+        }
+        slot = g.slots_count++;
+        if (slot % chunk_size == 0) {
+            g.chunks[slot / chunk_size].store(new std::atomic<uint32_t>[chunk_size]{}, std::memory_order_release);
+        }
+    }
+
+    // zero generation is for the default token
+    auto & generation = g.at(slot);
+    if (generation.load() == 0) {
+        generation.store(1);
+    }
+    return {slot, generation.load()};
+}
+
+void SubscriberToken::release() const
+{
+    if (m_generation == 0) {
+        return;
+    }
+
+    auto & g = generations();
+    g.at(m_slot).fetch_add(1);
+
+    std::lock_guard lock(g.mutex);
+    g.free_slots.push_back(m_slot);
+}
+
+bool SubscriberToken::is_alive() const
+{
+    return m_generation == 0 || generations().at(m_slot).load(std::memory_order_acquire) == m_generation;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Marks the events of a subscriber. A token goes stale when its subscriber is gone,
+ * event loops skip events with stale tokens when they pop them, so queued events are never searched.
+ * A token is a slot with a generation, a released slot is reused with the next generation.
+ * Default token has no subscriber and is never stale
+ */
+class SubscriberToken
+{
+public:
+    SubscriberToken() = default;
+
+    static SubscriberToken acquire();
+    // Makes the token and all its copies stale. Once per acquired token
+    void release() const;
+
+    bool is_alive() const;
+
+    // Tells subscribers apart in statistics, unique among tokens acquired so far
+    uint64_t id() const { return (static_cast<uint64_t>(m_slot) << 32) | m_generation; }
+
+    bool operator==(const SubscriberToken &) const = default;
+
+private:
+    SubscriberToken(uint32_t slot, uint32_t generation);
+
+    uint32_t m_slot = 0;
+    uint32_t m_generation = 0;
+};
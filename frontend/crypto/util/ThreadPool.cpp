@@ -0,0 +1,142 @@
+#include "ThreadPool.h"
+
+namespace {
+
+// Pool and queue of the current worker thread
+thread_local const ThreadPool * t_pool = nullptr;
+thread_local size_t t_worker_index = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads_count)
+{
+    threads_count = std::max<size_t>(threads_count, 1);
+    for (size_t i = 0; i < threads_count; ++i) {
+        m_worker_queues.push_back(std::make_unique<TaskQueue>());
+    }
+    for (size_t i = 0; i < threads_count; ++i) {
+        m_threads.emplace_back([this, i] { run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_park_mutex);
+        m_stopping = true;
+    }
+    m_park_cv.notify_all();
+    for (auto & thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(Task task)
+{
+    push(std::move(task), false);
+}
+
+void ThreadPool::resubmit(Task task)
+{
+    push(std::move(task), true);
+}
+
+void ThreadPool::push(Task task, bool behind_others)
+{
+    const bool own_queue = t_pool == this;
+    TaskQueue & queue = own_queue ? *m_worker_queues[t_worker_index] : m_shared_queue;
+    {
+        std::lock_guard lock(queue.mutex);
+        // the front of a worker's queue is the one it gets to last
+        if (own_queue && behind_others) {
+            queue.tasks.push_front(std::move(task));
+        }
+        else {
+            queue.tasks.push_back(std::move(task));
+        }
+    }
+
+    // a worker registers before its last look at the queues, so either it finds the task or it's seen here
+    if (m_sleepers.load() != 0) {
+        wake_one();
+    }
+}
+
+void ThreadPool::wake_one()
+{
+    {
+        std::lock_guard lock(m_park_mutex);
+        m_wake_epoch.fetch_add(1);
+    }
+    m_park_cv.notify_one();
+}
+
+std::optional<ThreadPool::Task> ThreadPool::TaskQueue::pop_back()
+{
+    std::lock_guard lock(mutex);
+    if (tasks.empty()) {
+        return std::nullopt;
+    }
+    std::optional<Task> task = std::move(tasks.back());
+    tasks.pop_back();
+    return task;
+}
+
+std::optional<ThreadPool::Task> ThreadPool::TaskQueue::pop_front()
+{
+    std::lock_guard lock(mutex);
+    if (tasks.empty()) {
+        return std::nullopt;
+    }
+    std::optional<Task> task = std::move(tasks.front());
+    tasks.pop_front();
+    return task;
+}
+
+std::optional<ThreadPool::Task> ThreadPool::find_task(size_t worker_index)
+{
+    if (auto task = m_worker_queues[worker_index]->pop_back()) {
+        return task;
+    }
+    if (auto task = m_shared_queue.pop_front()) {
+        return task;
+    }
+    for (size_t i = 1; i < m_worker_queues.size(); ++i) {
+        if (auto task = m_worker_queues[(worker_index + i) % m_worker_queues.size()]->pop_front()) {
+            return task;
+        }
+    }
+    return std::nullopt;
+}
+
+void ThreadPool::run(size_t worker_index)
+{
+    t_pool = this;
+    t_worker_index = worker_index;
+
+    while (true) {
+        if (auto task = find_task(worker_index)) {
+            (*task)();
+            continue;
+        }
+
+        // a wake after this point changes the epoch, so it's not missed by the wait
+        const uint64_t epoch = m_wake_epoch.load();
+        m_sleepers.fetch_add(1);
+        auto task = find_task(worker_index);
+        if (!task.has_value()) {
+            std::unique_lock lock(m_park_mutex);
+            // queues were empty after the stop, only running tasks can add to them and their workers run those
+            if (m_stopping) {
+                m_sleepers.fetch_sub(1);
+                return;
+            }
+            m_park_cv.wait(lock, [&] { return m_stopping || m_wake_epoch.load() != epoch; });
+        }
+        m_sleepers.fetch_sub(1);
+
+        if (task.has_value()) {
+            (*task)();
+        }
+    }
+}
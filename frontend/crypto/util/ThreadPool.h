@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/*
+ * Work-stealing thread pool. Every worker has its own queue, tasks submitted by a worker go to its queue,
+ * tasks from other threads go to the shared one. A worker runs its own tasks newest first, while their data is hot,
+ * then takes the oldest tasks of the shared queue and of the other workers before parking.
+ * Submit takes the park mutex only if some worker is parked or about to park.
+ * Tasks left on destruction are run before workers exit
+ */
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+    // One worker per hardware thread
+    static ThreadPool & i()
+    {
+        static ThreadPool p{std::max(std::thread::hardware_concurrency(), 1u)};
+        return p;
+    }
+
+    explicit ThreadPool(size_t threads_count);
+    ~ThreadPool();
+
+    void submit(Task task);
+    // For a task that gave up its turn. It goes behind the other tasks of the queue, so it doesn't starve them
+    void resubmit(Task task);
+
+    size_t threads_count() const { return m_threads.size(); }
+
+private:
+    // Owner works at the back, thieves and the shared queue's consumers take from the front
+    struct TaskQueue
+    {
+        std::optional<Task> pop_back();
+        std::optional<Task> pop_front();
+
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(Task task, bool behind_others);
+    void wake_one();
+
+    void run(size_t worker_index);
+    std::optional<Task> find_task(size_t worker_index);
+
+private:
+    std::vector<std::unique_ptr<TaskQueue>> m_worker_queues;
+    TaskQueue m_shared_queue;
+
+    // Eventcount: a worker registers as a sleeper and looks at the queues once more before it parks.
+    // A submit that sees a sleeper bumps the epoch, the parked worker waits for it to change
+    std::atomic<size_t> m_sleepers = 0;
+    std::atomic<uint64_t> m_wake_epoch = 0; // changed under the park mutex
+    std::mutex m_park_mutex;
+    std::condition_variable m_park_cv;
+    bool m_stopping = false;
+
+    std::vector<std::thread> m_threads;
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/*
+ * Hierarchical timing wheel with ticks of any unit.
+ * 4 levels of 256 slots cover 2^32 ticks, later timers wait in the last level and get placed again.
+ * A level's slot is moved to lower levels when the lower ticks wrap around.
+ * Insert is O(1), advance visits only the ticks that have something to fire or to move.
+ * Timers of the same tick fire in order of insertion. Not thread safe
+ */
+template <class T>
+class TimingWheel
+{
+    static constexpr size_t slot_bits = 8;
+    static constexpr size_t slots_count = size_t{1} << slot_bits;
+    static constexpr size_t levels_count = 4;
+    static constexpr int64_t max_delta = (int64_t{1} << (slot_bits * levels_count)) - 1;
+
+    struct Timer
+    {
+        int64_t tick;
+        uint64_t seq;
+        T value;
+    };
+
+    using Slot = std::vector<Timer>;
+    using Bitmap = std::array<uint64_t, slots_count / 64>;
+
+public:
+    TimingWheel(int64_t current_tick = 0)
+        : m_current(current_tick)
+    {
+    }
+
+    int64_t current_tick() const { return m_current; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    // A timer of a passed tick fires at the next advance
+    void insert(int64_t tick, T value)
+    {
+        place(Timer{tick, m_next_seq++, std::move(value)});
+        ++m_size;
+    }
+
+    // Earliest tick when advance has something to do. It's not always a timer's tick
+    std::optional<int64_t> next_tick() const
+    {
+        if (!m_due.empty()) {
+            return m_current;
+        }
+
+        std::optional<int64_t> res;
+        for (size_t level = 0; level < levels_count; ++level) {
+            const int64_t level_tick = m_current >> (slot_bits * level);
+            const auto distance = next_occupied(m_occupied[level], static_cast<size_t>(level_tick) % slots_count);
+            if (distance.has_value()) {
+                const int64_t tick = (level_tick + static_cast<int64_t>(distance.value())) << (slot_bits * level);
+                res = std::min(res.value_or(tick), tick);
+            }
+        }
+        return res;
+    }
+
+    // Moves to the tick calling on_expired(T &&) for every timer up to it, in order of ticks
+    template <class F>
+    void advance(int64_t tick, F && on_expired)
+    {
+        while (true) {
+            fire_due(on_expired);
+
+            const auto next = next_tick();
+            if (!next.has_value() || next.value() > tick) {
+                break;
+            }
+            step_to(next.value());
+        }
+        m_current = std::max(m_current, tick);
+    }
+
+private:
+    void place(Timer && timer)
+    {
+        const int64_t delta = timer.tick - m_current;
+        if (delta <= 0) {
+            m_due.push_back(std::move(timer));
+            return;
+        }
+
+        size_t level = 0;
+        while (level + 1 < levels_count && delta >= (int64_t{1} << (slot_bits * (level + 1)))) {
+            ++level;
+        }
+        // too far timers wait in the furthest slot
+        const int64_t placed_tick = m_current + std::min(delta, max_delta);
+        const size_t slot = static_cast<size_t>(placed_tick >> (slot_bits * level)) % slots_count;
+        m_slots[level][slot].push_back(std::move(timer));
+        m_occupied[level][slot / 64] |= uint64_t{1} << (slot % 64);
+    }
+
+    void take_slot(size_t level, size_t slot, Slot & out)
+    {
+        out.swap(m_slots[level][slot]);
+        m_occupied[level][slot / 64] &= ~(uint64_t{1} << (slot % 64));
+    }
+
+    void step_to(int64_t tick)
+    {
+        m_current = tick;
+        for (size_t level = 1; level < levels_count; ++level) {
+            const int64_t level_mask = (int64_t{1} << (slot_bits * level)) - 1;
+            if ((tick & level_mask) != 0) {
+                break;
+            }
+            take_slot(level, static_cast<size_t>(tick >> (slot_bits * level)) % slots_count, m_moving);
+            for (auto & timer : m_moving) {
+                place(std::move(timer));
+            }
+            m_moving.clear();
+        }
+
+        take_slot(0, static_cast<size_t>(tick) % slots_count, m_moving);
+        for (auto & timer : m_moving) {
+            m_due.push_back(std::move(timer));
+        }
+        m_moving.clear();
+    }
+
+    template <class F>
+    void fire_due(F & on_expired)
+    {
+        // callbacks may insert new timers
+        while (!m_due.empty()) {
+            m_firing.swap(m_due);
+            std::ranges::sort(m_firing, [](const Timer & lhs, const Timer & rhs) {
+                return lhs.tick != rhs.tick ? lhs.tick < rhs.tick : lhs.seq < rhs.seq;
+            });
+            for (auto & timer : m_firing) {
+                --m_size;
+                on_expired(std::move(timer.value));
+            }
+            m_firing.clear();
+        }
+    }
+
+    // Distance to the next occupied slot after 'from', up to a full turn
+    static std::optional<size_t> next_occupied(const Bitmap & bitmap, size_t from)
+    {
+        size_t distance = 1;
+        while (distance <= slots_count) {
+            const size_t slot = (from + distance) % slots_count;
+            const uint64_t rest = bitmap[slot / 64] >> (slot % 64);
+            if (rest != 0) {
+                distance += static_cast<size_t>(std::countr_zero(rest));
+                return distance <= slots_count ? std::optional{distance} : std::nullopt;
+            }
+            distance += 64 - slot % 64;
+        }
+        return std::nullopt;
+    }
+
+private:
+    int64_t m_current = 0;
+    uint64_t m_next_seq = 0;
+    size_t m_size = 0;
+
+    std::array<std::array<Slot, slots_count>, levels_count> m_slots;
+    std::array<Bitmap, levels_count> m_occupied = {};
+
+    Slot m_due;
+    // reused buffers
+    Slot m_moving;
+    Slot m_firing;
+};
@@ -0,0 +1,180 @@
+#include "Tracer.h"
+
+#include "Demangle.h"
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+
+Tracer & Tracer::i()
+{
+    // never destroyed, threads of static objects can trace after it
+    static auto * t = new Tracer{};
+    return *t;
+}
+
+bool Tracer::start(const std::string & path)
+{
+    stop();
+
+    m_file.open(path, std::ios::trunc);
+    if (!m_file.is_open()) {
+        return false;
+    }
+    m_file << "[\n";
+    m_first_record = true;
+    m_origin = Clock::now();
+
+    // leftovers of a previous trace, recorded after it was stopped
+    {
+        std::lock_guard lock(m_rings_mutex);
+        for (const auto & thread_ring : m_rings) {
+            while (thread_ring->ring.try_pop().has_value()) {
+            }
+        }
+    }
+
+    m_stopping = false;
+    m_writer = std::thread([this] { write_loop(); });
+    m_enabled.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void Tracer::stop()
+{
+    m_enabled.store(false, std::memory_order_relaxed);
+    if (!m_writer.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock(m_writer_mutex);
+        m_stopping = true;
+    }
+    m_writer_cv.notify_all();
+    m_writer.join();
+
+    m_file << "\n]\n";
+    m_file.close();
+}
+
+void Tracer::complete(const char * category, const char * name, Clock::time_point start, Clock::time_point end, const char * type)
+{
+    record({.phase = 'X', .category = category, .name = name, .type = type, .ts = start, .duration = end - start});
+}
+
+void Tracer::instant(const char * category, const char * name, const char * type)
+{
+    record({.phase = 'i', .category = category, .name = name, .type = type, .ts = Clock::now()});
+}
+
+uint64_t Tracer::flow_start()
+{
+    const uint64_t id = m_last_flow_id.fetch_add(1, std::memory_order_relaxed) + 1;
+    record({.phase = 's', .category = "loop", .name = "event", .ts = Clock::now(), .id = id});
+    return id;
+}
+
+void Tracer::flow_end(uint64_t id, Clock::time_point ts)
+{
+    record({.phase = 'f', .category = "loop", .name = "event", .ts = ts, .id = id});
+}
+
+void Tracer::record(Record record)
+{
+    if (!thread_ring().ring.try_push(record)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+Tracer::ThreadRing & Tracer::thread_ring()
+{
+    // shared with the writer, so records of a finished thread are still written
+    thread_local std::shared_ptr<ThreadRing> t_ring;
+    if (t_ring == nullptr) {
+        t_ring = std::make_shared<ThreadRing>();
+        std::lock_guard lock(m_rings_mutex);
+        t_ring->tid = ++m_last_tid;
+        m_rings.push_back(t_ring);
+    }
+    return *t_ring;
+}
+
+void Tracer::write_loop()
+{
+    while (true) {
+        bool stopping = false;
+        {
+            std::unique_lock lock(m_writer_mutex);
+            stopping = m_writer_cv.wait_for(lock, write_period, [this] { return m_stopping; });
+        }
+        write_pending();
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+void Tracer::write_pending()
+{
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    {
+        std::lock_guard lock(m_rings_mutex);
+        rings = m_rings;
+    }
+
+    for (const auto & thread_ring : rings) {
+        while (auto record = thread_ring->ring.try_pop()) {
+            write_record(thread_ring->tid, record.value());
+        }
+    }
+    m_file.flush();
+
+    // rings of finished threads are owned by the list and the local copy only
+    rings.clear();
+    std::lock_guard lock(m_rings_mutex);
+    std::erase_if(m_rings, [](const std::shared_ptr<ThreadRing> & thread_ring) {
+        return thread_ring.use_count() == 1 && thread_ring->ring.empty();
+    });
+}
+
+void Tracer::write_record(uint32_t tid, const Record & record)
+{
+    const double ts_us = std::chrono::duration<double, std::micro>(record.ts - m_origin).count();
+
+    m_line.clear();
+    auto out = std::back_inserter(m_line);
+    fmt::format_to(
+            out,
+            R"({}{{"ph":"{}","cat":"{}","name":"{}","pid":1,"tid":{},"ts":{:.3f})",
+            m_first_record ? "" : ",\n",
+            record.phase,
+            record.category,
+            record.name,
+            tid,
+            ts_us);
+
+    switch (record.phase) {
+    case 'X': fmt::format_to(out, R"(,"dur":{:.3f})", std::chrono::duration<double, std::micro>(record.duration).count()); break;
+    case 'i': fmt::format_to(out, R"(,"s":"t")"); break;
+    case 's': fmt::format_to(out, R"(,"id":{})", record.id); break;
+    case 'f': fmt::format_to(out, R"(,"id":{},"bp":"e")", record.id); break;
+    }
+    if (record.type != nullptr) {
+        fmt::format_to(out, R"(,"args":{{"type":{}}})", type_name(record.type));
+    }
+    m_line += '}';
+
+    m_file << m_line;
+    m_first_record = false;
+}
+
+const std::string & Tracer::type_name(const char * mangled)
+{
+    auto it = m_type_names.find(mangled);
+    if (it == m_type_names.end()) {
+        // quoted and escaped for json
+        it = m_type_names.emplace(mangled, nlohmann::json(demangle(mangled)).dump()).first;
+    }
+    return it->second;
+}
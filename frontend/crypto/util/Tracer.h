@@ -0,0 +1,129 @@
+#pragma once
+
+#include "MpscRingBuffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Records spans of the event flow in Chrome trace event format, opened by chrome://tracing or ui.perfetto.dev.
+ * Off by default, then a trace point only checks a flag.
+ * Every thread records to a ring of its own, a background thread writes the rings to the file,
+ * so trace points neither lock nor allocate. Records that don't fit a full ring are dropped and counted.
+ * Names are not copied, they must be string literals
+ */
+class Tracer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static Tracer & i();
+
+    // Returns false if the file can't be opened. A started tracer is stopped first
+    bool start(const std::string & path);
+    // Writes what is recorded so far and closes the file
+    void stop();
+
+    bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    uint64_t dropped_count() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // Type is a mangled name, like the event source of a LambdaEvent. It's demangled when written
+    void complete(const char * category, const char * name, Clock::time_point start, Clock::time_point end, const char * type = nullptr);
+    void instant(const char * category, const char * name, const char * type = nullptr);
+
+    // Arrow from the span around flow_start to the span starting at flow_end's time. Returns the id for flow_end
+    uint64_t flow_start();
+    void flow_end(uint64_t id, Clock::time_point ts);
+
+private:
+    struct Record
+    {
+        char phase = 0;
+        const char * category = nullptr;
+        const char * name = nullptr;
+        const char * type = nullptr;
+        Clock::time_point ts;
+        Clock::duration duration{0};
+        uint64_t id = 0;
+    };
+
+    static constexpr size_t ring_capacity = 8192;
+    static constexpr std::chrono::milliseconds write_period{50};
+
+    struct ThreadRing
+    {
+        uint32_t tid = 0;
+        MpscRingBuffer<Record, ring_capacity> ring;
+    };
+
+    Tracer() = default;
+
+    void record(Record record);
+    ThreadRing & thread_ring();
+
+    void write_loop();
+    void write_pending();
+    void write_record(uint32_t tid, const Record & record);
+    const std::string & type_name(const char * mangled);
+
+private:
+    std::atomic_bool m_enabled = false;
+    std::atomic<uint64_t> m_dropped = 0;
+    std::atomic<uint64_t> m_last_flow_id = 0;
+
+    std::mutex m_rings_mutex;
+    std::vector<std::shared_ptr<ThreadRing>> m_rings;
+    uint32_t m_last_tid = 0;
+
+    // writer's state
+    std::ofstream m_file;
+    Clock::time_point m_origin;
+    bool m_first_record = true;
+    std::map<const char *, std::string> m_type_names;
+    std::string m_line;
+
+    std::mutex m_writer_mutex;
+    std::condition_variable m_writer_cv;
+    bool m_stopping = false;
+    std::thread m_writer;
+};
+
+// Complete span from construction to destruction
+class TraceScope
+{
+public:
+    TraceScope(const char * category, const char * name, const char * type = nullptr)
+        : m_category(Tracer::i().enabled() ? category : nullptr)
+        , m_name(name)
+        , m_type(type)
+    {
+        if (m_category != nullptr) {
+            m_start = Tracer::Clock::now();
+        }
+    }
+
+    ~TraceScope()
+    {
+        if (m_category != nullptr) {
+            Tracer::i().complete(m_category, m_name, m_start, Tracer::Clock::now(), m_type);
+        }
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope & operator=(const TraceScope &) = delete;
+
+private:
+    const char * m_category;
+    const char * m_name;
+    const char * m_type;
+    Tracer::Clock::time_point m_start;
+};
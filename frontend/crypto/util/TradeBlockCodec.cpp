@@ -0,0 +1,314 @@
+#include "TradeBlockCodec.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr size_t max_volume_scale = 12;
+
+constexpr std::array<double, max_volume_scale + 1> powers_of_10 = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12};
+
+// units must fit into a varint with the side bit
+constexpr double max_volume_units = static_cast<double>(uint64_t{1} << 62);
+
+uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void write_varint(uint64_t value, std::vector<std::byte> & out)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::byte>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::byte>(value));
+}
+
+uint64_t read_varint(const std::byte *& it)
+{
+    uint64_t res = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        const auto byte = std::to_integer<uint64_t>(*it++);
+        res |= (byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return res;
+        }
+    }
+}
+
+void write_double(double value, std::vector<std::byte> & out)
+{
+    const auto bytes = std::bit_cast<std::array<std::byte, sizeof(double)>>(value);
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+double read_double(const std::byte *& it)
+{
+    double res = 0.;
+    std::memcpy(&res, it, sizeof(res));
+    it += sizeof(res);
+    return res;
+}
+
+// Most significant bit first
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<std::byte> & out)
+        : m_out(out)
+    {
+    }
+
+    // bits in [0, 64], value must not have higher bits set
+    void write(uint64_t value, unsigned bits)
+    {
+        if (bits > 32) {
+            write(value >> 32, bits - 32);
+            value &= 0xffffffff;
+            bits = 32;
+        }
+        m_acc = (m_acc << bits) | value;
+        m_acc_bits += bits;
+        while (m_acc_bits >= 8) {
+            m_acc_bits -= 8;
+            m_out.push_back(static_cast<std::byte>(m_acc >> m_acc_bits));
+        }
+    }
+
+    void flush()
+    {
+        if (m_acc_bits > 0) {
+            m_out.push_back(static_cast<std::byte>(m_acc << (8 - m_acc_bits)));
+            m_acc_bits = 0;
+        }
+    }
+
+private:
+    std::vector<std::byte> & m_out;
+    uint64_t m_acc = 0;
+    unsigned m_acc_bits = 0;
+};
+
+class BitReader
+{
+public:
+    BitReader(const std::byte * begin, const std::byte * end)
+        : m_it(begin)
+        , m_end(end)
+    {
+    }
+
+    // bits in [0, 64]
+    uint64_t read(unsigned bits)
+    {
+        if (bits > 32) {
+            const uint64_t high = read(bits - 32);
+            return (high << 32) | read(32);
+        }
+        while (m_acc_bits < bits) {
+            // zero padding after the end, it's never returned for valid data
+            const uint64_t byte = m_it != m_end ? std::to_integer<uint64_t>(*m_it++) : 0;
+            m_acc = (m_acc << 8) | byte;
+            m_acc_bits += 8;
+        }
+        m_acc_bits -= bits;
+        return (m_acc >> m_acc_bits) & ((uint64_t{1} << bits) - 1);
+    }
+
+private:
+    const std::byte * m_it;
+    const std::byte * m_end;
+    uint64_t m_acc = 0;
+    unsigned m_acc_bits = 0;
+};
+
+/*
+ * '0' - same value as the previous one
+ * '10' + meaningful bits - XOR fits into the previous window of meaningful bits
+ * '11' + 5 bits of leading zeros + 6 bits of (length - 1) + meaningful bits - new window
+ */
+class XorEncoder
+{
+public:
+    void encode(double value, BitWriter & writer)
+    {
+        const auto bits = std::bit_cast<uint64_t>(value);
+        if (m_first) {
+            writer.write(bits, 64);
+            m_prev = bits;
+            m_first = false;
+            return;
+        }
+
+        const uint64_t xor_value = bits ^ m_prev;
+        m_prev = bits;
+        if (xor_value == 0) {
+            writer.write(0, 1);
+            return;
+        }
+
+        const unsigned leading = std::min(std::countl_zero(xor_value), 31);
+        const unsigned trailing = std::countr_zero(xor_value);
+        if (m_window_length > 0 && leading >= m_leading && trailing >= 64 - m_leading - m_window_length) {
+            writer.write(0b10, 2);
+            writer.write(xor_value >> (64 - m_leading - m_window_length), m_window_length);
+            return;
+        }
+
+        m_leading = leading;
+        m_window_length = 64 - leading - trailing;
+        writer.write(0b11, 2);
+        writer.write(m_leading, 5);
+        writer.write(m_window_length - 1, 6);
+        writer.write(xor_value >> trailing, m_window_length);
+    }
+
+private:
+    bool m_first = true;
+    uint64_t m_prev = 0;
+    unsigned m_leading = 0;
+    unsigned m_window_length = 0;
+};
+
+class XorDecoder
+{
+public:
+    double decode(BitReader & reader)
+    {
+        if (m_first) {
+            m_prev = reader.read(64);
+            m_first = false;
+        }
+        else if (reader.read(1) != 0) {
+            if (reader.read(1) != 0) {
+                m_leading = static_cast<unsigned>(reader.read(5));
+                m_window_length = static_cast<unsigned>(reader.read(6)) + 1;
+            }
+            m_prev ^= reader.read(m_window_length) << (64 - m_leading - m_window_length);
+        }
+        return std::bit_cast<double>(m_prev);
+    }
+
+private:
+    bool m_first = true;
+    uint64_t m_prev = 0;
+    unsigned m_leading = 0;
+    unsigned m_window_length = 0;
+};
+
+// Smallest number of decimals that represents all volumes exactly
+uint8_t volume_scale(std::span<const double> volumes)
+{
+    for (size_t scale = 0; scale <= max_volume_scale; ++scale) {
+        const bool fits = std::ranges::all_of(volumes, [&](double volume) {
+            const double units = std::round(std::abs(volume) * powers_of_10[scale]);
+            return units < max_volume_units && units / powers_of_10[scale] == std::abs(volume);
+        });
+        if (fits) {
+            return static_cast<uint8_t>(scale);
+        }
+    }
+    return TradeBlockCodec::raw_volumes;
+}
+
+} // namespace
+
+void TradeBlockCodec::encode(
+        std::span<const int64_t> timestamps,
+        std::span<const double> prices,
+        std::span<const double> volumes,
+        std::vector<std::byte> & out)
+{
+    std::vector<std::byte> ts_bytes;
+    int64_t prev_ts = 0;
+    int64_t prev_delta = 0;
+    for (size_t i = 0; i < timestamps.size(); ++i) {
+        if (i == 0) {
+            write_varint(zigzag(timestamps[i]), ts_bytes);
+        }
+        else {
+            const int64_t delta = timestamps[i] - prev_ts;
+            write_varint(zigzag(delta - prev_delta), ts_bytes);
+            prev_delta = delta;
+        }
+        prev_ts = timestamps[i];
+    }
+
+    std::vector<std::byte> volume_bytes;
+    const uint8_t scale = volume_scale(volumes);
+    volume_bytes.push_back(static_cast<std::byte>(scale));
+    for (const double volume : volumes) {
+        if (scale == raw_volumes) {
+            write_double(volume, volume_bytes);
+            continue;
+        }
+        const auto units = static_cast<uint64_t>(std::round(std::abs(volume) * powers_of_10[scale]));
+        write_varint((units << 1) | (std::signbit(volume) ? 1 : 0), volume_bytes);
+    }
+
+    write_varint(ts_bytes.size(), out);
+    write_varint(volume_bytes.size(), out);
+    out.insert(out.end(), ts_bytes.begin(), ts_bytes.end());
+    out.insert(out.end(), volume_bytes.begin(), volume_bytes.end());
+
+    BitWriter writer(out);
+    XorEncoder price_encoder;
+    for (const double price : prices) {
+        price_encoder.encode(price, writer);
+    }
+    writer.flush();
+}
+
+void TradeBlockCodec::decode(std::span<const std::byte> block, size_t count, std::vector<PublicTrade> & out)
+{
+    out.clear();
+    out.reserve(count);
+
+    const std::byte * it = block.data();
+    const size_t ts_size = read_varint(it);
+    const size_t volume_size = read_varint(it);
+
+    const std::byte * ts_it = it;
+    const std::byte * volume_it = ts_it + ts_size;
+    BitReader price_reader(volume_it + volume_size, block.data() + block.size());
+
+    const auto scale = std::to_integer<uint8_t>(*volume_it++);
+    XorDecoder price_decoder;
+
+    int64_t ts = 0;
+    int64_t delta = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (i == 0) {
+            ts = unzigzag(read_varint(ts_it));
+        }
+        else {
+            delta += unzigzag(read_varint(ts_it));
+            ts += delta;
+        }
+
+        double volume = 0.;
+        if (scale == raw_volumes) {
+            volume = read_double(volume_it);
+        }
+        else {
+            const uint64_t packed = read_varint(volume_it);
+            volume = static_cast<double>(packed >> 1) / powers_of_10[scale];
+            if ((packed & 1) != 0) {
+                volume = -volume;
+            }
+        }
+
+        out.emplace_back(std::chrono::milliseconds{ts}, price_decoder.decode(price_reader), SignedVolume{volume});
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Trade.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+ * Lossless compression of a block of public trades.
+ * Block layout:
+ * | varint ts_bytes | varint volume_bytes | timestamps | volumes | prices |
+ * Timestamps: zigzag varints, the first one as is, then delta-of-delta.
+ * Volumes: one byte with the decimal scale, then varints of (units << 1 | is_sell).
+ *          If some volume is not a whole number of units for any scale, the scale byte is raw_volumes
+ *          and volumes are stored as raw doubles.
+ * Prices: bit stream of XORs with the previous price, meaningful bits only (as in Facebook's Gorilla).
+ */
+class TradeBlockCodec
+{
+public:
+    static constexpr uint8_t raw_volumes = 0xff;
+
+    // Appends the encoded block to 'out'
+    static void encode(
+            std::span<const int64_t> timestamps,
+            std::span<const double> prices,
+            std::span<const double> volumes,
+            std::vector<std::byte> & out);
+
+    // Replaces the content of 'out' with 'count' trades of the block.
+    // Doesn't validate the data, blocks come from files with a verified checksum
+    static void decode(std::span<const std::byte> block, size_t count, std::vector<PublicTrade> & out);
+};
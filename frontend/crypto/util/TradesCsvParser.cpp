@@ -0,0 +1,136 @@
+#include "TradesCsvParser.h"
+
+#include "Logger.h"
+#include "MappedFile.h"
+
+#include <array>
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+constexpr size_t fields_to_parse = 5; // up to the price
+
+// memchr is vectorized by libc, much faster than a byte loop on long lines
+const char * find(const char * begin, const char * end, char c)
+{
+    const auto * res = static_cast<const char *>(std::memchr(begin, c, static_cast<size_t>(end - begin)));
+    return res != nullptr ? res : end;
+}
+
+size_t count_lines(std::string_view data)
+{
+    size_t res = 0;
+    for (const char * it = data.data(), * end = data.data() + data.size(); it != end; ++res) {
+        it = find(it, end, '\n');
+        if (it != end) {
+            ++it;
+        }
+    }
+    return res;
+}
+
+template <class T>
+bool parse_number(std::string_view str, T & value)
+{
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    return ec == std::errc{} && ptr == str.data() + str.size();
+}
+
+} // namespace
+
+std::optional<int64_t> TradesCsvParser::parse_timestamp(std::string_view str)
+{
+    const auto dot_pos = str.find('.');
+
+    int64_t seconds = 0;
+    if (!parse_number(str.substr(0, dot_pos), seconds)) {
+        return std::nullopt;
+    }
+
+    int64_t millis = 0;
+    if (dot_pos != std::string_view::npos) {
+        const auto fraction = str.substr(dot_pos + 1);
+        int64_t multiplier = 100;
+        for (size_t i = 0; i < fraction.size(); ++i) {
+            if (fraction[i] < '0' || fraction[i] > '9') {
+                return std::nullopt;
+            }
+            // keeping first 3 digits, e.g. 1712967661.67 -> 670
+            if (i < 3) {
+                millis += (fraction[i] - '0') * multiplier;
+                multiplier /= 10;
+            }
+        }
+    }
+
+    return (seconds * 1000) + millis;
+}
+
+std::optional<TradeColumns> TradesCsvParser::parse(std::string_view csv)
+{
+    TradeColumns res;
+    res.reserve(count_lines(csv));
+
+    const char * const end = csv.data() + csv.size();
+    for (const char * line_begin = csv.data(); line_begin < end;) {
+        const char * line_end = find(line_begin, end, '\n');
+        const std::string_view line{line_begin, static_cast<size_t>(line_end - line_begin)};
+        line_begin = line_end + 1;
+
+        if (line.empty() || line == "\r") {
+            continue;
+        }
+
+        std::array<std::string_view, fields_to_parse> fields;
+        const char * field_begin = line.data();
+        const char * const fields_end = line.data() + line.size();
+        for (size_t i = 0; i < fields.size(); ++i) {
+            if (field_begin > fields_end) {
+                LOG_ERROR("Not enough fields in trades csv line: {}", line);
+                return std::nullopt;
+            }
+            const char * field_end = find(field_begin, fields_end, ',');
+            fields[i] = {field_begin, static_cast<size_t>(field_end - field_begin)};
+            field_begin = field_end + 1;
+        }
+
+        const auto & [ts_str, symbol_str, side_str, size_str, price_str] = fields;
+
+        const auto ts = parse_timestamp(ts_str);
+        double volume = 0.;
+        double price = 0.;
+        const bool is_buy = side_str == "Buy";
+        if (!ts.has_value() ||
+            !parse_number(size_str, volume) ||
+            !parse_number(price_str, price) ||
+            volume < 0. ||
+            (!is_buy && side_str != "Sell")) {
+            LOG_ERROR("Malformed trades csv line: {}", line);
+            return std::nullopt;
+        }
+
+        res.timestamps.push_back(ts.value());
+        res.prices.push_back(price);
+        res.volumes.push_back(is_buy ? volume : -volume);
+    }
+
+    return res;
+}
+
+std::optional<TradeColumns> TradesCsvParser::parse_file(const std::filesystem::path & path)
+{
+    const auto file = MappedFile::open(path);
+    if (!file.has_value()) {
+        return std::nullopt;
+    }
+
+    const std::string_view data{reinterpret_cast<const char *>(file->data().data()), file->size()};
+
+    // skip csv header
+    const auto header_end = data.find('\n');
+    if (header_end == std::string_view::npos) {
+        return TradeColumns{};
+    }
+    return parse(data.substr(header_end + 1));
+}
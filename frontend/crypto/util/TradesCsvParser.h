@@ -0,0 +1,28 @@
+#pragma once
+
+#include "TradesFile.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+/*
+ * Parser of Bybit's public trades csv:
+ * timestamp,symbol,side,size,price,tickDirection,trdMatchID,grossValue,homeNotional,foreignNotional
+ * 1712967661.67,BTCUSDT,Buy,0.001,70345.5,ZeroMinusTick,...
+ * Timestamp is in seconds with from 0 to N fractional digits, digits after milliseconds are dropped.
+ * The whole file is memory mapped and parsed straight into columns, without per line allocations.
+ */
+class TradesCsvParser
+{
+public:
+    // Returns nullopt if the file can't be read or has a malformed line
+    static std::optional<TradeColumns> parse_file(const std::filesystem::path & path);
+
+    // Data after the header line
+    static std::optional<TradeColumns> parse(std::string_view csv);
+
+    // '1712967661.67' -> 1712967661670
+    static std::optional<int64_t> parse_timestamp(std::string_view str);
+};
@@ -0,0 +1,160 @@
+#include "TradesDayCache.h"
+
+#include "Logger.h"
+
+TradesDayCache & TradesDayCache::i()
+{
+    static TradesDayCache c;
+    return c;
+}
+
+TradesDayCache::DayPtr TradesDayCache::get(const std::string & path)
+{
+    std::unique_lock lock(m_mutex);
+
+    if (const auto it = m_entries.find(path); it != m_entries.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru_it);
+        const auto future = it->second.day;
+        lock.unlock();
+        return future.get();
+    }
+
+    std::promise<DayPtr> promise;
+    m_lru.push_front({.path = path, .block = std::nullopt});
+    m_entries.emplace(path, Entry{.day = promise.get_future().share(), .size_bytes = 0, .loaded = false, .lru_it = m_lru.begin(), .blocks = {}});
+    lock.unlock();
+
+    // loading outside the lock, concurrent requests for this day wait on the future
+    auto day_opt = TradesFile::map(path);
+    DayPtr day = day_opt.has_value() ? std::make_shared<const TradesDay>(std::move(day_opt.value())) : nullptr;
+    promise.set_value(day);
+
+    lock.lock();
+    const auto it = m_entries.find(path);
+    if (day == nullptr) {
+        m_lru.erase(it->second.lru_it);
+        m_entries.erase(it);
+        return nullptr;
+    }
+
+    it->second.size_bytes = day->size_bytes();
+    it->second.loaded = true;
+    m_memory_usage += it->second.size_bytes;
+    evict(lock);
+    return day;
+}
+
+TradesDayCache::BlockPtr TradesDayCache::get_block(const std::string & path, size_t block)
+{
+    // keeps the day's entry in the cache while the block is looked up
+    const auto day = get(path);
+    if (day == nullptr || block >= day->blocks_count()) {
+        return nullptr;
+    }
+
+    std::unique_lock lock(m_mutex);
+    auto & blocks = m_entries.at(path).blocks;
+    if (const auto it = blocks.find(block); it != blocks.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru_it);
+        const auto future = it->second.trades;
+        lock.unlock();
+        return future.get();
+    }
+
+    std::promise<BlockPtr> promise;
+    m_lru.push_front({.path = path, .block = block});
+    blocks.emplace(block, BlockEntry{.trades = promise.get_future().share(), .size_bytes = 0, .loaded = false, .lru_it = m_lru.begin()});
+    lock.unlock();
+
+    // decoding outside the lock, concurrent requests for this block wait on the future
+    auto trades = std::make_shared<std::vector<PublicTrade>>();
+    BlockPtr res = day->decode_block(block, *trades) ? std::move(trades) : nullptr;
+    promise.set_value(res);
+
+    lock.lock();
+    const auto it = blocks.find(block);
+    if (res == nullptr) {
+        m_lru.erase(it->second.lru_it);
+        blocks.erase(it);
+        return nullptr;
+    }
+
+    it->second.size_bytes = res->capacity() * sizeof(PublicTrade);
+    it->second.loaded = true;
+    m_memory_usage += it->second.size_bytes;
+    evict(lock);
+    return res;
+}
+
+void TradesDayCache::evict(std::unique_lock<std::mutex> &)
+{
+    // a day older than its blocks is evicted by the next pass, once the blocks are gone
+    for (bool evicted = true; evicted && m_memory_usage > m_memory_budget;) {
+        evicted = false;
+        for (auto lru_it = m_lru.rbegin(); lru_it != m_lru.rend() && m_memory_usage > m_memory_budget;) {
+            if (!try_evict(*lru_it)) {
+                ++lru_it;
+                continue;
+            }
+
+            evicted = true;
+            lru_it = decltype(lru_it){m_lru.erase(std::next(lru_it).base())};
+        }
+    }
+}
+
+bool TradesDayCache::try_evict(const LruKey & key)
+{
+    const auto it = m_entries.find(key.path);
+    auto & entry = it->second;
+
+    // the only owner left is the cache
+    if (key.block.has_value()) {
+        const auto block_it = entry.blocks.find(key.block.value());
+        const auto & block = block_it->second;
+        if (!block.loaded || block.trades.get().use_count() != 1) {
+            return false;
+        }
+
+        m_memory_usage -= block.size_bytes;
+        entry.blocks.erase(block_it);
+        return true;
+    }
+
+    if (!entry.loaded || entry.day.get().use_count() != 1 || !entry.blocks.empty()) {
+        return false;
+    }
+
+    LOG_DEBUG("Evicting trades day from cache: {}", it->first);
+    m_memory_usage -= entry.size_bytes;
+    m_entries.erase(it);
+    return true;
+}
+
+void TradesDayCache::set_memory_budget(size_t bytes)
+{
+    std::unique_lock lock(m_mutex);
+    m_memory_budget = bytes;
+    evict(lock);
+}
+
+size_t TradesDayCache::memory_usage() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_memory_usage;
+}
+
+size_t TradesDayCache::days_count() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
+
+void TradesDayCache::clear()
+{
+    std::unique_lock lock(m_mutex);
+    const auto budget = m_memory_budget;
+    m_memory_budget = 0;
+    evict(lock);
+    m_memory_budget = budget;
+}
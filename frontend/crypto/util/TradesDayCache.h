@@ -0,0 +1,81 @@
+#pragma once
+
+#include "TradesFile.h"
+
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+ * Process-wide cache of loaded trade days and their decoded blocks, shared by all readers,
+ * so a sweep over many configs decodes every block once.
+ * Concurrent requests for the same day or block wait for a single load.
+ * Days and blocks that are not referenced by any reader are evicted in LRU order
+ * once the total size exceeds the memory budget. A day goes after all of its blocks.
+ * Days and blocks in use are never evicted, so the budget can be exceeded temporarily.
+ */
+class TradesDayCache
+{
+    TradesDayCache() = default;
+
+public:
+    using DayPtr = std::shared_ptr<const TradesDay>;
+    using BlockPtr = std::shared_ptr<const std::vector<PublicTrade>>;
+
+    static constexpr size_t default_memory_budget = size_t{4} * 1024 * 1024 * 1024;
+
+    static TradesDayCache & i();
+
+    // Returns nullptr if the day can't be loaded
+    DayPtr get(const std::string & path);
+    // Decoded trades of the day's block. Returns nullptr if the day can't be loaded or the block is corrupted
+    BlockPtr get_block(const std::string & path, size_t block);
+
+    void set_memory_budget(size_t bytes);
+    size_t memory_usage() const;
+    size_t days_count() const;
+
+    // Drops all days that are not in use
+    void clear();
+
+private:
+    // the day itself if there is no block
+    struct LruKey
+    {
+        std::string path;
+        std::optional<size_t> block;
+    };
+
+    struct BlockEntry
+    {
+        std::shared_future<BlockPtr> trades;
+        size_t size_bytes = 0;
+        bool loaded = false;
+        std::list<LruKey>::iterator lru_it;
+    };
+
+    struct Entry
+    {
+        std::shared_future<DayPtr> day;
+        size_t size_bytes = 0;
+        bool loaded = false;
+        std::list<LruKey>::iterator lru_it;
+        std::map<size_t, BlockEntry> blocks;
+    };
+
+    void evict(std::unique_lock<std::mutex> & lock);
+    // Returns false if the day or the block is in use
+    bool try_evict(const LruKey & key);
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<std::string, Entry> m_entries;
+    std::list<LruKey> m_lru; // most recently used at the front
+    size_t m_memory_usage = 0;
+    size_t m_memory_budget = default_memory_budget;
+};
@@ -0,0 +1,228 @@
+#include "TradesFile.h"
+
+#include "Checksum.h"
+#include "Logger.h"
+#include "TradeBlockCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+uintmax_t expected_file_size(const TradesFile::Header & header)
+{
+    return sizeof(TradesFile::Header) +
+            (header.block_count * sizeof(TradesFile::BlockInfo)) +
+            header.payload_size;
+}
+
+uint64_t blocks_count_for(uint64_t count, uint64_t block_size)
+{
+    return (count + block_size - 1) / block_size;
+}
+
+bool is_consistent(const TradesFile::Header & header)
+{
+    return header.magic == TradesFile::magic &&
+            header.version == TradesFile::version &&
+            header.block_size != 0 &&
+            header.block_count == blocks_count_for(header.count, header.block_size);
+}
+
+} // namespace
+
+PublicTrade TradeColumns::at(size_t i) const
+{
+    return {std::chrono::milliseconds{timestamps[i]}, prices[i], SignedVolume{volumes[i]}};
+}
+
+void TradeColumns::push_back(const PublicTrade & trade)
+{
+    timestamps.push_back(trade.ts().count());
+    prices.push_back(trade.price());
+    volumes.push_back(trade.volume().value());
+}
+
+void TradeColumns::reserve(size_t count)
+{
+    timestamps.reserve(count);
+    prices.reserve(count);
+    volumes.reserve(count);
+}
+
+TradesDay::TradesDay(MappedFile file, uint64_t count, uint64_t block_size, uint64_t block_count)
+    : m_file(std::move(file))
+    , m_count(count)
+    , m_block_size(block_size)
+    , m_verified_blocks(std::make_unique<std::atomic_bool[]>(block_count))
+{
+    const auto data = m_file.data().subspan(sizeof(TradesFile::Header));
+    m_blocks = {reinterpret_cast<const TradesFile::BlockInfo *>(data.data()), block_count};
+    m_payload = data.subspan(m_blocks.size_bytes());
+}
+
+bool TradesDay::decode_block(size_t block, std::vector<PublicTrade> & out) const
+{
+    const size_t begin = m_blocks[block].offset;
+    const size_t end = block + 1 < m_blocks.size() ? m_blocks[block + 1].offset : m_payload.size();
+    const auto payload = m_payload.subspan(begin, end - begin);
+
+    // readers racing on the first decode both verify it, that's harmless
+    if (!m_verified_blocks[block].load(std::memory_order_acquire)) {
+        if (TradesFile::checksum(payload) != m_blocks[block].checksum) {
+            LOG_ERROR("Trades block {} checksum mismatch", block);
+            out.clear();
+            return false;
+        }
+        m_verified_blocks[block].store(true, std::memory_order_release);
+    }
+
+    const size_t count = std::min(m_block_size, m_count - (block * m_block_size));
+    TradeBlockCodec::decode(payload, count, out);
+    return true;
+}
+
+size_t TradesDay::lower_bound(std::chrono::milliseconds ts) const
+{
+    const auto block = lower_bound_block(ts);
+    if (!block.has_value()) {
+        return 0;
+    }
+
+    std::vector<PublicTrade> trades;
+    if (!decode_block(block.value(), trades)) {
+        return block.value() * m_block_size;
+    }
+    const auto trade_it = std::ranges::lower_bound(trades, ts, {}, &PublicTrade::ts);
+    return (block.value() * m_block_size) + static_cast<size_t>(trade_it - trades.begin());
+}
+
+std::optional<size_t> TradesDay::lower_bound_block(std::chrono::milliseconds ts) const
+{
+    // the only block that can start with a trade before ts and contain ts is the one before the first block starting not earlier
+    const auto block_it = std::ranges::lower_bound(m_blocks, ts.count(), {}, &TradesFile::BlockInfo::first_ts);
+    if (block_it == m_blocks.begin()) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(block_it - m_blocks.begin()) - 1;
+}
+
+uint64_t TradesFile::checksum(std::span<const BlockInfo> blocks)
+{
+    Fnv1a hash;
+    hash.update(blocks.data(), blocks.size_bytes());
+    return hash.value();
+}
+
+uint64_t TradesFile::checksum(std::span<const std::byte> block_payload)
+{
+    Fnv1a hash;
+    hash.update(block_payload.data(), block_payload.size_bytes());
+    return hash.value();
+}
+
+bool TradesFile::write(const std::filesystem::path & path, const TradeColumns & columns)
+{
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open()) {
+            LOG_ERROR("Can't open file for writing: {}", tmp_path.string());
+            return false;
+        }
+
+        std::vector<BlockInfo> blocks;
+        std::vector<std::byte> payload;
+        blocks.reserve(blocks_count_for(columns.size(), default_block_size));
+        for (size_t begin = 0; begin < columns.size(); begin += default_block_size) {
+            const size_t count = std::min<size_t>(default_block_size, columns.size() - begin);
+            const size_t offset = payload.size();
+            TradeBlockCodec::encode(
+                    std::span{columns.timestamps}.subspan(begin, count),
+                    std::span{columns.prices}.subspan(begin, count),
+                    std::span{columns.volumes}.subspan(begin, count),
+                    payload);
+            blocks.push_back({.first_ts = columns.timestamps[begin], .offset = offset, .checksum = checksum(std::span{payload}.subspan(offset))});
+        }
+
+        const Header header{
+                .magic = magic,
+                .version = version,
+                .count = columns.size(),
+                .checksum = checksum(blocks),
+                .block_size = default_block_size,
+                .block_count = blocks.size(),
+                .payload_size = payload.size(),
+        };
+        ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        ofs.write(reinterpret_cast<const char *>(blocks.data()), static_cast<std::streamsize>(std::span{blocks}.size_bytes()));
+        ofs.write(reinterpret_cast<const char *>(payload.data()), static_cast<std::streamsize>(payload.size()));
+
+        if (!ofs.good()) {
+            LOG_ERROR("Failed to write file: {}", tmp_path.string());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        LOG_ERROR("Can't rename {} to {}: {}", tmp_path.string(), path.string(), ec.message());
+        return false;
+    }
+    return true;
+}
+
+bool TradesFile::has_valid_header(const std::filesystem::path & path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+        return false;
+    }
+
+    Header header;
+    ifs.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!ifs.good() || !is_consistent(header)) {
+        return false;
+    }
+
+    std::error_code ec;
+    const auto file_size = std::filesystem::file_size(path, ec);
+    return !ec && file_size == expected_file_size(header);
+}
+
+std::optional<TradesDay> TradesFile::map(const std::filesystem::path & path)
+{
+    auto file = MappedFile::open(path);
+    if (!file.has_value()) {
+        return std::nullopt;
+    }
+
+    Header header;
+    if (file->size() < sizeof(header)) {
+        LOG_ERROR("Wrong trades file header: {}", path.string());
+        return std::nullopt;
+    }
+    std::memcpy(&header, file->data().data(), sizeof(header));
+    if (!is_consistent(header)) {
+        LOG_ERROR("Wrong trades file header: {}", path.string());
+        return std::nullopt;
+    }
+
+    if (file->size() != expected_file_size(header)) {
+        LOG_ERROR("Trades file is truncated: {}", path.string());
+        return std::nullopt;
+    }
+
+    TradesDay day{std::move(file.value()), header.count, header.block_size, header.block_count};
+    // blocks are verified when they are decoded
+    if (checksum(day.m_blocks) != header.checksum) {
+        LOG_ERROR("Trades file checksum mismatch: {}", path.string());
+        return std::nullopt;
+    }
+
+    return day;
+}
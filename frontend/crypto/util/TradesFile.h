@@ -0,0 +1,116 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "Trade.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// One day of public trades stored column by column
+struct TradeColumns
+{
+    size_t size() const { return timestamps.size(); }
+    bool empty() const { return timestamps.empty(); }
+
+    PublicTrade at(size_t i) const;
+    void push_back(const PublicTrade & trade);
+    void reserve(size_t count);
+
+    std::vector<int64_t> timestamps; // milliseconds
+    std::vector<double> prices;
+    std::vector<double> volumes; // signed, negative for sells
+};
+
+class TradesDay;
+
+/*
+ * Compressed file with a day of public trades.
+ * Layout (native byte order):
+ * | Header | BlockInfo blocks[block_count] | payload[payload_size] |
+ * Trades are split into blocks of block_size, each block is compressed by TradeBlockCodec.
+ * First timestamps of the blocks work as a sparse index.
+ * Header's checksum is FNV-1a of the block infos, it's verified on map.
+ * Every block info has FNV-1a of the block's payload, it's verified when the block is decoded the first time,
+ * so a replay of an hour doesn't read the whole day.
+ */
+class TradesFile
+{
+public:
+    static constexpr uint32_t magic = 0x44525443; // "CTRD"
+    static constexpr uint32_t version = 4;
+    static constexpr std::string_view extension = ".trades";
+    static constexpr uint64_t default_block_size = 1024;
+
+    struct Header
+    {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint64_t count = 0;
+        uint64_t checksum = 0;
+        uint64_t block_size = 0;
+        uint64_t block_count = 0;
+        uint64_t payload_size = 0;
+    };
+
+    struct BlockInfo
+    {
+        int64_t first_ts = 0;
+        uint64_t offset = 0; // in the payload
+        uint64_t checksum = 0;
+    };
+
+    // Writes to a temporary file first, so a partially written file never has the target name
+    static bool write(const std::filesystem::path & path, const TradeColumns & columns);
+
+    // Maps the file and verifies the block infos, returns nullopt on any inconsistency
+    static std::optional<TradesDay> map(const std::filesystem::path & path);
+
+    // Cheap check of the header and file size, without reading the blocks
+    static bool has_valid_header(const std::filesystem::path & path);
+
+    static uint64_t checksum(std::span<const BlockInfo> blocks);
+    static uint64_t checksum(std::span<const std::byte> block_payload);
+};
+
+// Memory mapped trades file, trades are decoded block by block
+class TradesDay
+{
+public:
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    size_t size_bytes() const { return m_file.size(); }
+
+    // Every block has block_size() trades except the last one
+    size_t block_size() const { return m_block_size; }
+    size_t blocks_count() const { return m_blocks.size(); }
+
+    // Replaces the content of 'out' with trades of the block.
+    // Returns false and leaves 'out' empty if the block is corrupted
+    bool decode_block(size_t block, std::vector<PublicTrade> & out) const;
+
+    // Index of the first trade with timestamp not less than ts, size() if there is no such trade.
+    // Looks up the block by first timestamps, so only one block is decoded.
+    // Start of the block if it's corrupted
+    size_t lower_bound(std::chrono::milliseconds ts) const;
+
+    // The only block lower_bound has to decode, nullopt if the first trade of the day is not earlier than ts
+    std::optional<size_t> lower_bound_block(std::chrono::milliseconds ts) const;
+
+private:
+    friend class TradesFile;
+    TradesDay(MappedFile file, uint64_t count, uint64_t block_size, uint64_t block_count);
+
+    MappedFile m_file;
+    size_t m_count = 0;
+    size_t m_block_size = 0;
+    std::span<const TradesFile::BlockInfo> m_blocks;
+    std::span<const std::byte> m_payload;
+    // set once the block's checksum matched, days are shared between readers
+    std::unique_ptr<std::atomic_bool[]> m_verified_blocks;
+};
@@ -0,0 +1,299 @@
+#include "BybitKlinesDownloader.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace {
+constexpr std::chrono::milliseconds day_start{1704067200000}; // 2024-01-01
+
+int64_t query_param(const std::string & url, const std::string & name)
+{
+    const auto pos = url.find("&" + name + "=");
+    return std::stoll(url.substr(pos + name.size() + 2));
+}
+} // namespace
+
+// Local stand-in of /v5/market/kline serving the klines of the map
+class BybitKlinesDownloaderTest : public testing::Test
+{
+public:
+    BybitKlinesDownloaderTest()
+        : m_dir(std::filesystem::temp_directory_path() / "bybit_klines_downloader_test")
+    {
+        std::filesystem::remove_all(m_dir);
+
+        for (int64_t i = 0; i < 2 * 24 * 60; ++i) {
+            const double open = 100. + static_cast<double>(i % 50);
+            m_klines[day_start.count() + (i * 60'000)] = {open, open + 2., open - 1., open + 0.5, 10. + static_cast<double>(i % 3)};
+        }
+    }
+
+    ~BybitKlinesDownloaderTest() override
+    {
+        std::filesystem::remove_all(m_dir);
+    }
+
+    BybitKlinesDownloader make_downloader(unsigned max_parallel_requests = 4)
+    {
+        return BybitKlinesDownloader({
+                .rest_url = "http://localhost",
+                .download_dir = m_dir.string(),
+                .max_parallel_requests = max_parallel_requests,
+                .fetch = [this](const std::string & url) { return serve(url); },
+        });
+    }
+
+    static HistoricalMDRequest make_request(std::chrono::milliseconds start = day_start, std::chrono::milliseconds end = day_start + std::chrono::hours{48})
+    {
+        return {Symbol{.symbol_name = "BTCUSDT"}, {.start = start, .end = end, .source = HistoricalMDSource::Klines}};
+    }
+
+    static std::vector<Candle> read_all(SequentialCandleReader & reader)
+    {
+        std::vector<Candle> res;
+        std::vector<Candle> batch;
+        while (reader.get_next_batch(batch, 100) > 0) {
+            res.insert(res.end(), batch.begin(), batch.end());
+        }
+        return res;
+    }
+
+protected:
+    struct Kline
+    {
+        double open;
+        double high;
+        double low;
+        double close;
+        double volume;
+    };
+
+    // called concurrently
+    std::optional<std::string> serve(const std::string & url)
+    {
+        ++m_requests_count;
+        const size_t in_flight = ++m_in_flight;
+        for (size_t max = m_max_in_flight; in_flight > max && !m_max_in_flight.compare_exchange_weak(max, in_flight);) {
+        }
+        wait_for_in_flight();
+        --m_in_flight;
+
+        if (m_fail_requests) {
+            return std::nullopt;
+        }
+
+        const auto start = query_param(url, "start");
+        const auto end = query_param(url, "end");
+        const auto limit = query_param(url, "limit");
+
+        nlohmann::json list = nlohmann::json::array();
+        for (auto it = m_klines.lower_bound(start); it != m_klines.end() && it->first <= end && std::cmp_less(list.size(), limit); ++it) {
+            const auto & [ts, k] = *it;
+            {
+                std::lock_guard lock{m_mutex};
+                if (m_dropped_once.erase(ts) > 0) {
+                    continue;
+                }
+            }
+            list.push_back({std::to_string(ts), std::to_string(k.open), std::to_string(k.high), std::to_string(k.low), std::to_string(k.close), std::to_string(k.volume), "0"});
+        }
+        // newest first, as the exchange does
+        std::ranges::reverse(list);
+
+        const nlohmann::json response = {
+                {"retCode", 0},
+                {"retMsg", "OK"},
+                {"result", {{"category", "linear"}, {"symbol", "BTCUSDT"}, {"list", list}}},
+        };
+        return response.dump();
+    }
+
+    // Requests are held until m_awaited_in_flight of them are in flight at once, then everything passes.
+    // The timeout only keeps a sequential downloader from hanging the test
+    void wait_for_in_flight()
+    {
+        std::unique_lock lock{m_mutex};
+        if (m_awaited_in_flight == 0 || m_in_flight_reached) {
+            return;
+        }
+        if (m_in_flight >= m_awaited_in_flight) {
+            m_in_flight_reached = true;
+            m_in_flight_cv.notify_all();
+            return;
+        }
+        m_in_flight_cv.wait_for(lock, std::chrono::seconds{10}, [this] { return m_in_flight_reached; });
+    }
+
+    std::filesystem::path m_dir;
+    std::map<int64_t, Kline> m_klines;
+    std::atomic<size_t> m_requests_count = 0;
+    std::atomic<bool> m_fail_requests = false;
+
+    std::atomic<size_t> m_in_flight = 0;
+    std::atomic<size_t> m_max_in_flight = 0;
+    size_t m_awaited_in_flight = 0;
+    bool m_in_flight_reached = false;
+    std::condition_variable m_in_flight_cv;
+
+    std::mutex m_mutex;
+    std::set<int64_t> m_dropped_once; // missing from the first response that should have them
+};
+
+TEST_F(BybitKlinesDownloaderTest, FetchesAndCachesDays)
+{
+    const auto candles = read_all(*make_downloader().request(make_request(), std::chrono::minutes{1}));
+
+    ASSERT_EQ(candles.size(), m_klines.size());
+    auto it = m_klines.begin();
+    for (const auto & candle : candles) {
+        EXPECT_EQ(candle.ts().count(), it->first);
+        EXPECT_EQ(candle.timeframe(), std::chrono::minutes{1});
+        EXPECT_DOUBLE_EQ(candle.open(), it->second.open);
+        EXPECT_DOUBLE_EQ(candle.high(), it->second.high);
+        EXPECT_DOUBLE_EQ(candle.low(), it->second.low);
+        EXPECT_DOUBLE_EQ(candle.close(), it->second.close);
+        EXPECT_DOUBLE_EQ(candle.volume(), it->second.volume);
+        ++it;
+    }
+    // 1440 klines a day by 1000 a page
+    EXPECT_EQ(m_requests_count, 4);
+    EXPECT_TRUE(std::filesystem::exists(m_dir / "BTCUSDT2024-01-01.klines"));
+    EXPECT_TRUE(std::filesystem::exists(m_dir / "BTCUSDT2024-01-02.klines"));
+
+    // served from disk from now on
+    m_fail_requests = true;
+    EXPECT_EQ(read_all(*make_downloader().request(make_request(), std::chrono::minutes{1})).size(), m_klines.size());
+    EXPECT_EQ(m_requests_count, 4);
+}
+
+TEST_F(BybitKlinesDownloaderTest, CoarseTimeframeReadsHourLevel)
+{
+    const auto candles = read_all(*make_downloader().request(make_request(), std::chrono::hours{4}));
+
+    ASSERT_EQ(candles.size(), 48);
+    EXPECT_EQ(candles[1].timeframe(), std::chrono::hours{1});
+    EXPECT_EQ(candles[1].ts(), day_start + std::chrono::hours{1});
+    EXPECT_DOUBLE_EQ(candles[1].open(), m_klines.at(candles[1].ts().count()).open);
+    EXPECT_DOUBLE_EQ(candles[1].close(), m_klines.at((candles[1].ts() + std::chrono::minutes{59}).count()).close);
+}
+
+TEST_F(BybitKlinesDownloaderTest, OnlyRequestedRangeIsRead)
+{
+    const auto candles = read_all(*make_downloader().request(
+            make_request(day_start + std::chrono::hours{23}, day_start + std::chrono::hours{25}),
+            std::chrono::minutes{1}));
+
+    ASSERT_EQ(candles.size(), 120);
+    EXPECT_EQ(candles.front().ts(), day_start + std::chrono::hours{23});
+    EXPECT_EQ(candles.back().ts(), day_start + std::chrono::hours{25} - std::chrono::minutes{1});
+}
+
+TEST_F(BybitKlinesDownloaderTest, FailedFetchIsNotCached)
+{
+    m_fail_requests = true;
+    EXPECT_TRUE(read_all(*make_downloader().request(make_request(), std::chrono::minutes{1})).empty());
+    EXPECT_FALSE(std::filesystem::exists(m_dir / "BTCUSDT2024-01-01.klines"));
+
+    m_fail_requests = false;
+    EXPECT_EQ(read_all(*make_downloader().request(make_request(), std::chrono::minutes{1})).size(), m_klines.size());
+}
+
+TEST_F(BybitKlinesDownloaderTest, UnfinishedDaysAreNotFetched)
+{
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
+    EXPECT_TRUE(read_all(*make_downloader().request(make_request(now - std::chrono::minutes{10}, now), std::chrono::minutes{1})).empty());
+    EXPECT_EQ(m_requests_count, 0);
+}
+
+TEST_F(BybitKlinesDownloaderTest, PagesAreFetchedConcurrentlyAndReassembledInOrder)
+{
+    for (int64_t i = 2 * 24 * 60; i < 5 * 24 * 60; ++i) {
+        m_klines[day_start.count() + (i * 60'000)] = {200., 201., 199., 200.5, 1.};
+    }
+    m_awaited_in_flight = 3;
+
+    const auto candles = read_all(*make_downloader(3).request(make_request(day_start, day_start + std::chrono::days{5}), std::chrono::minutes{1}));
+
+    EXPECT_EQ(m_requests_count, 10);
+    EXPECT_TRUE(m_in_flight_reached);
+    EXPECT_LE(m_max_in_flight, 3);
+    ASSERT_EQ(candles.size(), m_klines.size());
+    EXPECT_TRUE(std::ranges::equal(candles, m_klines, {}, [](const Candle & c) { return c.ts().count(); }, [](const auto & kline) { return kline.first; }));
+}
+
+TEST_F(BybitKlinesDownloaderTest, MissingKlinesAreRequestedAgain)
+{
+    for (const auto minute : {0, 1, 2, 700, 1439, 1440 + 999}) {
+        m_dropped_once.insert(day_start.count() + (minute * 60'000));
+    }
+
+    const auto candles = read_all(*make_downloader().request(make_request(), std::chrono::minutes{1}));
+
+    EXPECT_EQ(candles.size(), m_klines.size());
+    EXPECT_TRUE(m_dropped_once.empty());
+    // 4 pages and one request for every gap, the first 3 minutes are one gap
+    EXPECT_EQ(m_requests_count, 4 + 4);
+}
+
+TEST_F(BybitKlinesDownloaderTest, GapLongerThanPageIsRequestedByPages)
+{
+    // the first page comes back empty, the gap goes on into the second one
+    for (int64_t minute = 0; minute < 1200; ++minute) {
+        m_dropped_once.insert(day_start.count() + (minute * 60'000));
+    }
+
+    const auto candles = read_all(*make_downloader().request(make_request(), std::chrono::minutes{1}));
+
+    EXPECT_EQ(candles.size(), m_klines.size());
+    EXPECT_TRUE(m_dropped_once.empty());
+    // 4 pages and 2 for the gap of 1200 minutes
+    EXPECT_EQ(m_requests_count, 4 + 2);
+}
+
+TEST_F(BybitKlinesDownloaderTest, GapsWithoutDataAreCached)
+{
+    m_klines.erase(m_klines.begin(), m_klines.lower_bound((day_start + std::chrono::hours{10}).count()));
+
+    EXPECT_EQ(read_all(*make_downloader().request(make_request(), std::chrono::minutes{1})).size(), m_klines.size());
+    // 4 pages and the gap once more
+    EXPECT_EQ(m_requests_count, 5);
+
+    EXPECT_EQ(read_all(*make_downloader().request(make_request(), std::chrono::minutes{1})).size(), m_klines.size());
+    EXPECT_EQ(m_requests_count, 5);
+}
+
+TEST_F(BybitKlinesDownloaderTest, ParsesResponse)
+{
+    const auto klines = BybitKlinesDownloader::parse_response(
+            R"({"retCode":0,"retMsg":"OK","result":{"category":"linear","symbol":"BTCUSDT","list":[)"
+            R"(["1704067260000","42300.5","42310","42290.1","42305","12.5","528812.5"],)"
+            R"(["1704067200000","42283.5","42301","42280","42300.5","3","126850"]]}})");
+
+    ASSERT_TRUE(klines.has_value());
+    ASSERT_EQ(klines->size(), 2);
+    EXPECT_EQ(klines->front().ts, 1704067200000);
+    EXPECT_EQ(klines->front().open, 42283.5);
+    EXPECT_EQ(klines->front().buy_taker_volume, 1.5);
+    EXPECT_EQ(klines->front().sell_taker_volume, 1.5);
+    EXPECT_EQ(klines->back().close, 42305.);
+
+    EXPECT_FALSE(BybitKlinesDownloader::parse_response(R"({"retCode":10001,"retMsg":"params error","result":{}})").has_value());
+    EXPECT_FALSE(BybitKlinesDownloader::parse_response(R"({"retCode":0,"retMsg":"OK","result":{"list":[["x"]]}})").has_value());
+    EXPECT_FALSE(BybitKlinesDownloader::parse_response("<html>").has_value());
+    EXPECT_FALSE(BybitKlinesDownloader::parse_response(R"({"retCode":0,"retMsg":"OK","result":{"list":[["1","2","3","4","5","6"]]}})").has_value());
+    EXPECT_FALSE(BybitKlinesDownloader::parse_response(R"({"retCode":0,"retMsg":"OK","result":{"list":[["1","2","3","4","5","6","7"])").has_value());
+
+    const auto spaced = BybitKlinesDownloader::parse_response(R"({ "retCode" : 0, "result" : { "list" : [ [ "60000", "1", "2", "0.5", "1.5", "4", "6" ] ] } })");
+    ASSERT_TRUE(spaced.has_value());
+    ASSERT_EQ(spaced->size(), 1);
+    EXPECT_EQ(spaced->front().ts, 60000);
+    EXPECT_EQ(spaced->front().close, 1.5);
+    EXPECT_TRUE(BybitKlinesDownloader::parse_response(R"({"retCode":0,"retMsg":"OK","result":{"list":[]}})").value().empty());
+}
@@ -0,0 +1,240 @@
+#include "BybitTradesDownloader.h"
+#include "TradesDayCache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <zlib.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace {
+constexpr std::chrono::milliseconds day_start{1704067200000}; // 2024-01-01
+constexpr std::string_view csv_header = "timestamp,symbol,side,size,price,tickDirection,trdMatchID,grossValue,homeNotional,foreignNotional\n";
+} // namespace
+
+// Local directory with the same layout as public.bybit.com
+class BybitTradesDownloaderTest : public testing::Test
+{
+public:
+    BybitTradesDownloaderTest()
+        : m_dir(std::filesystem::temp_directory_path() / "bybit_trades_downloader_test")
+        , m_mirror_dir(m_dir / "mirror")
+        , m_download_dir(m_dir / "download")
+    {
+        std::filesystem::remove_all(m_dir);
+        std::filesystem::create_directories(m_mirror_dir / "trading" / "BTCUSDT");
+        TradesDayCache::i().clear();
+    }
+
+    ~BybitTradesDownloaderTest() override
+    {
+        TradesDayCache::i().clear();
+        std::filesystem::remove_all(m_dir);
+    }
+
+    void put_to_mirror(const std::string & file_name, const std::string & content, size_t truncate_by = 0)
+    {
+        const auto gz_path = m_mirror_dir / "trading" / "BTCUSDT" / (file_name + ".gz");
+        gzFile gz = gzopen(gz_path.c_str(), "wb");
+        gzwrite(gz, content.data(), static_cast<unsigned>(content.size()));
+        gzclose(gz);
+
+        if (truncate_by > 0) {
+            std::filesystem::resize_file(gz_path, std::filesystem::file_size(gz_path) - truncate_by);
+        }
+    }
+
+    BybitTradesDownloader make_downloader(bool keep_csv = false) const
+    {
+        return BybitTradesDownloader({
+                .url_base = "file://" + m_mirror_dir.string(),
+                .download_dir = m_download_dir.string(),
+                .max_parallel_downloads = 2,
+                .download_attempts = 1,
+                .keep_csv = keep_csv,
+        });
+    }
+
+    static HistoricalMDRequest make_request()
+    {
+        return {Symbol{.symbol_name = "BTCUSDT"}, {.start = day_start, .end = day_start + std::chrono::hours{48}}};
+    }
+
+    static std::vector<PublicTrade> read_all(SequentialMarketDataReader & reader)
+    {
+        std::vector<PublicTrade> res;
+        for (auto trade = reader.get_next(); trade.has_value(); trade = reader.get_next()) {
+            res.push_back(trade.value());
+        }
+        return res;
+    }
+
+protected:
+    const std::string day1_content = std::string{csv_header} +
+            "1704067200.5,BTCUSDT,Buy,0.001,42283.5,ZeroMinusTick,a,4.22835e+06,0.001,42.2835\n"
+            "1704067201.123,BTCUSDT,Sell,1.5,42283.4,MinusTick,b,6.34251e+10,1.5,63425.1\n";
+    const std::string day2_content = std::string{csv_header} +
+            "1704153600,BTCUSDT,Sell,0.2,42000,MinusTick,c,8.4e+08,0.2,8400\n";
+
+    std::filesystem::path m_dir;
+    std::filesystem::path m_mirror_dir;
+    std::filesystem::path m_download_dir;
+};
+
+TEST_F(BybitTradesDownloaderTest, DownloadsAndConvertsAllDays)
+{
+    put_to_mirror("BTCUSDT2024-01-01.csv", day1_content);
+    put_to_mirror("BTCUSDT2024-01-02.csv", day2_content);
+
+    const auto reader = make_downloader().request(make_request());
+    const auto trades = read_all(*reader);
+
+    ASSERT_EQ(trades.size(), 3);
+    EXPECT_EQ(trades[0].ts(), std::chrono::milliseconds{1704067200500});
+    EXPECT_DOUBLE_EQ(trades[0].price(), 42283.5);
+    EXPECT_DOUBLE_EQ(trades[0].volume().value(), 0.001);
+    EXPECT_EQ(trades[1].ts(), std::chrono::milliseconds{1704067201123});
+    EXPECT_DOUBLE_EQ(trades[1].volume().value(), -1.5);
+    EXPECT_EQ(trades[2].ts(), std::chrono::milliseconds{1704153600000});
+
+    for (const auto & file : {"BTCUSDT2024-01-01", "BTCUSDT2024-01-02"}) {
+        EXPECT_FALSE(std::filesystem::exists(m_download_dir / (std::string{file} + ".csv")));
+        EXPECT_FALSE(std::filesystem::exists(m_download_dir / (std::string{file} + ".csv.fnv1a")));
+        EXPECT_TRUE(std::filesystem::exists(m_download_dir / (std::string{file} + ".trades")));
+        EXPECT_TRUE(std::filesystem::exists(m_download_dir / (std::string{file} + ".candles")));
+        EXPECT_FALSE(std::filesystem::exists(m_download_dir / (std::string{file} + ".csv.tmp")));
+    }
+
+    // served from disk from now on
+    std::filesystem::remove_all(m_mirror_dir);
+    TradesDayCache::i().clear();
+    const auto second_reader = make_downloader().request(make_request());
+    EXPECT_EQ(read_all(*second_reader).size(), 3);
+}
+
+TEST_F(BybitTradesDownloaderTest, KeptCsvIsConvertedAgainWithoutDownloading)
+{
+    put_to_mirror("BTCUSDT2024-01-01.csv", day1_content);
+    put_to_mirror("BTCUSDT2024-01-02.csv", day2_content);
+
+    EXPECT_EQ(read_all(*make_downloader(true).request(make_request())).size(), 3);
+    EXPECT_TRUE(std::filesystem::exists(m_download_dir / "BTCUSDT2024-01-01.csv"));
+    EXPECT_TRUE(std::filesystem::exists(m_download_dir / "BTCUSDT2024-01-01.csv.fnv1a"));
+
+    // as after a trades file version change
+    std::filesystem::remove_all(m_mirror_dir);
+    std::filesystem::remove(m_download_dir / "BTCUSDT2024-01-01.trades");
+    TradesDayCache::i().clear();
+    EXPECT_EQ(read_all(*make_downloader(true).request(make_request())).size(), 3);
+}
+
+TEST_F(BybitTradesDownloaderTest, CandlesOfCoarsestFittingLevel)
+{
+    put_to_mirror("BTCUSDT2024-01-01.csv", day1_content);
+    put_to_mirror("BTCUSDT2024-01-02.csv", day2_content);
+
+    const auto reader = make_downloader().request_candles(make_request(), std::chrono::minutes{5});
+    std::vector<Candle> candles;
+    EXPECT_EQ(reader->get_next_batch(candles, 10), 2);
+
+    ASSERT_EQ(candles.size(), 2);
+    EXPECT_EQ(candles[0].timeframe(), std::chrono::minutes{1});
+    EXPECT_EQ(candles[0].ts(), day_start);
+    EXPECT_DOUBLE_EQ(candles[0].open(), 42283.5);
+    EXPECT_DOUBLE_EQ(candles[0].close(), 42283.4);
+    EXPECT_DOUBLE_EQ(candles[0].buy_taker_volume(), 0.001);
+    EXPECT_DOUBLE_EQ(candles[0].sell_taker_volume(), 1.5);
+    EXPECT_EQ(candles[0].trade_count(), 2);
+    EXPECT_EQ(candles[1].ts(), day_start + std::chrono::hours{24});
+    EXPECT_EQ(reader->get_next_batch(candles, 10), 0);
+}
+
+TEST_F(BybitTradesDownloaderTest, MissingCandlesAreBuiltFromTrades)
+{
+    put_to_mirror("BTCUSDT2024-01-01.csv", day1_content);
+    put_to_mirror("BTCUSDT2024-01-02.csv", day2_content);
+    EXPECT_EQ(read_all(*make_downloader().request(make_request())).size(), 3);
+
+    // as after a candles file version change
+    std::filesystem::remove_all(m_mirror_dir);
+    std::filesystem::remove(m_download_dir / "BTCUSDT2024-01-01.candles");
+    std::ofstream(m_download_dir / "BTCUSDT2024-01-02.candles") << "garbage";
+
+    std::vector<Candle> candles;
+    EXPECT_EQ(make_downloader().request_candles(make_request(), std::chrono::seconds{1})->get_next_batch(candles, 10), 3);
+}
+
+TEST_F(BybitTradesDownloaderTest, BatchesGoAcrossDays)
+{
+    put_to_mirror("BTCUSDT2024-01-01.csv", day1_content);
+    put_to_mirror("BTCUSDT2024-01-02.csv", day2_content);
+
+    const auto expected = read_all(*make_downloader().request(make_request()));
+    const auto reader = make_downloader().request(make_request());
+
+    std::vector<PublicTrade> batch;
+    std::vector<PublicTrade> trades;
+    while (reader->get_next_batch(batch, 2) > 0) {
+        EXPECT_LE(batch.size(), 2);
+        trades.insert(trades.end(), batch.begin(), batch.end());
+    }
+    EXPECT_TRUE(batch.empty());
+
+    ASSERT_EQ(trades.size(), expected.size());
+    for (size_t i = 0; i < trades.size(); ++i) {
+        EXPECT_EQ(trades[i].ts(), expected[i].ts());
+        EXPECT_EQ(trades[i].price(), expected[i].price());
+        EXPECT_EQ(trades[i].volume().value(), expected[i].volume().value());
+    }
+}
+
+TEST_F(BybitTradesDownloaderTest, RequestInTheMiddleOfDaysGetsOnlyItsTrades)
+{
+    put_to_mirror("BTCUSDT2024-01-01.csv", day1_content);
+    put_to_mirror("BTCUSDT2024-01-02.csv", day2_content);
+
+    // ends on the next day earlier than it starts on the first one
+    const HistoricalMDRequest request{
+            Symbol{.symbol_name = "BTCUSDT"},
+            {.start = day_start + std::chrono::seconds{1}, .end = day_start + std::chrono::hours{24} + std::chrono::milliseconds{1}}};
+    const auto trades = read_all(*make_downloader().request(request));
+
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[0].ts(), std::chrono::milliseconds{1704067201123});
+    EXPECT_EQ(trades[1].ts(), std::chrono::milliseconds{1704153600000});
+}
+
+TEST_F(BybitTradesDownloaderTest, BrokenDownloadIsNotKept_ResumesOnNextRequest)
+{
+    put_to_mirror("BTCUSDT2024-01-01.csv", day1_content);
+    put_to_mirror("BTCUSDT2024-01-02.csv", day2_content, 10);
+
+    const auto reader = make_downloader().request(make_request());
+    EXPECT_TRUE(read_all(*reader).empty());
+
+    EXPECT_TRUE(std::filesystem::exists(m_download_dir / "BTCUSDT2024-01-01.trades"));
+    EXPECT_FALSE(std::filesystem::exists(m_download_dir / "BTCUSDT2024-01-02.csv"));
+    EXPECT_FALSE(std::filesystem::exists(m_download_dir / "BTCUSDT2024-01-02.csv.tmp"));
+
+    // only the missing day is fetched again
+    std::filesystem::remove(m_mirror_dir / "trading" / "BTCUSDT" / "BTCUSDT2024-01-01.csv.gz");
+    put_to_mirror("BTCUSDT2024-01-02.csv", day2_content);
+
+    const auto second_reader = make_downloader().request(make_request());
+    EXPECT_EQ(read_all(*second_reader).size(), 3);
+}
+
+TEST_F(BybitTradesDownloaderTest, CsvWithoutChecksumIsDownloadedAgain)
+{
+    put_to_mirror("BTCUSDT2024-01-01.csv", day1_content);
+    put_to_mirror("BTCUSDT2024-01-02.csv", day2_content);
+
+    // leftover of an interrupted download
+    std::filesystem::create_directories(m_download_dir);
+    std::ofstream(m_download_dir / "BTCUSDT2024-01-01.csv") << csv_header << "1704067200.5,BTCUSDT,Bu";
+
+    const auto reader = make_downloader().request(make_request());
+    EXPECT_EQ(read_all(*reader).size(), 3);
+}
@@ -122,3 +122,68 @@ TEST_F(CandleBuilderTest, TwoEmptyCandlesOnBigGap)
         EXPECT_EQ(candles[1].close_ts().count(), candles[2].ts().count());
     }
 }
+
+TEST_F(CandleBuilderTest, PushTradesGivesSameCandlesAsPushTrade)
+{
+    constexpr std::chrono::milliseconds timeframe{std::chrono::seconds{10}};
+    CandleBuilder single{timeframe};
+    CandleBuilder batch{timeframe};
+
+    std::vector<PublicTrade> trades;
+    auto current_time = std::chrono::milliseconds{1739077200000};
+    for (size_t i = 0; i < 200; ++i) {
+        // a gap on every 50th trade gives some empty candles
+        current_time += std::chrono::milliseconds{i % 50 == 0 ? 25'000 : 700};
+        trades.emplace_back(current_time, 100. + static_cast<double>(i % 13), SignedVolume{i % 3 == 0 ? -1. : 2.});
+    }
+
+    std::vector<Candle> expected;
+    for (const auto & trade : trades) {
+        const auto candles = single.push_trade(trade.price(), trade.volume(), trade.ts());
+        expected.insert(expected.end(), candles.begin(), candles.end());
+    }
+
+    std::vector<Candle> candles;
+    const std::span<const PublicTrade> all{trades};
+    batch.push_trades(all.subspan(0, 77), candles);
+    batch.push_trades(all.subspan(77), candles);
+
+    ASSERT_EQ(candles.size(), expected.size());
+    for (size_t i = 0; i < candles.size(); ++i) {
+        EXPECT_EQ(candles[i].ts(), expected[i].ts());
+        EXPECT_EQ(candles[i].open(), expected[i].open());
+        EXPECT_EQ(candles[i].high(), expected[i].high());
+        EXPECT_EQ(candles[i].low(), expected[i].low());
+        EXPECT_EQ(candles[i].close(), expected[i].close());
+        EXPECT_EQ(candles[i].buy_taker_volume(), expected[i].buy_taker_volume());
+        EXPECT_EQ(candles[i].sell_taker_volume(), expected[i].sell_taker_volume());
+        EXPECT_EQ(candles[i].trade_count(), expected[i].trade_count());
+    }
+}
+
+TEST_F(CandleBuilderTest, FirstClosingIndex)
+{
+    constexpr std::chrono::milliseconds timeframe{std::chrono::seconds{10}};
+    CandleBuilder cb{timeframe};
+
+    const auto open_ts = std::chrono::milliseconds{1739077200000};
+    const std::vector<PublicTrade> trades{
+            PublicTrade{open_ts + std::chrono::seconds{11}, 1., SignedVolume{1.}},
+            PublicTrade{open_ts + std::chrono::seconds{12}, 1., SignedVolume{1.}},
+            PublicTrade{open_ts + std::chrono::seconds{25}, 1., SignedVolume{1.}},
+            PublicTrade{open_ts + std::chrono::seconds{26}, 1., SignedVolume{1.}},
+    };
+
+    // the very first trade opens a candle, but doesn't close anything
+    EXPECT_EQ(cb.first_closing_index(trades), 2);
+    EXPECT_EQ(cb.first_closing_index(std::span{trades}.subspan(0, 2)), 2);
+
+    std::vector<Candle> candles;
+    cb.push_trades(std::span{trades}.subspan(0, 2), candles);
+    EXPECT_TRUE(candles.empty());
+
+    EXPECT_EQ(cb.first_closing_index(std::span{trades}.subspan(2)), 0);
+    cb.push_trades(std::span{trades}.subspan(2, 1), candles);
+    EXPECT_EQ(candles.size(), 1);
+    EXPECT_EQ(cb.first_closing_index(std::span{trades}.subspan(3)), 1);
+}
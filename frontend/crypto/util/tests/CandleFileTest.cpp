@@ -0,0 +1,156 @@
+#include "CandleBuiler.h"
+#include "CandleFile.h"
+#include "TradesFile.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+class CandleFileTest : public testing::Test
+{
+public:
+    CandleFileTest()
+        : m_dir(std::filesystem::temp_directory_path() / "candle_file_test")
+    {
+        std::filesystem::create_directories(m_dir);
+
+        // ~3 hours with gaps of several seconds
+        for (size_t i = 0; i < 30000; ++i) {
+            const auto ts = m_start + std::chrono::milliseconds{(i * 350) + ((i / 1000) * 7000)};
+            const double price = 100. + (5. * std::sin(static_cast<double>(i) / 300.)) + (static_cast<double>(i % 13) * 0.01);
+            m_trades.push_back(PublicTrade{ts, price, SignedVolume{(i % 3 == 0) ? -0.25 : 0.1}});
+        }
+    }
+
+    ~CandleFileTest() override
+    {
+        std::filesystem::remove_all(m_dir);
+    }
+
+    std::filesystem::path write_candles(const std::string & name) const
+    {
+        const auto trades_path = m_dir / (name + ".trades");
+        const auto candles_path = m_dir / (name + ".candles");
+
+        TradeColumns columns;
+        for (const auto & trade : m_trades) {
+            columns.push_back(trade);
+        }
+        EXPECT_TRUE(TradesFile::write(trades_path, columns));
+        const auto day = TradesFile::map(trades_path);
+        EXPECT_TRUE(day.has_value());
+        EXPECT_TRUE(CandleFile::write(candles_path, day.value()));
+        return candles_path;
+    }
+
+protected:
+    const std::chrono::milliseconds m_start{1704067200000};
+    std::filesystem::path m_dir;
+    std::vector<PublicTrade> m_trades;
+};
+
+TEST_F(CandleFileTest, LevelsAreBuiltFromTrades)
+{
+    const auto path = write_candles("levels");
+    EXPECT_TRUE(CandleFile::has_valid_header(path));
+    EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+    const auto day = CandleFile::map(path);
+    ASSERT_TRUE(day.has_value());
+    ASSERT_EQ(day->levels_count(), CandleFile::levels.size());
+
+    for (size_t level = 0; level < day->levels_count(); ++level) {
+        EXPECT_EQ(day->level_timeframe(level), CandleFile::levels[level]);
+
+        const auto expected = CandleFile::build_level(m_trades, CandleFile::levels[level]);
+        const auto candles = day->candles(level);
+        // coarser levels sum the volumes of the finer ones, so the rounding differs
+        ASSERT_EQ(candles.size(), expected.size());
+        for (size_t i = 0; i < candles.size(); ++i) {
+            EXPECT_EQ(candles[i].ts, expected[i].ts);
+            EXPECT_EQ(candles[i].open, expected[i].open);
+            EXPECT_EQ(candles[i].high, expected[i].high);
+            EXPECT_EQ(candles[i].low, expected[i].low);
+            EXPECT_EQ(candles[i].close, expected[i].close);
+            EXPECT_NEAR(candles[i].buy_taker_volume, expected[i].buy_taker_volume, 1e-9);
+            EXPECT_NEAR(candles[i].sell_taker_volume, expected[i].sell_taker_volume, 1e-9);
+            EXPECT_EQ(candles[i].trades_count, expected[i].trades_count);
+        }
+    }
+
+    // empty seconds are not stored
+    EXPECT_LT(day->candles(0).size(), static_cast<size_t>((m_trades.back().ts() - m_start) / std::chrono::seconds{1}));
+    EXPECT_EQ(day->candles(2).size(), 3);
+}
+
+TEST_F(CandleFileTest, LevelForTimeframe)
+{
+    const auto day = CandleFile::map(write_candles("level_for"));
+    ASSERT_TRUE(day.has_value());
+
+    EXPECT_EQ(day->level_for(std::chrono::seconds{1}), 0);
+    EXPECT_EQ(day->level_for(std::chrono::seconds{5}), 0);
+    EXPECT_EQ(day->level_for(std::chrono::seconds{90}), 0);
+    EXPECT_EQ(day->level_for(std::chrono::minutes{1}), 1);
+    EXPECT_EQ(day->level_for(std::chrono::minutes{15}), 1);
+    EXPECT_EQ(day->level_for(std::chrono::hours{4}), 2);
+    EXPECT_FALSE(day->level_for(std::chrono::milliseconds{1500}).has_value());
+}
+
+// strategy gets the same candles as it builds them from trades
+TEST_F(CandleFileTest, CandlesFromLevelAreSameAsFromTrades)
+{
+    const auto day = CandleFile::map(write_candles("same_as_trades"));
+    ASSERT_TRUE(day.has_value());
+
+    for (const auto timeframe : {std::chrono::milliseconds{std::chrono::seconds{5}}, std::chrono::milliseconds{std::chrono::minutes{15}}}) {
+        CandleBuilder from_trades_builder{timeframe};
+        std::vector<Candle> from_trades;
+        from_trades_builder.push_trades(m_trades, from_trades);
+
+        const size_t level = day->level_for(timeframe).value();
+        CandleBuilder from_level_builder{timeframe};
+        std::vector<Candle> from_level;
+        for (const auto & record : day->candles(level)) {
+            from_level_builder.push_candle(record.to_candle(day->level_timeframe(level)), from_level);
+        }
+
+        ASSERT_GT(from_trades.size(), 5);
+        ASSERT_EQ(from_level.size(), from_trades.size());
+        for (size_t i = 0; i < from_trades.size(); ++i) {
+            EXPECT_EQ(from_level[i].ts(), from_trades[i].ts());
+            EXPECT_EQ(from_level[i].timeframe(), timeframe);
+            EXPECT_EQ(from_level[i].open(), from_trades[i].open());
+            EXPECT_EQ(from_level[i].high(), from_trades[i].high());
+            EXPECT_EQ(from_level[i].low(), from_trades[i].low());
+            EXPECT_EQ(from_level[i].close(), from_trades[i].close());
+            EXPECT_NEAR(from_level[i].buy_taker_volume(), from_trades[i].buy_taker_volume(), 1e-9);
+            EXPECT_NEAR(from_level[i].sell_taker_volume(), from_trades[i].sell_taker_volume(), 1e-9);
+            EXPECT_EQ(from_level[i].trade_count(), from_trades[i].trade_count());
+        }
+    }
+}
+
+TEST_F(CandleFileTest, CorruptedFileIsRejected)
+{
+    const auto path = write_candles("corrupted");
+    const auto size = std::filesystem::file_size(path);
+
+    {
+        std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+        fs.seekp(static_cast<std::streamoff>(size - 3));
+        fs.put('\x7f');
+    }
+    EXPECT_TRUE(CandleFile::has_valid_header(path));
+    EXPECT_FALSE(CandleFile::map(path).has_value());
+
+    std::filesystem::resize_file(path, size - sizeof(CandleRecord));
+    EXPECT_FALSE(CandleFile::has_valid_header(path));
+    EXPECT_FALSE(CandleFile::map(path).has_value());
+
+    EXPECT_FALSE(CandleFile::has_valid_header(m_dir / "missing.candles"));
+    EXPECT_FALSE(CandleFile::map(m_dir / "missing.candles").has_value());
+}
@@ -0,0 +1,42 @@
+#include "CandlePath.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+std::vector<double> path_prices(const Candle & candle, CandlePathModel model)
+{
+    std::vector<double> res;
+    for (size_t i = 0; i < CandlePath::points_count; ++i) {
+        res.push_back(CandlePath::point(candle, i, model).price());
+    }
+    return res;
+}
+} // namespace
+
+TEST(CandlePathTest, ExtremesOrder)
+{
+    const Candle rising{std::chrono::seconds{60}, std::chrono::minutes{1}, 10., 15., 5., 12., 1., 1., 2};
+    const Candle falling{std::chrono::seconds{60}, std::chrono::minutes{1}, 12., 15., 5., 10., 1., 1., 2};
+
+    EXPECT_EQ(path_prices(rising, CandlePathModel::ByDirection), (std::vector<double>{10., 5., 15., 12.}));
+    EXPECT_EQ(path_prices(falling, CandlePathModel::ByDirection), (std::vector<double>{12., 15., 5., 10.}));
+    EXPECT_EQ(path_prices(rising, CandlePathModel::OpenHighLowClose), (std::vector<double>{10., 15., 5., 12.}));
+    EXPECT_EQ(path_prices(falling, CandlePathModel::OpenLowHighClose), (std::vector<double>{12., 5., 15., 10.}));
+}
+
+TEST(CandlePathTest, PointsStayInsideOfCandle)
+{
+    const Candle candle{std::chrono::seconds{60}, std::chrono::minutes{1}, 10., 15., 5., 12., 1., 1., 2};
+
+    std::chrono::milliseconds prev_ts{0};
+    for (size_t i = 0; i < CandlePath::points_count; ++i) {
+        const auto point = CandlePath::point(candle, i, CandlePathModel::ByDirection);
+        EXPECT_GE(point.ts(), candle.ts());
+        EXPECT_LT(point.ts(), candle.close_ts());
+        EXPECT_GT(point.ts(), prev_ts);
+        EXPECT_EQ(point.volume().value(), 0.);
+        prev_ts = point.ts();
+    }
+    EXPECT_EQ(prev_ts, candle.close_ts() - std::chrono::milliseconds{1});
+}
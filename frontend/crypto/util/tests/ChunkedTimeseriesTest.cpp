@@ -0,0 +1,135 @@
+#include "ChunkedTimeseries.h"
+#include "EventLoop.h"
+#include "EventLoopSubscriber.h"
+#include "EventTimeseriesChannel.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <future>
+
+namespace test {
+using namespace testing;
+
+namespace {
+std::vector<std::pair<std::chrono::milliseconds, int>> to_vector(const TimeseriesSnapshot<int> & snapshot)
+{
+    return {snapshot.begin(), snapshot.end()};
+}
+
+std::vector<std::pair<std::chrono::milliseconds, int>> make_values(int from, int to)
+{
+    std::vector<std::pair<std::chrono::milliseconds, int>> res;
+    for (int i = from; i < to; ++i) {
+        res.emplace_back(std::chrono::milliseconds{i}, i);
+    }
+    return res;
+}
+} // namespace
+
+TEST(ChunkedTimeseriesTest, SnapshotDoesntSeeLaterChanges)
+{
+    ChunkedTimeseries<int> timeseries{4};
+    for (int i = 0; i < 10; ++i) {
+        timeseries.push_back(std::chrono::milliseconds{i}, i);
+    }
+
+    const auto snapshot = timeseries.snapshot();
+
+    for (int i = 10; i < 20; ++i) {
+        timeseries.push_back(std::chrono::milliseconds{i}, i);
+    }
+    timeseries.trim_before(std::chrono::milliseconds{15});
+
+    EXPECT_EQ(snapshot.size(), 10);
+    EXPECT_EQ(snapshot.front().second, 0);
+    EXPECT_EQ(snapshot.back().second, 9);
+    EXPECT_EQ(to_vector(snapshot), make_values(0, 10));
+
+    EXPECT_EQ(timeseries.size(), 5);
+    EXPECT_EQ(to_vector(timeseries.snapshot()), make_values(15, 20));
+}
+
+TEST(ChunkedTimeseriesTest, TrimOnEveryPushKeepsTimeWindow)
+{
+    ChunkedTimeseries<int> timeseries{4};
+    constexpr int window = 6;
+    for (int i = 0; i < 100; ++i) {
+        timeseries.trim_before(std::chrono::milliseconds{i - window});
+        timeseries.push_back(std::chrono::milliseconds{i}, i);
+
+        const int first = std::max(0, i - window);
+        ASSERT_EQ(timeseries.size(), static_cast<size_t>(i - first + 1));
+        ASSERT_EQ(timeseries.front().second, first);
+        ASSERT_EQ(timeseries.back().second, i);
+        ASSERT_EQ(to_vector(timeseries.snapshot()), make_values(first, i + 1));
+    }
+}
+
+TEST(ChunkedTimeseriesTest, SnapshotIsReadWhileTailChunkGrows)
+{
+    ChunkedTimeseries<int> timeseries{1024};
+    for (int i = 0; i < 10; ++i) {
+        timeseries.push_back(std::chrono::milliseconds{i}, i);
+    }
+    const auto snapshot = timeseries.snapshot();
+
+    auto read = std::async(std::launch::async, [&] {
+        for (size_t n = 0; n < 1000; ++n) {
+            if (to_vector(snapshot) != make_values(0, 10)) {
+                return false;
+            }
+        }
+        return true;
+    });
+    // same chunk the snapshot reads from
+    for (int i = 10; i < 1000; ++i) {
+        timeseries.push_back(std::chrono::milliseconds{i}, i);
+    }
+
+    EXPECT_TRUE(read.get());
+    EXPECT_EQ(to_vector(timeseries.snapshot()), make_values(0, 1000));
+}
+
+TEST(ChunkedTimeseriesTest, EmptySnapshot)
+{
+    ChunkedTimeseries<int> timeseries{4};
+    timeseries.push_back(std::chrono::milliseconds{1}, 1);
+    timeseries.trim_before(std::chrono::milliseconds{2});
+
+    const auto snapshot = timeseries.snapshot();
+    EXPECT_TRUE(snapshot.empty());
+    EXPECT_EQ(snapshot.begin(), snapshot.end());
+}
+
+TEST(ChunkedTimeseriesTest, SubscriberGetsHistorySnapshotThenUpdates)
+{
+    EventLoop event_loop;
+    EventTimeseriesChannel<int> channel;
+    channel.set_capacity(std::chrono::milliseconds{1500});
+    for (int i = 0; i < 3000; ++i) {
+        channel.push(std::chrono::milliseconds{i}, i);
+    }
+
+    std::promise<EventTimeseriesChannel<int>::Snapshot> snapshot_promise;
+    std::promise<int> update_promise;
+    {
+        EventSubcriber sub{event_loop};
+        sub.subscribe(
+                channel,
+                [&](const EventTimeseriesChannel<int>::Snapshot & snapshot) {
+                    snapshot_promise.set_value(snapshot);
+                },
+                [&](std::chrono::milliseconds, const int & value) {
+                    update_promise.set_value(value);
+                });
+        channel.push(std::chrono::milliseconds{3000}, 3000);
+
+        EXPECT_EQ(update_promise.get_future().get(), 3000);
+    }
+
+    const auto snapshot = snapshot_promise.get_future().get();
+    EXPECT_EQ(to_vector(snapshot), make_values(1499, 3000));
+    EXPECT_EQ(to_vector(channel.snapshot()), make_values(1500, 3001));
+}
+} // namespace test
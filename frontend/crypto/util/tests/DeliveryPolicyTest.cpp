@@ -0,0 +1,148 @@
+#include "DeliveryPolicy.h"
+
+#include "EventChannel.h"
+#include "EventLoop.h"
+#include "EventLoopSubscriber.h"
+#include "EventTimeseriesChannel.h"
+
+#include <gtest/gtest.h>
+
+namespace test {
+
+class DeliveryPolicyTest : public testing::Test
+{
+protected:
+    std::shared_ptr<VirtualClock> clock = std::make_shared<VirtualClock>();
+    Scheduler scheduler{clock};
+    EventLoop el{EventLoopMode::CallerDriven, scheduler};
+    EventSubcriber sub{el};
+    EventChannel<int> ch;
+};
+
+TEST_F(DeliveryPolicyTest, LatestReplacesNotDeliveredValues)
+{
+    std::vector<int> every;
+    std::vector<int> latest;
+    sub.subscribe(ch, [&](int v) { every.push_back(v); });
+    sub.subscribe(ch, [&](int v) { latest.push_back(v); }, delivery::Latest{});
+
+    for (int i = 1; i <= 100; ++i) {
+        ch.push(i);
+    }
+    el.run_until([&] { return !el.has_pending_events(); });
+    EXPECT_EQ(every.size(), 100);
+    EXPECT_EQ(latest, (std::vector<int>{100}));
+
+    ch.push(101);
+    el.run_until([&] { return !el.has_pending_events(); });
+    EXPECT_EQ(latest, (std::vector<int>{100, 101}));
+}
+
+TEST_F(DeliveryPolicyTest, BatchesAreLimitedBySize)
+{
+    std::vector<std::vector<int>> batches;
+    sub.subscribe(
+            ch,
+            [&](std::span<const int> batch) { batches.emplace_back(batch.begin(), batch.end()); },
+            delivery::Batched{.max_size = 4});
+
+    for (int i = 0; i < 10; ++i) {
+        ch.push(i);
+    }
+    el.run_until([&] { return !el.has_pending_events(); });
+
+    ASSERT_EQ(batches.size(), 3);
+    EXPECT_EQ(batches[0], (std::vector<int>{0, 1, 2, 3}));
+    EXPECT_EQ(batches[1], (std::vector<int>{4, 5, 6, 7}));
+    EXPECT_EQ(batches[2], (std::vector<int>{8, 9}));
+}
+
+TEST_F(DeliveryPolicyTest, BurstAtStalledConsumerKeepsLatestBatches)
+{
+    std::vector<std::vector<int>> batches;
+    sub.subscribe(
+            ch,
+            [&](std::span<const int> batch) { batches.emplace_back(batch.begin(), batch.end()); },
+            delivery::Batched{.max_size = 4, .max_closed = 2});
+
+    // nothing is run while the burst comes
+    for (int i = 0; i < 1000; ++i) {
+        ch.push(i);
+    }
+    el.run_until([&] { return !el.has_pending_events(); });
+
+    ASSERT_EQ(batches.size(), 2);
+    EXPECT_EQ(batches[0], (std::vector<int>{992, 993, 994, 995}));
+    EXPECT_EQ(batches[1], (std::vector<int>{996, 997, 998, 999}));
+}
+
+TEST_F(DeliveryPolicyTest, BatchesAreLimitedByDelay)
+{
+    std::vector<std::vector<int>> batches;
+    sub.subscribe(
+            ch,
+            [&](std::span<const int> batch) { batches.emplace_back(batch.begin(), batch.end()); },
+            delivery::Batched{.max_size = 100, .max_delay = std::chrono::milliseconds{10}});
+
+    ch.push(1);
+    scheduler.advance(std::chrono::milliseconds{5});
+    ch.push(2);
+    EXPECT_FALSE(el.has_pending_events());
+
+    scheduler.advance(std::chrono::milliseconds{5});
+    el.run_until([&] { return !el.has_pending_events(); });
+    ASSERT_EQ(batches.size(), 1);
+    EXPECT_EQ(batches[0], (std::vector<int>{1, 2}));
+
+    ch.push(3);
+    EXPECT_TRUE(scheduler.advance_to_next_event());
+    el.run_until([&] { return !el.has_pending_events(); });
+    ASSERT_EQ(batches.size(), 2);
+    EXPECT_EQ(batches[1], (std::vector<int>{3}));
+}
+
+TEST_F(DeliveryPolicyTest, TimeseriesBatchesFollowTheSnapshot)
+{
+    EventTimeseriesChannel<int> ts_ch;
+    ts_ch.push(std::chrono::milliseconds{1}, 1);
+
+    std::vector<std::pair<std::chrono::milliseconds, int>> received;
+    sub.subscribe(
+            ts_ch,
+            [&](const EventTimeseriesChannel<int>::Snapshot & snapshot) {
+                for (const auto & item : snapshot) {
+                    received.push_back(item);
+                }
+            },
+            [&](std::span<const EventTimeseriesChannel<int>::Item> batch) {
+                EXPECT_EQ(batch.size(), 2);
+                received.insert(received.end(), batch.begin(), batch.end());
+            },
+            delivery::Batched{});
+
+    ts_ch.push(std::chrono::milliseconds{2}, 2);
+    ts_ch.push(std::chrono::milliseconds{3}, 3);
+    el.run_until([&] { return !el.has_pending_events(); });
+
+    const std::vector<std::pair<std::chrono::milliseconds, int>> expected{
+            {std::chrono::milliseconds{1}, 1},
+            {std::chrono::milliseconds{2}, 2},
+            {std::chrono::milliseconds{3}, 3}};
+    EXPECT_EQ(received, expected);
+}
+
+TEST_F(DeliveryPolicyTest, NothingIsDeliveredAfterSubscriberIsGone)
+{
+    size_t calls = 0;
+    {
+        EventSubcriber other_sub{el};
+        other_sub.subscribe(ch, [&](int) { ++calls; }, delivery::Latest{});
+        other_sub.subscribe(ch, [&](std::span<const int>) { ++calls; }, delivery::Batched{});
+        ch.push(1);
+    }
+    ch.push(2);
+    el.run_until([&] { return !el.has_pending_events(); });
+    EXPECT_EQ(calls, 0);
+}
+
+} // namespace test
@@ -0,0 +1,101 @@
+#include "EventLoopStats.h"
+
+#include "EventChannel.h"
+#include "EventLoop.h"
+#include "EventLoopSubscriber.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <typeinfo>
+
+namespace test {
+
+class EventLoopStatsTest : public testing::Test
+{
+protected:
+    std::shared_ptr<VirtualClock> clock = std::make_shared<VirtualClock>();
+    Scheduler scheduler{clock};
+    EventLoop el{EventLoopMode::CallerDriven, scheduler};
+    EventSubcriber sub{el};
+    EventChannel<int> ch;
+};
+
+TEST_F(EventLoopStatsTest, NothingIsRecordedWhenDisabled)
+{
+    sub.subscribe(ch, [](int) {});
+    ch.push(1);
+    el.run_until([&] { return !el.has_pending_events(); });
+
+    const auto snapshot = el.stats().snapshot();
+    EXPECT_TRUE(snapshot.handlers.empty());
+    EXPECT_EQ(snapshot.dispatch_latency[static_cast<size_t>(Priority::Normal)].count, 0);
+}
+
+TEST_F(EventLoopStatsTest, QueueDepthAndHandlersAreCounted)
+{
+    el.stats().set_enabled(true);
+    sub.subscribe(ch, [](int) { std::this_thread::sleep_for(std::chrono::milliseconds{1}); });
+    sub.subscribe(ch, [](int) {}, Priority::High);
+
+    for (int i = 0; i < 3; ++i) {
+        ch.push(i);
+    }
+    auto snapshot = el.stats().snapshot();
+    EXPECT_EQ(snapshot.queue_depth[static_cast<size_t>(Priority::Normal)], 3);
+    EXPECT_EQ(snapshot.queue_depth[static_cast<size_t>(Priority::High)], 3);
+
+    el.run_until([&] { return !el.has_pending_events(); });
+    snapshot = el.stats().snapshot();
+    EXPECT_EQ(snapshot.queue_depth[static_cast<size_t>(Priority::Normal)], 0);
+    EXPECT_EQ(snapshot.dispatch_latency[static_cast<size_t>(Priority::Normal)].count, 3);
+    EXPECT_EQ(snapshot.dispatch_latency[static_cast<size_t>(Priority::High)].count, 3);
+
+    // both subscriptions are of one subscriber and one channel type
+    ASSERT_EQ(snapshot.handlers.size(), 1);
+    const auto & [key, histogram] = *snapshot.handlers.begin();
+    EXPECT_EQ(key.subscriber, sub.token().id());
+    EXPECT_EQ(histogram.count, 6);
+    EXPECT_GE(histogram.max, std::chrono::milliseconds{1});
+    EXPECT_GE(histogram.quantile(1.), std::chrono::milliseconds{1});
+
+    const auto json = el.stats().to_json();
+    ASSERT_EQ(json["handlers"].size(), 1);
+    EXPECT_EQ(json["handlers"][0]["source"], "EventChannel<int>");
+    EXPECT_EQ(json["handlers"][0]["count"], 6);
+}
+
+TEST(EventLoopStatsKeyTest, SourcesAreComparedByName)
+{
+    // one type named at two addresses, as by two libraries
+    const std::string first = typeid(EventChannel<int>).name();
+    const std::string second = first;
+    ASSERT_NE(first.data(), second.data());
+
+    EventLoopStats stats;
+    stats.on_executed(Priority::Normal, {1, first}, {}, std::chrono::microseconds{1});
+    stats.on_executed(Priority::Normal, {1, second}, {}, std::chrono::microseconds{1});
+
+    const auto snapshot = stats.snapshot();
+    ASSERT_EQ(snapshot.handlers.size(), 1);
+    EXPECT_EQ(snapshot.handlers.begin()->second.count, 2);
+}
+
+TEST_F(EventLoopStatsTest, DroppedEventsLeaveTheQueueDepth)
+{
+    el.stats().set_enabled(true);
+    {
+        EventSubcriber other_sub{el};
+        other_sub.subscribe(ch, [](int) {});
+        ch.push(1);
+    }
+    EXPECT_EQ(el.stats().snapshot().queue_depth[static_cast<size_t>(Priority::Normal)], 1);
+
+    el.run_until([&] { return !el.has_pending_events(); });
+    const auto snapshot = el.stats().snapshot();
+    EXPECT_EQ(snapshot.queue_depth[static_cast<size_t>(Priority::Normal)], 0);
+    EXPECT_TRUE(snapshot.handlers.empty());
+}
+
+} // namespace test
@@ -8,6 +8,9 @@
 #include <gtest/gtest.h>
 
 #include <atomic>
+#include <functional>
+#include <future>
+#include <numeric>
 
 namespace test {
 using namespace testing;
@@ -105,6 +108,240 @@ TEST_F(EventLoopTest, UnsubWithEventsInLoop)
 // TEST_F(EventLoopTest, UnsubWithEventsKeepOneSub)
 // TEST_F(EventLoopTest, UnsubWithEventsDelayedEvent)
 
-// TODO add test for delayed events
+TEST_F(EventLoopTest, DelayedEvent)
+{
+    EventChannel<int> ch;
+    std::atomic_int value = 0;
+    EventSubcriber sub{el};
+    sub.subscribe(ch, [&](int v) { value = v; });
+
+    const auto start = std::chrono::steady_clock::now();
+    ch.push_delayed(1, std::chrono::milliseconds{50});
+    while (value == 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds{5}) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    EXPECT_EQ(value, 1);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{50});
+}
+
+class VirtualClockEventLoopTest : public Test
+{
+protected:
+    std::shared_ptr<VirtualClock> clock = std::make_shared<VirtualClock>();
+    Scheduler scheduler{clock};
+    EventLoop el{EventLoopMode::CallerDriven, scheduler};
+};
+
+TEST_F(VirtualClockEventLoopTest, DelayedEventsFireWhenTheirTimeComes)
+{
+    EventChannel<int> ch;
+    std::vector<int> values;
+    EventSubcriber sub{el};
+    sub.subscribe(ch, [&](int v) { values.push_back(v); });
+
+    ch.push_delayed(2, std::chrono::seconds{10});
+    ch.push_delayed(1, std::chrono::seconds{5});
+
+    scheduler.advance(std::chrono::milliseconds{4999});
+    EXPECT_FALSE(el.has_pending_events());
+
+    scheduler.advance(std::chrono::milliseconds{1});
+    el.run_until([&] { return values.size() == 1; });
+    EXPECT_FALSE(el.has_pending_events());
+
+    scheduler.advance(std::chrono::hours{1});
+    el.run_until([&] { return values.size() == 2; });
+    EXPECT_EQ(values, (std::vector<int>{1, 2}));
+    EXPECT_FALSE(scheduler.advance_to_next_event());
+}
+
+// Like ping checks of gateways, every check schedules the next one
+TEST_F(VirtualClockEventLoopTest, PeriodicTimerRunsWithoutWaiting)
+{
+    constexpr std::chrono::seconds ping_interval{5};
+    EventChannel<PingCheckEvent> ch;
+    size_t checks_count = 0;
+    EventSubcriber sub{el};
+    sub.subscribe(ch, [&](const PingCheckEvent &) {
+        ++checks_count;
+        ch.push_delayed(PingCheckEvent{}, ping_interval);
+    });
+    ch.push_delayed(PingCheckEvent{}, ping_interval);
+
+    const auto start = clock->now();
+    const size_t checks_in_a_day = std::chrono::days{1} / ping_interval;
+    for (size_t i = 1; i <= checks_in_a_day; ++i) {
+        ASSERT_TRUE(scheduler.advance_to_next_event());
+        el.run_until([&] { return checks_count == i; });
+    }
+    EXPECT_EQ(clock->now() - start, std::chrono::days{1});
+}
+
+TEST_F(VirtualClockEventLoopTest, DelayedEventsOfDestroyedLoopAreDropped)
+{
+    EventChannel<int> ch;
+    size_t events_count = 0;
+    {
+        EventLoop other_el{EventLoopMode::CallerDriven, scheduler};
+        EventSubcriber sub{other_el};
+        sub.subscribe(ch, [&](int) { ++events_count; });
+        ch.push_delayed(1, std::chrono::seconds{1});
+    }
+
+    EXPECT_TRUE(scheduler.advance_to_next_event());
+    EXPECT_EQ(events_count, 0);
+    EXPECT_FALSE(el.has_pending_events());
+}
+
+TEST_F(VirtualClockEventLoopTest, EventsOfDestroyedSubscriberAreSkipped)
+{
+    EventChannel<int> ch;
+    size_t kept_count = 0;
+    size_t destroyed_count = 0;
+
+    EventSubcriber kept_sub{el};
+    kept_sub.subscribe(ch, [&](int) { ++kept_count; });
+    {
+        EventSubcriber sub{el};
+        sub.subscribe(ch, [&](int) { ++destroyed_count; });
+        ch.push(1);
+        ch.push(2);
+        ch.push_delayed(3, std::chrono::seconds{1});
+    }
+
+    el.run_until([&] { return kept_count == 2; });
+    EXPECT_TRUE(scheduler.advance_to_next_event());
+    el.run_until([&] { return kept_count == 3; });
+    // stale events are popped as usual and not executed
+    el.run_until([&] { return !el.has_pending_events(); });
+    EXPECT_EQ(destroyed_count, 0);
+}
+
+TEST(SubscriberTokenTest, ReusedSlotDoesNotReviveReleasedToken)
+{
+    EXPECT_TRUE(SubscriberToken{}.is_alive());
+
+    const auto token = SubscriberToken::acquire();
+    EXPECT_TRUE(token.is_alive());
+    token.release();
+    EXPECT_FALSE(token.is_alive());
+
+    const auto next = SubscriberToken::acquire();
+    EXPECT_TRUE(next.is_alive());
+    EXPECT_NE(next, token);
+    EXPECT_FALSE(token.is_alive());
+    next.release();
+}
+
+TEST(PooledEventLoopTest, LoopsShareThreadsAndKeepTheirOrder)
+{
+    constexpr size_t loops_count = 50;
+    constexpr int events_per_loop = 200;
+
+    ThreadPool pool{2};
+    std::vector<std::unique_ptr<EventLoop>> loops;
+    std::vector<std::unique_ptr<EventSubcriber>> subs;
+    std::vector<std::vector<int>> received(loops_count);
+    std::vector<std::atomic_int> running(loops_count);
+    std::atomic_bool overlapped = false;
+
+    EventChannel<int> ch;
+    for (size_t i = 0; i < loops_count; ++i) {
+        loops.push_back(std::make_unique<EventLoop>(EventLoopMode::Pooled, Scheduler::i(), &pool));
+        subs.push_back(std::make_unique<EventSubcriber>(*loops.back()));
+        subs.back()->subscribe(ch, [&, i](int v) {
+            if (running[i].fetch_add(1) != 0) {
+                overlapped = true;
+            }
+            received[i].push_back(v);
+            running[i].fetch_sub(1);
+        });
+    }
+
+    for (int v = 0; v < events_per_loop; ++v) {
+        ch.push(v);
+    }
+    for (auto & el : loops) {
+        EventChannel<BarrierEvent> barrier_channel;
+        EventBarrier eb{*el, barrier_channel};
+        eb.wait();
+    }
+
+    EXPECT_FALSE(overlapped);
+    std::vector<int> expected(events_per_loop);
+    std::iota(expected.begin(), expected.end(), 0);
+    for (const auto & values : received) {
+        EXPECT_EQ(values, expected);
+    }
+
+    subs.clear();
+    loops.clear();
+}
+
+TEST(PooledEventLoopTest, StopsAfterTheRunningEvent)
+{
+    ThreadPool pool{1};
+    std::atomic_size_t executed = 0;
+    std::atomic_bool started = false;
+    {
+        EventLoop el{EventLoopMode::Pooled, Scheduler::i(), &pool};
+        for (size_t i = 0; i < 3; ++i) {
+            el.push(LambdaEvent{
+                    SubscriberToken{},
+                    [&] {
+                        started = true;
+                        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+                        ++executed;
+                    },
+                    Priority::Normal});
+        }
+        while (!started) {
+            std::this_thread::yield();
+        }
+    }
+    EXPECT_EQ(executed, 1);
+}
+
+TEST(PooledEventLoopTest, DestroyedWhileStrandIsRunning)
+{
+    ThreadPool pool{2};
+    std::atomic_size_t executed = 0;
+    for (size_t i = 0; i < 200; ++i) {
+        // outlives the loop, events still run while it stops
+        std::function<void()> push_next;
+        EventLoop el{EventLoopMode::Pooled, Scheduler::i(), &pool};
+        // every event pushes the next one, the strand is busy when the loop is destroyed
+        push_next = [&] {
+            ++executed;
+            el.push(LambdaEvent{SubscriberToken{}, push_next, Priority::Normal});
+        };
+        for (size_t j = 0; j < 4; ++j) {
+            el.push(LambdaEvent{SubscriberToken{}, push_next, Priority::Normal});
+        }
+    }
+    EXPECT_GT(executed, 0);
+}
+
+TEST(PooledEventLoopTest, StopFromOwnEventDoesNotWait)
+{
+    ThreadPool pool{1};
+    std::atomic_size_t executed = 0;
+    std::promise<void> stopped;
+    BasicEventLoop el{EventLoopMode::Pooled, &pool};
+    ILambdaAcceptor & acceptor = el;
+    acceptor.push(LambdaEvent{
+            SubscriberToken{},
+            [&] {
+                el.stop();
+                ++executed;
+                stopped.set_value();
+            },
+            Priority::Normal});
+    acceptor.push(LambdaEvent{SubscriberToken{}, [&] { ++executed; }, Priority::Normal});
+
+    ASSERT_EQ(stopped.get_future().wait_for(std::chrono::seconds{5}), std::future_status::ready);
+    el.stop();
+    EXPECT_EQ(executed, 1);
+}
 
 } // namespace test
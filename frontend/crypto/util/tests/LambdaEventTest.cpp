@@ -0,0 +1,270 @@
+#include "EventChannel.h"
+#include "EventLoop.h"
+#include "EventLoopSubscriber.h"
+#include "EventObjectChannel.h"
+#include "Events.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+// counts allocations of all threads while enabled
+namespace {
+std::atomic_bool g_count_allocations = false;
+std::atomic<size_t> g_allocations = 0;
+
+// every form of new and delete goes through this pair. Out of line, so the compiler can't match an inlined free with a new
+[[gnu::noinline]] void * counted_alloc(std::size_t size, std::size_t alignment) noexcept
+{
+    if (g_count_allocations.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    size = std::max<std::size_t>(size, 1);
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return std::malloc(size);
+    }
+    // size of aligned_alloc has to be a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+[[gnu::noinline]] void counted_free(void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void * counted_alloc_or_throw(std::size_t size, std::size_t alignment)
+{
+    if (void * ptr = counted_alloc(size, alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+} // namespace
+
+void * operator new(std::size_t size)
+{
+    return counted_alloc_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void * operator new[](std::size_t size)
+{
+    return counted_alloc_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void * operator new(std::size_t size, std::align_val_t alignment)
+{
+    return counted_alloc_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void * operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return counted_alloc_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return counted_alloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return counted_alloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void * operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return counted_alloc(size, static_cast<std::size_t>(alignment));
+}
+
+void * operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return counted_alloc(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void * ptr) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete(void * ptr, std::align_val_t) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void * ptr, std::align_val_t) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t, std::align_val_t) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t, std::align_val_t) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete(void * ptr, const std::nothrow_t &) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void * ptr, const std::nothrow_t &) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete(void * ptr, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void * ptr, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    counted_free(ptr);
+}
+
+namespace test {
+using namespace testing;
+
+TEST(InplaceFunctionTest, SmallCallableIsInline_BigIsOnHeap)
+{
+    size_t calls = 0;
+    auto small = [&calls, price = 1., ts = std::chrono::milliseconds{1}] { calls += static_cast<size_t>(price) + ts.count(); };
+    std::array<char, 128> big_capture = {};
+    auto big = [&calls, big_capture] { calls += big_capture.size(); };
+
+    static_assert(LambdaEvent::Func::is_inline<decltype(small)>);
+    static_assert(!LambdaEvent::Func::is_inline<decltype(big)>);
+
+    LambdaEvent::Func small_func = small;
+    LambdaEvent::Func big_func = big;
+    small_func();
+    big_func();
+    EXPECT_EQ(calls, 130);
+}
+
+TEST(InplaceFunctionTest, MoveTransfersOwnership)
+{
+    const auto token = std::make_shared<int>(1);
+    size_t calls = 0;
+    {
+        LambdaEvent::Func func = [token, &calls] { ++calls; };
+        EXPECT_EQ(token.use_count(), 2);
+
+        LambdaEvent::Func moved = std::move(func);
+        EXPECT_FALSE(static_cast<bool>(func));
+        EXPECT_EQ(token.use_count(), 2);
+
+        moved();
+        EXPECT_EQ(calls, 1);
+
+        LambdaEvent::Func assigned;
+        assigned = std::move(moved);
+        assigned();
+        EXPECT_EQ(calls, 2);
+        EXPECT_EQ(token.use_count(), 2);
+    }
+    EXPECT_EQ(token.use_count(), 1);
+}
+
+TEST(InplaceFunctionTest, PassesArgumentsAndResult)
+{
+    const std::string suffix = "_suffix";
+    InplaceFunction<32, size_t(std::string &)> append = [&suffix](std::string & out) {
+        out += suffix;
+        return out.size();
+    };
+
+    std::string str = "str";
+    EXPECT_EQ(append(str), 10);
+    EXPECT_EQ(str, "str_suffix");
+}
+
+// Pushes go in bursts that fit into the queue's ring, a longer burst spills into the overflow list which allocates
+class LambdaEventAllocationTest : public Test
+{
+protected:
+    static constexpr size_t burst_size = 256;
+    static constexpr size_t bursts_count = 40;
+
+    void wait_for(size_t count)
+    {
+        while (m_received.load() < count) {
+            std::this_thread::yield();
+        }
+    }
+
+    EventLoop m_event_loop;
+    std::atomic<size_t> m_received = 0;
+};
+
+TEST_F(LambdaEventAllocationTest, PriceEventsAreDeliveredWithoutAllocations)
+{
+    EventChannel<HistoricalMDPriceEvent> channel;
+    EventSubcriber sub{m_event_loop};
+    double price_sum = 0.;
+    sub.subscribe(channel, [&](const HistoricalMDPriceEvent & ev) {
+        price_sum += ev.public_trade.price();
+        ++m_received;
+    });
+
+    const HistoricalMDPriceEvent ev{PublicTrade{std::chrono::milliseconds{1}, 1., SignedVolume{1.}}};
+    channel.push(ev);
+    wait_for(1);
+
+    g_allocations = 0;
+    g_count_allocations = true;
+    for (size_t burst = 0; burst < bursts_count; ++burst) {
+        for (size_t i = 0; i < burst_size; ++i) {
+            channel.push(ev);
+        }
+        wait_for(1 + (burst + 1) * burst_size);
+    }
+    g_count_allocations = false;
+
+    EXPECT_EQ(g_allocations.load(), 0);
+    EXPECT_DOUBLE_EQ(price_sum, 1 + bursts_count * burst_size);
+}
+
+TEST_F(LambdaEventAllocationTest, ObjectUpdatesAreDeliveredWithoutAllocations)
+{
+    EventObjectChannel<double> channel;
+    EventSubcriber sub{m_event_loop};
+    sub.subscribe(channel, [&](double) { ++m_received; });
+
+    g_allocations = 0;
+    g_count_allocations = true;
+    for (size_t burst = 0; burst < bursts_count; ++burst) {
+        for (size_t i = 0; i < burst_size; ++i) {
+            channel.push(static_cast<double>(i));
+        }
+        wait_for((burst + 1) * burst_size);
+    }
+    g_count_allocations = false;
+
+    EXPECT_EQ(g_allocations.load(), 0);
+}
+} // namespace test
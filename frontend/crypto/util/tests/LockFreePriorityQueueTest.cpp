@@ -0,0 +1,129 @@
+#include "LockFreePriorityQueue.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+struct Item
+{
+    Priority priority() const { return m_priority; }
+
+    size_t producer = 0;
+    size_t seq_num = 0;
+    Priority m_priority = Priority::Normal;
+};
+} // namespace
+
+class LockFreePriorityQueueTest : public testing::Test
+{
+protected:
+    // small rings to get to the overflow path quickly
+    LockFreePriorityQueue<Item, 8> m_queue;
+};
+
+TEST_F(LockFreePriorityQueueTest, PopsByPriorityThenByPushOrder)
+{
+    m_queue.push({.producer = 0, .seq_num = 0, .m_priority = Priority::Low});
+    m_queue.push({.producer = 0, .seq_num = 1, .m_priority = Priority::Barrier});
+    m_queue.push({.producer = 0, .seq_num = 2, .m_priority = Priority::Normal});
+    m_queue.push({.producer = 0, .seq_num = 3, .m_priority = Priority::High});
+    m_queue.push({.producer = 0, .seq_num = 4, .m_priority = Priority::Normal});
+
+    std::vector<size_t> popped;
+    while (m_queue.has_pending_events()) {
+        popped.push_back(m_queue.wait_and_pop()->seq_num);
+    }
+    EXPECT_EQ(popped, (std::vector<size_t>{3, 2, 4, 0, 1}));
+    EXPECT_FALSE(m_queue.try_pop().has_value());
+}
+
+TEST_F(LockFreePriorityQueueTest, OverflowKeepsOrder)
+{
+    constexpr size_t count = 100;
+    for (size_t i = 0; i < count; ++i) {
+        m_queue.push({.producer = 0, .seq_num = i});
+
+        // consumer interleaves, so the ring gets free slots while overflow is not drained yet
+        if (i % 7 == 0) {
+            m_queue.try_pop();
+        }
+    }
+
+    std::optional<size_t> last;
+    while (auto item = m_queue.try_pop()) {
+        if (last.has_value()) {
+            EXPECT_GT(item->seq_num, last.value());
+        }
+        last = item->seq_num;
+    }
+    EXPECT_EQ(last, count - 1);
+}
+
+TEST_F(LockFreePriorityQueueTest, ManyProducers_EachProducerOrderIsKept)
+{
+    constexpr size_t producers_count = 4;
+    constexpr size_t items_per_producer = 20000;
+
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < producers_count; ++p) {
+        producers.emplace_back([this, p] {
+            for (size_t i = 0; i < items_per_producer; ++i) {
+                m_queue.push({.producer = p, .seq_num = i});
+            }
+        });
+    }
+
+    std::vector<size_t> next_expected(producers_count, 0);
+    for (size_t i = 0; i < producers_count * items_per_producer; ++i) {
+        const auto item = m_queue.wait_and_pop();
+        ASSERT_TRUE(item.has_value());
+        ASSERT_EQ(item->seq_num, next_expected[item->producer]);
+        ++next_expected[item->producer];
+    }
+
+    for (auto & t : producers) {
+        t.join();
+    }
+    EXPECT_FALSE(m_queue.has_pending_events());
+}
+
+TEST_F(LockFreePriorityQueueTest, BarrierIsNotPoppedBeforeValuesPushedEarlier)
+{
+    constexpr size_t count = 20000;
+
+    std::thread producer([this] {
+        for (size_t i = 0; i < count; ++i) {
+            m_queue.push({.producer = 0, .seq_num = i, .m_priority = Priority::Normal});
+            m_queue.push({.producer = 1, .seq_num = i, .m_priority = Priority::Barrier});
+        }
+    });
+
+    size_t normal_popped = 0;
+    for (size_t i = 0; i < count * 2; ++i) {
+        const auto item = m_queue.wait_and_pop();
+        ASSERT_TRUE(item.has_value());
+        if (item->producer == 0) {
+            ++normal_popped;
+        }
+        else {
+            ASSERT_LT(item->seq_num, normal_popped);
+        }
+    }
+    producer.join();
+}
+
+TEST_F(LockFreePriorityQueueTest, StopWakesParkedConsumer)
+{
+    std::thread consumer([this] {
+        EXPECT_FALSE(m_queue.wait_and_pop().has_value());
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    m_queue.stop();
+    consumer.join();
+
+    EXPECT_FALSE(m_queue.push({}));
+}
@@ -0,0 +1,132 @@
+#include "Logger.h"
+
+#include "EventChannel.h"
+#include "EventLoop.h"
+#include "EventLoopSubscriber.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace test {
+
+// Collects what the logger prints
+class LoggerTest : public testing::Test
+{
+protected:
+    LoggerTest()
+    {
+        Logger::flush();
+        m_cout_buf = std::cout.rdbuf(m_output.rdbuf());
+    }
+
+    ~LoggerTest() override
+    {
+        Logger::flush();
+        std::cout.rdbuf(m_cout_buf);
+    }
+
+    std::string output()
+    {
+        Logger::flush();
+        return m_output.str();
+    }
+
+    std::stringstream m_output;
+    std::streambuf * m_cout_buf = nullptr;
+};
+
+TEST_F(LoggerTest, ArgumentsAreCapturedWhenLogged)
+{
+    std::string str = "before";
+    double value = 1.5;
+    LOG_INFO("str: {}, value: {}", str, value);
+    str = "after";
+    value = 2.5;
+
+    const auto out = output();
+    EXPECT_NE(out.find("[Info]: str: before, value: 1.5\n"), std::string::npos) << out;
+}
+
+namespace {
+struct Point
+{
+    int x = 0;
+    int y = 0;
+};
+
+std::thread::id point_printed_on;
+
+std::ostream & operator<<(std::ostream & os, const Point & point)
+{
+    point_printed_on = std::this_thread::get_id();
+    return os << point.x << ":" << point.y;
+}
+} // namespace
+
+TEST_F(LoggerTest, TriviallyCopyableArgumentsArePrintedByWriter)
+{
+    Point point{1, 2};
+    LOG_INFO("point: {}", point);
+    point.x = 3;
+
+    const auto out = output();
+    EXPECT_NE(out.find("[Info]: point: 1:2\n"), std::string::npos) << out;
+    EXPECT_NE(point_printed_on, std::this_thread::get_id());
+}
+
+TEST_F(LoggerTest, ThreadLevelOverridesGlobalOne)
+{
+    {
+        ScopedLogLevel level{LogLevel::Warning};
+        LOG_INFO("suppressed");
+        std::thread([] { LOG_INFO("other thread"); }).join();
+    }
+    LOG_INFO("restored");
+
+    const auto out = output();
+    EXPECT_EQ(out.find("suppressed"), std::string::npos) << out;
+    EXPECT_NE(out.find("other thread"), std::string::npos) << out;
+    EXPECT_NE(out.find("restored"), std::string::npos) << out;
+}
+
+TEST_F(LoggerTest, EventsRunWithLevelOfTheirLoop)
+{
+    auto clock = std::make_shared<VirtualClock>();
+    Scheduler scheduler{clock};
+    EventLoop el{EventLoopMode::CallerDriven, scheduler};
+    EventSubcriber sub{el};
+    EventChannel<int> ch;
+    sub.subscribe(ch, [](int v) { LOG_INFO("event {}", v); });
+
+    el.set_log_level(LogLevel::Warning);
+    ch.push(1);
+    el.run_until([&] { return !el.has_pending_events(); });
+    LOG_INFO("outside of the loop");
+
+    el.set_log_level(std::nullopt);
+    ch.push(2);
+    el.run_until([&] { return !el.has_pending_events(); });
+
+    const auto out = output();
+    EXPECT_EQ(out.find("event 1"), std::string::npos) << out;
+    EXPECT_NE(out.find("outside of the loop"), std::string::npos) << out;
+    EXPECT_NE(out.find("event 2"), std::string::npos) << out;
+}
+
+TEST_F(LoggerTest, NothingIsLostWhenRingIsFull)
+{
+    constexpr size_t count = 10'000;
+    for (size_t i = 0; i < count; ++i) {
+        LOG_DEBUG("record {}", i);
+    }
+
+    const auto out = output();
+    EXPECT_EQ(std::count(out.begin(), out.end(), '\n'), count);
+    EXPECT_NE(out.find("record 9999\n"), std::string::npos);
+}
+
+} // namespace test
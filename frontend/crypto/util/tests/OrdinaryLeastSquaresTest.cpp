@@ -74,3 +74,46 @@ TEST_F(OLSTest, Converters)
     EXPECT_DOUBLE_EQ(cf(expected_zero.first), expected_zero.second);
     EXPECT_DOUBLE_EQ(cf(expected_fut.first), expected_fut.second);
 }
+
+TEST_F(OLSTest, IncrementalMatchesBatch)
+{
+    std::vector<OLS::Point> data;
+    OLS::IncrementalSolver solver;
+    for (int i = 0; i < 10; ++i) {
+        const OLS::Point p{.x = static_cast<double>(i + 1), .y = static_cast<double>((i * 7) % 5) + i * 0.5};
+        data.push_back(p);
+        solver.push(p);
+
+        const auto expected = OLS::solve(data);
+        const auto f = solver.solve();
+        EXPECT_NEAR(f.k, expected.k, 1e-12);
+        EXPECT_NEAR(f.c, expected.c, 1e-12);
+        EXPECT_NEAR(solver.deviation(), OLS::deviation(expected, data), 1e-12);
+    }
+}
+
+TEST_F(OLSTest, IncrementalPricesMatchBatch)
+{
+    std::vector<std::pair<std::chrono::milliseconds, double>> prices;
+    OLS::IncrementalPriceSolver solver;
+
+    // depo-like series: a year of small steps around a trend
+    std::chrono::milliseconds ts{1743796573'222};
+    double depo = 0.;
+    for (size_t i = 0; i < 20000; ++i) {
+        ts += std::chrono::milliseconds{1'577'000 + static_cast<int>(i % 13) * 1000};
+        depo += 0.01 + (static_cast<double>(i % 17) - 8.) * 0.1;
+        prices.emplace_back(ts, depo);
+        solver.push(ts, depo);
+    }
+
+    const auto [expected_reg, expected_dev] = OLS::solve_prices(prices);
+    const auto [reg, dev] = solver.solve();
+
+    const auto last_ts = prices.back().first;
+    EXPECT_NEAR(reg(last_ts), expected_reg(last_ts), 1e-6);
+    EXPECT_NEAR(reg(prices.front().first), expected_reg(prices.front().first), 1e-6);
+    EXPECT_NEAR(dev, expected_dev, 1e-9 * expected_dev);
+    EXPECT_EQ(solver.first_ts(), prices.front().first);
+    EXPECT_EQ(solver.last_ts(), last_ts);
+}
@@ -0,0 +1,105 @@
+#include "EventChannel.h"
+#include "SubscriberList.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+namespace test {
+
+TEST(SubscriberListTest, AddAndRemove)
+{
+    SubscriberList<int> list;
+    EXPECT_EQ(list.add(1), 1);
+    EXPECT_EQ(list.add(2), 2);
+    EXPECT_EQ(list.add(3), 3);
+    EXPECT_EQ(list.remove_if([](int v) { return v == 2; }), 2);
+    EXPECT_EQ(list.remove_if([](int v) { return v == 5; }), 2);
+
+    std::vector<int> values;
+    list.for_each([&](int v) { values.push_back(v); });
+    EXPECT_EQ(values, (std::vector<int>{1, 3}));
+
+    values.clear();
+    list.clear([&](int v) { values.push_back(v); });
+    EXPECT_EQ(values, (std::vector<int>{1, 3}));
+    EXPECT_EQ(list.size(), 0);
+}
+
+TEST(SubscriberListTest, RemovedIsNotSeenAfterRemoval)
+{
+    SubscriberList<std::shared_ptr<std::atomic_bool>> list;
+    std::atomic_bool running = true;
+    std::atomic_size_t seen_removed = 0;
+
+    std::vector<std::thread> publishers;
+    for (size_t i = 0; i < 3; ++i) {
+        publishers.emplace_back([&] {
+            while (running) {
+                list.for_each([&](const std::shared_ptr<std::atomic_bool> & removed) {
+                    if (*removed) {
+                        ++seen_removed;
+                    }
+                });
+            }
+        });
+    }
+
+    for (size_t i = 0; i < 1000; ++i) {
+        auto removed = std::make_shared<std::atomic_bool>(false);
+        list.add(removed);
+        list.remove_if([&](const auto & item) { return item == removed; });
+        *removed = true;
+    }
+
+    running = false;
+    for (auto & t : publishers) {
+        t.join();
+    }
+    EXPECT_EQ(seen_removed, 0);
+}
+
+class CountingConsumer : public ILambdaAcceptor
+{
+public:
+    void push(LambdaEvent) override { ++events_count; }
+
+    std::atomic_size_t events_count = 0;
+};
+
+TEST(SubscriberListTest, NoEventsAfterUnsubscribeDuringPublishing)
+{
+    EventChannel<int> channel;
+    CountingConsumer consumer;
+    std::atomic_bool running = true;
+
+    std::vector<std::thread> publishers;
+    for (size_t i = 0; i < 3; ++i) {
+        publishers.emplace_back([&] {
+            while (running) {
+                channel.push(1);
+            }
+        });
+    }
+
+    for (size_t i = 0; i < 20; ++i) {
+        auto sub = channel.subscribe(consumer, SubscriberToken{}, [](int) {});
+        while (consumer.events_count == 0) {
+            std::this_thread::yield();
+        }
+        sub.reset();
+
+        consumer.events_count = 0;
+        // a publisher in the middle of a push would be seen here
+        std::this_thread::sleep_for(std::chrono::microseconds{100});
+        ASSERT_EQ(consumer.events_count, 0);
+    }
+
+    running = false;
+    for (auto & t : publishers) {
+        t.join();
+    }
+}
+
+} // namespace test
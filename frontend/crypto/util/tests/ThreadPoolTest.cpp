@@ -0,0 +1,72 @@
+#include "ThreadPool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+namespace test {
+
+TEST(ThreadPoolTest, RunsTasksOfAnyThread)
+{
+    std::atomic_size_t executed = 0;
+    {
+        ThreadPool pool{3};
+        EXPECT_EQ(pool.threads_count(), 3);
+        for (size_t i = 0; i < 1000; ++i) {
+            // tasks of workers go to their own queues and are stolen by the others
+            pool.submit([&] {
+                pool.submit([&] { ++executed; });
+                ++executed;
+            });
+        }
+    }
+    EXPECT_EQ(executed, 2000);
+}
+
+TEST(ThreadPoolTest, IdleWorkerStealsFromBusyOne)
+{
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::promise<void> stolen;
+    // destroyed first, the blocked worker can still be in released.wait()
+    ThreadPool pool{2};
+
+    pool.submit([&] {
+        // lands in this worker's queue, which is blocked until the other worker takes it
+        pool.submit([&] { stolen.set_value(); });
+        released.wait();
+    });
+
+    EXPECT_EQ(stolen.get_future().wait_for(std::chrono::seconds{5}), std::future_status::ready);
+    release.set_value();
+}
+
+TEST(ThreadPoolTest, WorkerRunsOwnTasksNewestFirst)
+{
+    std::vector<int> order;
+    {
+        ThreadPool pool{1};
+        pool.submit([&] {
+            pool.submit([&] { order.push_back(1); });
+            pool.submit([&] { order.push_back(2); });
+            // gave up its turn, goes behind the others
+            pool.resubmit([&] { order.push_back(3); });
+            pool.submit([&] { order.push_back(4); });
+        });
+    }
+    EXPECT_EQ(order, (std::vector<int>{4, 2, 1, 3}));
+}
+
+TEST(ThreadPoolTest, ParkedWorkersAreWoken)
+{
+    ThreadPool pool{4};
+    for (size_t i = 0; i < 1000; ++i) {
+        std::promise<void> executed;
+        pool.submit([&] { executed.set_value(); });
+        ASSERT_EQ(executed.get_future().wait_for(std::chrono::seconds{5}), std::future_status::ready) << i;
+    }
+}
+
+} // namespace test
@@ -0,0 +1,77 @@
+#include "TimingWheel.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace test {
+
+TEST(TimingWheelTest, FiresUpToTheTickInOrder)
+{
+    TimingWheel<int64_t> wheel;
+    std::mt19937_64 gen{42};
+    std::vector<int64_t> ticks;
+    for (int64_t max_tick : {int64_t{300}, int64_t{1} << 17, int64_t{1} << 25, int64_t{1} << 34}) {
+        std::uniform_int_distribution<int64_t> dist{1, max_tick};
+        for (size_t i = 0; i < 1000; ++i) {
+            ticks.push_back(dist(gen));
+            wheel.insert(ticks.back(), ticks.back());
+        }
+    }
+    std::ranges::sort(ticks);
+    ASSERT_EQ(wheel.size(), ticks.size());
+
+    std::vector<int64_t> fired;
+    int64_t target = 0;
+    while (!wheel.empty()) {
+        target = target * 3 / 2 + 7;
+        wheel.advance(target, [&](int64_t tick) {
+            EXPECT_LE(tick, target);
+            fired.push_back(tick);
+        });
+        EXPECT_EQ(wheel.current_tick(), target);
+
+        // the rest is later
+        const auto next = wheel.next_tick();
+        EXPECT_EQ(next.has_value(), !wheel.empty());
+        EXPECT_TRUE(!next.has_value() || next.value() > target);
+    }
+    EXPECT_EQ(fired, ticks);
+}
+
+TEST(TimingWheelTest, SameTickFiresInInsertionOrder)
+{
+    TimingWheel<int> wheel;
+    // waits in the second level
+    wheel.insert(1000, 1);
+    wheel.advance(900, [](int) { FAIL(); });
+    // goes straight to the first level
+    wheel.insert(1000, 2);
+    wheel.insert(1000, 3);
+
+    std::vector<int> fired;
+    wheel.advance(1000, [&](int v) { fired.push_back(v); });
+    EXPECT_EQ(fired, (std::vector<int>{1, 2, 3}));
+}
+
+TEST(TimingWheelTest, PassedTicksFireAtNextAdvance)
+{
+    TimingWheel<int> wheel{500};
+    wheel.insert(100, 1);
+    wheel.insert(500, 2);
+    EXPECT_EQ(wheel.next_tick(), 500);
+
+    std::vector<int> fired;
+    wheel.advance(500, [&](int v) {
+        fired.push_back(v);
+        if (v == 1) {
+            // inserted from a callback
+            wheel.insert(500, 3);
+        }
+    });
+    EXPECT_EQ(fired, (std::vector<int>{1, 2, 3}));
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_FALSE(wheel.next_tick().has_value());
+}
+
+} // namespace test
@@ -0,0 +1,91 @@
+#include "Tracer.h"
+
+#include "EventChannel.h"
+#include "EventLoop.h"
+#include "EventLoopSubscriber.h"
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+namespace test {
+
+class TracerTest : public testing::Test
+{
+protected:
+    ~TracerTest() override
+    {
+        Tracer::i().stop();
+        std::filesystem::remove(m_path);
+    }
+
+    nlohmann::json read_trace() const
+    {
+        std::ifstream file(m_path);
+        return nlohmann::json::parse(file);
+    }
+
+    void publish_and_dispatch(int value)
+    {
+        ch.push(value);
+        el.run_until([&] { return !el.has_pending_events(); });
+    }
+
+    const std::filesystem::path m_path = std::filesystem::temp_directory_path() / "tracer_test.json";
+
+    std::shared_ptr<VirtualClock> clock = std::make_shared<VirtualClock>();
+    Scheduler scheduler{clock};
+    EventLoop el{EventLoopMode::CallerDriven, scheduler};
+    EventSubcriber sub{el};
+    EventChannel<int> ch;
+};
+
+TEST_F(TracerTest, DispatchIsLinkedToPublish)
+{
+    sub.subscribe(ch, [](int) {});
+    ASSERT_TRUE(Tracer::i().start(m_path.string()));
+    publish_and_dispatch(1);
+    Tracer::i().stop();
+
+    std::optional<uint64_t> flow_start, flow_end;
+    size_t publishes = 0;
+    size_t dispatches = 0;
+    for (const auto & record : read_trace()) {
+        const auto phase = record["ph"].get<std::string>();
+        if (phase == "s") {
+            flow_start = record["id"].get<uint64_t>();
+        }
+        else if (phase == "f") {
+            flow_end = record["id"].get<uint64_t>();
+        }
+        else if (phase == "X" && record["name"] == "publish") {
+            EXPECT_EQ(record["args"]["type"], "EventChannel<int>");
+            ++publishes;
+        }
+        else if (phase == "X" && record["name"] == "dispatch") {
+            EXPECT_EQ(record["args"]["type"], "EventChannel<int>");
+            ++dispatches;
+        }
+    }
+    EXPECT_EQ(publishes, 1);
+    EXPECT_EQ(dispatches, 1);
+    ASSERT_TRUE(flow_start.has_value());
+    EXPECT_EQ(flow_start, flow_end);
+}
+
+TEST_F(TracerTest, NothingIsRecordedWhileStopped)
+{
+    sub.subscribe(ch, [](int) {});
+    ASSERT_TRUE(Tracer::i().start(m_path.string()));
+    Tracer::i().stop();
+    publish_and_dispatch(1);
+
+    ASSERT_TRUE(Tracer::i().start(m_path.string()));
+    Tracer::i().stop();
+    EXPECT_TRUE(read_trace().empty());
+    EXPECT_EQ(Tracer::i().dropped_count(), 0);
+}
+
+} // namespace test
@@ -0,0 +1,77 @@
+#include "TradesCsvParser.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+TEST(TradesCsvParserTest, TimestampWithAnyPrecision)
+{
+    EXPECT_EQ(TradesCsvParser::parse_timestamp("1712967661"), 1712967661000);
+    EXPECT_EQ(TradesCsvParser::parse_timestamp("1712967661."), 1712967661000);
+    EXPECT_EQ(TradesCsvParser::parse_timestamp("1712967661.6"), 1712967661600);
+    EXPECT_EQ(TradesCsvParser::parse_timestamp("1712967661.67"), 1712967661670);
+    EXPECT_EQ(TradesCsvParser::parse_timestamp("1712967661.675"), 1712967661675);
+    EXPECT_EQ(TradesCsvParser::parse_timestamp("1712967661.675999"), 1712967661675);
+    EXPECT_EQ(TradesCsvParser::parse_timestamp("1712967661.067"), 1712967661067);
+
+    EXPECT_FALSE(TradesCsvParser::parse_timestamp("").has_value());
+    EXPECT_FALSE(TradesCsvParser::parse_timestamp("17129e7661").has_value());
+    EXPECT_FALSE(TradesCsvParser::parse_timestamp("1712967661.6x").has_value());
+}
+
+TEST(TradesCsvParserTest, ParsesTrades)
+{
+    const std::string_view csv =
+            "1704067200.5,BTCUSDT,Buy,0.001,42283.5,ZeroMinusTick,a,4.22835e+06,0.001,42.2835\n"
+            "1704067201.123,BTCUSDT,Sell,1.5,42283.4,MinusTick,b,6.34251e+10,1.5,63425.1\r\n"
+            "\n"
+            "1704153600,BTCUSDT,Sell,0.2,42000,MinusTick,c,8.4e+08,0.2,8400";
+
+    const auto columns = TradesCsvParser::parse(csv);
+    ASSERT_TRUE(columns.has_value());
+    EXPECT_EQ(columns->timestamps, (std::vector<int64_t>{1704067200500, 1704067201123, 1704153600000}));
+    EXPECT_EQ(columns->prices, (std::vector<double>{42283.5, 42283.4, 42000.}));
+    EXPECT_EQ(columns->volumes, (std::vector<double>{0.001, -1.5, -0.2}));
+}
+
+TEST(TradesCsvParserTest, NumbersAreSameAsStod)
+{
+    std::string csv;
+    std::vector<double> expected;
+    for (int i = 0; i < 1000; ++i) {
+        const std::string price = std::to_string(40000 + (i * 7)) + "." + std::to_string(i % 10) + std::to_string(i % 7);
+        csv += "1704067200.5,BTCUSDT,Buy,0.001," + price + ",ZeroMinusTick,a,1,1,1\n";
+        expected.push_back(std::stod(price));
+    }
+
+    const auto columns = TradesCsvParser::parse(csv);
+    ASSERT_TRUE(columns.has_value());
+    EXPECT_EQ(columns->prices, expected);
+}
+
+TEST(TradesCsvParserTest, MalformedLineFailsWholeFile)
+{
+    EXPECT_FALSE(TradesCsvParser::parse("1704067200.5,BTCUSDT,Bu").has_value());
+    EXPECT_FALSE(TradesCsvParser::parse("1704067200.5,BTCUSDT,Buy,0.001,").has_value());
+    EXPECT_FALSE(TradesCsvParser::parse("1704067200.5,BTCUSDT,Hold,0.001,42283.5,ZeroMinusTick").has_value());
+    EXPECT_FALSE(TradesCsvParser::parse("1704067200.5,BTCUSDT,Buy,-0.001,42283.5,ZeroMinusTick").has_value());
+    EXPECT_FALSE(TradesCsvParser::parse("1704067200.5,BTCUSDT,Buy,0.001,42283.5x,ZeroMinusTick").has_value());
+}
+
+TEST(TradesCsvParserTest, FileHeaderIsSkipped)
+{
+    const auto path = std::filesystem::temp_directory_path() / "trades_csv_parser_test.csv";
+    std::ofstream(path) << "timestamp,symbol,side,size,price,tickDirection,trdMatchID,grossValue,homeNotional,foreignNotional\n"
+                        << "1704067200.5,BTCUSDT,Buy,0.001,42283.5,ZeroMinusTick,a,4.22835e+06,0.001,42.2835\n";
+
+    const auto columns = TradesCsvParser::parse_file(path);
+    std::filesystem::remove(path);
+
+    ASSERT_TRUE(columns.has_value());
+    ASSERT_EQ(columns->size(), 1);
+    EXPECT_EQ(columns->timestamps.front(), 1704067200500);
+
+    EXPECT_FALSE(TradesCsvParser::parse_file(path).has_value());
+}
@@ -0,0 +1,381 @@
+#include "BybitTradesDownloader.h"
+#include "TradesDayCache.h"
+#include "TradesFile.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+class TradesFileTest : public testing::Test
+{
+public:
+    TradesFileTest()
+        : m_dir(std::filesystem::temp_directory_path() / "trades_file_test")
+    {
+        std::filesystem::create_directories(m_dir);
+    }
+
+    ~TradesFileTest() override
+    {
+        std::filesystem::remove_all(m_dir);
+    }
+
+    static TradeColumns make_columns(size_t count, std::chrono::milliseconds start_ts)
+    {
+        TradeColumns columns;
+        for (size_t i = 0; i < count; ++i) {
+            const double volume = (i % 2 == 0) ? 0.001 * static_cast<double>(i + 1) : -0.5;
+            columns.push_back({start_ts + std::chrono::milliseconds{i * 10}, 100. + (0.1 * static_cast<double>(i)), SignedVolume{volume}});
+        }
+        return columns;
+    }
+
+    static TradeColumns read_all(const TradesDay & day)
+    {
+        TradeColumns res;
+        std::vector<PublicTrade> trades;
+        for (size_t block = 0; block < day.blocks_count(); ++block) {
+            day.decode_block(block, trades);
+            for (const auto & trade : trades) {
+                res.push_back(trade);
+            }
+        }
+        return res;
+    }
+
+    // compares bits, so -0. has to stay negative
+    static void expect_same_bits(const TradeColumns & lhs, const TradeColumns & rhs)
+    {
+        ASSERT_EQ(lhs.size(), rhs.size());
+        EXPECT_EQ(lhs.timestamps, rhs.timestamps);
+        EXPECT_EQ(std::memcmp(lhs.prices.data(), rhs.prices.data(), lhs.size() * sizeof(double)), 0);
+        EXPECT_EQ(std::memcmp(lhs.volumes.data(), rhs.volumes.data(), lhs.size() * sizeof(double)), 0);
+    }
+
+protected:
+    std::filesystem::path m_dir;
+};
+
+TEST_F(TradesFileTest, WriteAndRead)
+{
+    const auto path = m_dir / "BTCUSDT2024-12-25.trades";
+    const auto columns = make_columns(1000, std::chrono::milliseconds{1712967661670});
+
+    ASSERT_TRUE(TradesFile::write(path, columns));
+    EXPECT_TRUE(TradesFile::has_valid_header(path));
+    EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+    const auto day = TradesFile::map(path);
+    ASSERT_TRUE(day.has_value());
+    ASSERT_EQ(day->size(), columns.size());
+    expect_same_bits(read_all(*day), columns);
+
+    std::vector<PublicTrade> trades;
+    day->decode_block(0, trades);
+    const PublicTrade trade = trades[3];
+    EXPECT_EQ(trade.ts(), std::chrono::milliseconds{1712967661700});
+    EXPECT_DOUBLE_EQ(trade.price(), 100.3);
+    EXPECT_DOUBLE_EQ(trade.volume().value(), -0.5);
+}
+
+TEST_F(TradesFileTest, CompressionIsLossless)
+{
+    const auto path = m_dir / "lossless.trades";
+
+    // jumps back in time, prices and volumes that are not short decimals, special values
+    TradeColumns columns;
+    const std::vector<double> prices{42283.5, 42283.5, 0.1 + 0.2, -0., 1e300, std::numeric_limits<double>::denorm_min(), 42283.4, -1.};
+    const std::vector<double> volumes{0.001, -1.5, 1. / 3., -0., 1e-13, 123456789.123, -0.2, 5e15};
+    int64_t ts = 1704067200000;
+    for (size_t i = 0; i < TradesFile::default_block_size + 100; ++i) {
+        ts += (i % 5 == 0) ? -3 : static_cast<int64_t>(i * i);
+        columns.push_back({std::chrono::milliseconds{ts}, prices[i % prices.size()], SignedVolume{volumes[(i / 2) % volumes.size()]}});
+    }
+    ASSERT_TRUE(TradesFile::write(path, columns));
+
+    const auto day = TradesFile::map(path);
+    ASSERT_TRUE(day.has_value());
+    EXPECT_EQ(day->blocks_count(), 2);
+    expect_same_bits(read_all(*day), columns);
+}
+
+TEST_F(TradesFileTest, TypicalTradesTakeFewBytes)
+{
+    const auto path = m_dir / "typical.trades";
+
+    // prices on a tick that repeat a few times, volumes on a lot size, as in exchange's csv
+    TradeColumns columns;
+    int64_t ts = 1704067200000;
+    int ticks = 422835;
+    for (size_t i = 0; i < 10'000; ++i) {
+        ts += static_cast<int64_t>(i % 3);
+        if (i % 4 == 0) {
+            ticks += (i % 8 == 0) ? 1 : -1;
+        }
+        const double price = std::stod(std::to_string(ticks / 10) + "." + std::to_string(ticks % 10));
+        const double volume = std::stod("0.0" + std::to_string((i % 97) + 1));
+        columns.push_back({std::chrono::milliseconds{ts}, price, SignedVolume{i % 3 == 0 ? -volume : volume}});
+    }
+    ASSERT_TRUE(TradesFile::write(path, columns));
+
+    const auto day = TradesFile::map(path);
+    ASSERT_TRUE(day.has_value());
+    expect_same_bits(read_all(*day), columns);
+
+    // raw columns take 24 bytes per trade
+    EXPECT_LT(day->size_bytes(), columns.size() * 6);
+}
+
+TEST_F(TradesFileTest, CorruptedColumnIsDetected)
+{
+    const auto path = m_dir / "corrupted.trades";
+    ASSERT_TRUE(TradesFile::write(path, make_columns(100, std::chrono::milliseconds{1000})));
+
+    {
+        std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+        fs.seekp(sizeof(TradesFile::Header) + 5);
+        fs.put('\x7f');
+    }
+
+    // header is still fine, only the checksum can tell
+    EXPECT_TRUE(TradesFile::has_valid_header(path));
+    EXPECT_FALSE(TradesFile::map(path).has_value());
+}
+
+TEST_F(TradesFileTest, CorruptedBlockIsDetectedOnDecode)
+{
+    const auto path = m_dir / "corrupted_block.trades";
+    const auto columns = make_columns((2 * TradesFile::default_block_size) + 10, std::chrono::milliseconds{1000});
+    ASSERT_TRUE(TradesFile::write(path, columns));
+
+    {
+        // last byte of the payload is in the last block
+        std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+        fs.seekg(-1, std::ios::end);
+        const char last = static_cast<char>(fs.get());
+        fs.seekp(-1, std::ios::end);
+        fs.put(static_cast<char>(last ^ 0x40));
+    }
+
+    // only block infos are verified on map
+    const auto day = TradesFile::map(path);
+    ASSERT_TRUE(day.has_value());
+    ASSERT_EQ(day->blocks_count(), 3);
+
+    std::vector<PublicTrade> trades;
+    EXPECT_TRUE(day->decode_block(0, trades));
+    EXPECT_EQ(trades.size(), TradesFile::default_block_size);
+    EXPECT_FALSE(day->decode_block(2, trades));
+    EXPECT_TRUE(trades.empty());
+    EXPECT_FALSE(day->decode_block(2, trades));
+}
+
+TEST_F(TradesFileTest, TruncatedFileIsDetected)
+{
+    const auto path = m_dir / "truncated.trades";
+    ASSERT_TRUE(TradesFile::write(path, make_columns(100, std::chrono::milliseconds{1000})));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+
+    EXPECT_FALSE(TradesFile::has_valid_header(path));
+    EXPECT_FALSE(TradesFile::map(path).has_value());
+    EXPECT_FALSE(TradesFile::has_valid_header(m_dir / "missing.trades"));
+}
+
+TEST_F(TradesFileTest, EmptyDay)
+{
+    const auto path = m_dir / "empty.trades";
+    ASSERT_TRUE(TradesFile::write(path, TradeColumns{}));
+
+    const auto day = TradesFile::map(path);
+    ASSERT_TRUE(day.has_value());
+    EXPECT_TRUE(day->empty());
+}
+
+TEST_F(TradesFileTest, SequentialReaderGoesThroughAllDays)
+{
+    const auto day1 = m_dir / "day1.trades";
+    const auto day2 = m_dir / "day2.trades";
+    ASSERT_TRUE(TradesFile::write(day1, make_columns(3, std::chrono::milliseconds{1000})));
+    ASSERT_TRUE(TradesFile::write(day2, make_columns(2, std::chrono::milliseconds{2000})));
+
+    const auto empty_day = m_dir / "empty.trades";
+    ASSERT_TRUE(TradesFile::write(empty_day, TradeColumns{}));
+
+    SequentialMarketDataReader reader({day1.string(), empty_day.string(), (m_dir / "missing.trades").string(), day2.string()});
+
+    std::vector<std::chrono::milliseconds> timestamps;
+    for (auto trade = reader.get_next(); trade.has_value(); trade = reader.get_next()) {
+        timestamps.push_back(trade->ts());
+    }
+
+    const std::vector<std::chrono::milliseconds> expected{
+            std::chrono::milliseconds{1000},
+            std::chrono::milliseconds{1010},
+            std::chrono::milliseconds{1020},
+            std::chrono::milliseconds{2000},
+            std::chrono::milliseconds{2010},
+    };
+    EXPECT_EQ(timestamps, expected);
+}
+
+TEST_F(TradesFileTest, LowerBoundLooksUpBlock)
+{
+    const auto path = m_dir / "indexed.trades";
+
+    // three trades per timestamp, so equal timestamps go across blocks
+    TradeColumns columns;
+    const size_t count = (TradesFile::default_block_size * 4) + 7;
+    for (size_t i = 0; i < count; ++i) {
+        columns.push_back({std::chrono::milliseconds{1000 + ((i / 3) * 10)}, 1., SignedVolume{1.}});
+    }
+    ASSERT_TRUE(TradesFile::write(path, columns));
+
+    const auto day = TradesFile::map(path);
+    ASSERT_TRUE(day.has_value());
+
+    const auto & timestamps = columns.timestamps;
+    for (int64_t ts = 990; ts <= timestamps.back() + 10; ts += 5) {
+        const auto expected = std::lower_bound(timestamps.begin(), timestamps.end(), ts) - timestamps.begin();
+        ASSERT_EQ(day->lower_bound(std::chrono::milliseconds{ts}), static_cast<size_t>(expected)) << ts;
+    }
+}
+
+TEST_F(TradesFileTest, SequentialReaderReadsOnlyTimeRange)
+{
+    // other names than in cache tests, the cache keeps days mapped between tests
+    const auto day1 = m_dir / "range_day1.trades";
+    const auto day2 = m_dir / "range_day2.trades";
+    ASSERT_TRUE(TradesFile::write(day1, make_columns(3000, std::chrono::milliseconds{0})));
+    ASSERT_TRUE(TradesFile::write(day2, make_columns(3000, std::chrono::milliseconds{30'000})));
+
+    const HistoricalMDRequestData range{.start = std::chrono::milliseconds{25'005}, .end = std::chrono::milliseconds{31'000}};
+    SequentialMarketDataReader reader({day1.string(), day2.string()}, range);
+
+    std::vector<PublicTrade> trades;
+    std::vector<PublicTrade> batch;
+    while (reader.get_next_batch(batch, 128) > 0) {
+        trades.insert(trades.end(), batch.begin(), batch.end());
+    }
+
+    ASSERT_EQ(trades.size(), 499 + 100);
+    EXPECT_EQ(trades.front().ts(), std::chrono::milliseconds{25'010});
+    EXPECT_EQ(trades[498].ts(), std::chrono::milliseconds{29'990});
+    EXPECT_EQ(trades[499].ts(), std::chrono::milliseconds{30'000});
+    EXPECT_EQ(trades.back().ts(), std::chrono::milliseconds{30'990});
+}
+
+TEST_F(TradesFileTest, CacheSharesLoadedDays)
+{
+    TradesDayCache::i().clear();
+
+    const auto path = (m_dir / "shared.trades").string();
+    ASSERT_TRUE(TradesFile::write(path, make_columns(1000, std::chrono::milliseconds{1000})));
+
+    std::vector<TradesDayCache::DayPtr> days(8);
+    {
+        std::vector<std::thread> threads;
+        for (auto & day : days) {
+            threads.emplace_back([&] { day = TradesDayCache::i().get(path); });
+        }
+        for (auto & t : threads) {
+            t.join();
+        }
+    }
+
+    ASSERT_NE(days.front(), nullptr);
+    for (const auto & day : days) {
+        EXPECT_EQ(day, days.front());
+    }
+    EXPECT_EQ(TradesDayCache::i().days_count(), 1);
+    EXPECT_EQ(TradesDayCache::i().get((m_dir / "missing.trades").string()), nullptr);
+    EXPECT_EQ(TradesDayCache::i().days_count(), 1);
+
+    days.clear();
+    TradesDayCache::i().clear();
+    EXPECT_EQ(TradesDayCache::i().days_count(), 0);
+    EXPECT_EQ(TradesDayCache::i().memory_usage(), 0);
+}
+
+TEST_F(TradesFileTest, CacheEvictsOnlyUnusedDays)
+{
+    TradesDayCache::i().clear();
+
+    const auto day1_path = (m_dir / "day1.trades").string();
+    const auto day2_path = (m_dir / "day2.trades").string();
+    const auto day3_path = (m_dir / "day3.trades").string();
+    ASSERT_TRUE(TradesFile::write(day1_path, make_columns(100, std::chrono::milliseconds{1000})));
+    ASSERT_TRUE(TradesFile::write(day2_path, make_columns(100, std::chrono::milliseconds{2000})));
+    ASSERT_TRUE(TradesFile::write(day3_path, make_columns(100, std::chrono::milliseconds{3000})));
+    const size_t day_size = std::filesystem::file_size(day1_path);
+
+    // room for two days
+    TradesDayCache::i().set_memory_budget(2 * day_size);
+
+    const auto day1 = TradesDayCache::i().get(day1_path);
+    TradesDayCache::i().get(day2_path);
+    TradesDayCache::i().get(day3_path);
+
+    // day1 is in use, day2 is the least recently used one
+    EXPECT_EQ(TradesDayCache::i().days_count(), 2);
+    EXPECT_EQ(TradesDayCache::i().memory_usage(), 2 * day_size);
+    EXPECT_EQ(TradesDayCache::i().get(day1_path), day1);
+
+    TradesDayCache::i().set_memory_budget(TradesDayCache::default_memory_budget);
+    TradesDayCache::i().clear();
+    EXPECT_EQ(TradesDayCache::i().days_count(), 1);
+}
+
+TEST_F(TradesFileTest, CacheSharesDecodedBlocks)
+{
+    TradesDayCache::i().clear();
+
+    const auto path = (m_dir / "decoded.trades").string();
+    ASSERT_TRUE(TradesFile::write(path, make_columns(TradesFile::default_block_size * 3, std::chrono::milliseconds{1000})));
+    const size_t day_size = std::filesystem::file_size(path);
+
+    std::vector<TradesDayCache::BlockPtr> blocks(8);
+    {
+        std::vector<std::thread> threads;
+        for (auto & block : blocks) {
+            threads.emplace_back([&] { block = TradesDayCache::i().get_block(path, 1); });
+        }
+        for (auto & t : threads) {
+            t.join();
+        }
+    }
+
+    ASSERT_NE(blocks.front(), nullptr);
+    for (const auto & block : blocks) {
+        EXPECT_EQ(block, blocks.front());
+    }
+    EXPECT_EQ(blocks.front()->front().ts(), std::chrono::milliseconds{1000 + (TradesFile::default_block_size * 10)});
+    EXPECT_EQ(TradesDayCache::i().get_block(path, 3), nullptr);
+
+    // readers take the blocks from the cache
+    {
+        SequentialMarketDataReader reader1({path});
+        SequentialMarketDataReader reader2({path});
+        std::vector<PublicTrade> trades1;
+        std::vector<PublicTrade> trades2;
+        EXPECT_EQ(reader1.get_next_batch(trades1, TradesFile::default_block_size * 3), TradesFile::default_block_size * 3);
+        EXPECT_EQ(reader2.get_next_batch(trades2, TradesFile::default_block_size * 3), TradesFile::default_block_size * 3);
+        EXPECT_TRUE(std::ranges::equal(trades1, trades2, {}, &PublicTrade::ts, &PublicTrade::ts));
+        EXPECT_EQ(TradesDayCache::i().get_block(path, 1), blocks.front());
+        EXPECT_EQ(TradesDayCache::i().memory_usage(), day_size + (3 * TradesFile::default_block_size * sizeof(PublicTrade)));
+    }
+
+    // a block in use keeps its day
+    const auto block = blocks.front();
+    blocks.clear();
+    TradesDayCache::i().set_memory_budget(0);
+    EXPECT_EQ(TradesDayCache::i().days_count(), 1);
+    EXPECT_EQ(TradesDayCache::i().memory_usage(), day_size + (TradesFile::default_block_size * sizeof(PublicTrade)));
+
+    TradesDayCache::i().set_memory_budget(TradesDayCache::default_memory_budget);
+}
@@ -1,11 +1,26 @@
 #include "mainwindow.h"
 
+#include "Logger.h"
+#include "Tracer.h"
+
 #include <QApplication>
 
+#include <cstdlib>
+
 int main(int argc, char * argv[])
 {
+    // trace of the event flow for chrome://tracing or ui.perfetto.dev
+    const char * trace_path = std::getenv("CRYPTO_TRACE_FILE");
+    if (trace_path != nullptr && !Tracer::i().start(trace_path)) {
+        LOG_WARNING("Can't open trace file {}", trace_path);
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
-    return a.exec();
+    const int res = a.exec();
+
+    Tracer::i().stop();
+    Logger::flush();
+    return res;
 }
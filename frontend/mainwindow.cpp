@@ -167,7 +167,8 @@ void MainWindow::on_pb_run_clicked()
             strategy_name,
             entry_config,
             m_gateway,
-            tr_gateway);
+            tr_gateway,
+            EventLoopMode::Pooled);
     if (ui->sb_channel_capacity_h->value() >= 0) {
         m_strategy_instance->set_channel_capacity(std::chrono::hours{ui->sb_channel_capacity_h->value()});
     }
@@ -232,7 +233,7 @@ void MainWindow::subscribe_for_positions()
 
     m_sub->subscribe(
             m_strategy_instance->positions_channel(),
-            [&](const std::list<std::pair<std::chrono::milliseconds, PositionResult>> & list) {
+            [&](const EventTimeseriesChannel<PositionResult>::Snapshot & list) {
                 for (const auto & [_, position_result] : list) {
                     auto * view = new PositionResultView();
                     view->update(position_result);
@@ -358,7 +359,12 @@ void MainWindow::on_cb_strategy_currentTextChanged(const QString &)
 
 void MainWindowEventConsumer::push(LambdaEvent value)
 {
-    m_mw.signal_lambda(std::move(value.func));
+    // Qt signal arguments have to be copyable
+    m_mw.signal_lambda([ev = std::make_shared<LambdaEvent>(std::move(value))] {
+        if (ev->m_subscriber.is_alive()) {
+            ev->func();
+        }
+    });
 }
 
 void MainWindow::on_lambda(std::function<void()> lambda)
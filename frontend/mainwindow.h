@@ -87,7 +87,6 @@ public:
 private:
     // IEventConsumer<LambdaEvent>
     void push(LambdaEvent value) override;
-    void discard_subscriber_events(xg::Guid) override {}
 
 private:
     MainWindow & m_mw;